@@ -25,15 +25,22 @@
 #include "TProfile.h"
 #include "TProfile2D.h"
 #include "TList.h"
+#include "TClass.h"
 #include "TH1F.h"
 #include "TMath.h"
 #include "TVector2.h"
+#include "TH2F.h"
+#include "TVirtualMutex.h"
 
 #include "AliFlowCommonConstants.h"
 #include "AliFlowEventSimple.h"
 #include "AliFlowTrackSimple.h"
 #include "AliFlowCommonHist.h"
 #include "AliFlowCommonHistResults.h"
+#include "AliFlowEventBatch.h"
+#include "AliFlowEventView.h"
+#include "AliFlowProfileAccumulator.h"
+#include "AliFlowPhiloxRandom.h"
 #include "AliFlowAnalysisWithMCEventPlane_mod.h"
 #include "AliFlowVector.h"
 
@@ -48,7 +55,23 @@ ClassImp(AliFlowAnalysisWithMCEventPlane_mod)
 AliFlowAnalysisWithMCEventPlane_mod::AliFlowAnalysisWithMCEventPlane_mod():
    fQsum(NULL),
    fQ2sum(0),
+   fArena(NULL),
+   fEventRP(0.),
+   fEventNRPs(0),
+   fEventRefMult(0),
+   fEventIndex(-1),
+   fEventQx(0.),
+   fEventQy(0.),
+   fEventFlowSum(0.),
+   fEventFlowCount(0),
+   fEventMultRP(0),
+   fEventMultPOI(0),
+   fEventQ2x(0.),
+   fEventQ2y(0.),
+   fEventControl(kFALSE),
+   fEventBinM(0),
    fEventNumber(0),
+   fEventCounter(0),
    fDebug(kFALSE),
    fHistList(NULL),
    fCommonHists(NULL),
@@ -59,32 +82,62 @@ AliFlowAnalysisWithMCEventPlane_mod::AliFlowAnalysisWithMCEventPlane_mod():
    fHistProDiffFlowPtEtaRP(NULL),
    fHistProDiffFlowPtRP(NULL),
    fHistProDiffFlowEtaRP(NULL),
-   fHistDiffFlowEtaRPSubPt1(NULL),
-   fHistDiffFlowEtaRPSubPt2(NULL),
-   fHistDiffFlowEtaRPSubPt3(NULL),
    fHistProDiffFlowPtEtaPOI(NULL),
    fHistProDiffFlowPtPOI(NULL),
    fHistProDiffFlowEtaPOI(NULL),
-   fHistDiffFlowEtaPOISubPt1(NULL),
-   fHistDiffFlowEtaPOISubPt2(NULL),
-   fHistDiffFlowEtaPOISubPt3(NULL),
    fHistSpreadOfFlow(NULL),
    fHarmonic(2),
+   fRPSelectionBit(0),
+   fPOISelectionBit(1),
+   fSink(NULL),
+   fIntFlowAcc(NULL),
+   fIntFlowVsMAcc(NULL),
+   fDiffFlowPtAcc(NULL),
+   fDiffFlowEtaAcc(NULL),
+   fDiffFlowEtaSubPtAcc(NULL),
+   fDiffFlowPtEtaAcc(NULL),
+   fNHarmonics(0),
+   fHarmonicsList(NULL),
+   fHarmonicsIntAcc(NULL),
+   fHarmonicsPtAcc(NULL),
+   fHarmonicsEtaAcc(NULL),
+   fHarmonicsPtEtaAcc(NULL),
+   fNSubsamples(0),
+   fBootstrap(kFALSE),
+   fSubsamplesList(NULL),
+   fSubsamplesSettings(NULL),
+   fSubsamplesIntAcc(NULL),
+   fSubsamplesPtAcc(NULL),
+   fSubsamplesEtaAcc(NULL),
+   fEventNSubsamples(0),
+   fEventReplicaSums(NULL),
+   fEventReplicaCells(NULL),
+   fEventNReplicaCells(0),
    fMixedHarmonicsList(NULL),
    fEvaluateMixedHarmonics(kFALSE),
    fMixedHarmonicsSettings(NULL),
+   fPairCorrelatorVsMAcc(NULL),
    fnBinsMult(10000),
    fMinMult(0.),  
    fMaxMult(10000.),   
    fNinCorrelator(2),
    fMinCorrelator(2),
    fXinPairAngle(0.5),
+   fPairwiseMixedHarmonics(kFALSE),
+   fMaxPairsPairwise(10000),
+   fMixedHarmonicsMode(NULL),
+   fnBinsPtInQVectors(0),
+   fMixedHarmonicsPtQ(NULL),
+   fMixedHarmonicsPtOccupied(NULL),
+   fMixedHarmonicsPairSums(NULL),
    fEtaMin(-2.),
    fEtaMax(2.),
    fNbinsEta(120),
    fPtMin(0),
    fPtMax(10),
-   fNbinsPt(100)
+   fNbinsPt(100),
+   fNPtSlices(0),
+   fPtSliceBinner(NULL)
 {
 
    // Constructor.
@@ -92,10 +145,54 @@ AliFlowAnalysisWithMCEventPlane_mod::AliFlowAnalysisWithMCEventPlane_mod():
 
    fQsum = new TVector2;        // flow vector sum
 
+   fArena = new AliFlowTrackArena(); // columns of events handed over as AliFlowEventSimple
+
+   fHarmonicsList = new TList();
+   for(Int_t k=0;k<fgMaxHarmonics;k++)
+   {
+      fHarmonicResults[k] = NULL;
+      for(Int_t cs=0;cs<2;cs++)
+      {
+         fHarmonicIntFlow[k][cs] = NULL;
+         for(Int_t rp=0;rp<2;rp++)
+         {
+            fHarmonicDiffFlowPt[k][rp][cs] = NULL;
+            fHarmonicDiffFlowEta[k][rp][cs] = NULL;
+            fHarmonicDiffFlowPtEta[k][rp][cs] = NULL;
+         }
+      }
+   }
+
+   for(Int_t k=0;k<fgMaxSubsamples;k++)
+   {
+      fSubsampleIntFlow[k] = NULL;
+      for(Int_t rp=0;rp<2;rp++)
+      {
+         fSubsampleDiffFlowPt[rp][k] = NULL;
+         fSubsampleDiffFlowEta[rp][k] = NULL;
+      }
+      fEventSubsamples[k] = 0;
+      fEventSubsampleWeights[k] = 0.;
+   }
+
    fMixedHarmonicsList = new TList();
 
    this->InitalizeArraysForMixedHarmonics();
 
+   fFillTracks[0] = NULL;
+   fFillTracks[1] = NULL;
+   this->SelectKernels();
+
+   for(Int_t s=0;s<fgMaxPtSlices;s++)
+   {
+      fHistDiffFlowEtaRPSubPt[s] = NULL;
+      fHistDiffFlowEtaPOISubPt[s] = NULL;
+      fPtSliceCutOffs[s] = 0.;
+   }
+   fPtSliceBinner = new AliFlowAxisBinner();
+   Double_t dPtCutOffs[2] = {3.,5.}; // default pt slices: below 3, 3-5 and above 5 GeV
+   this->SetPtSlices(2,dPtCutOffs);
+
    }
  
 //-----------------------------------------------------------------------
@@ -105,6 +202,28 @@ AliFlowAnalysisWithMCEventPlane_mod::~AliFlowAnalysisWithMCEventPlane_mod()
    //destructor
    //if(fHistList) delete fHistList;
    if(fQsum) delete fQsum;
+   if(fArena) delete fArena;
+   if(fSink) delete fSink;
+   if(fIntFlowAcc) delete fIntFlowAcc;
+   if(fIntFlowVsMAcc) delete fIntFlowVsMAcc;
+   if(fDiffFlowPtAcc) delete fDiffFlowPtAcc;
+   if(fDiffFlowEtaAcc) delete fDiffFlowEtaAcc;
+   if(fDiffFlowEtaSubPtAcc) delete fDiffFlowEtaSubPtAcc;
+   if(fPtSliceBinner) delete fPtSliceBinner;
+   if(fDiffFlowPtEtaAcc) delete fDiffFlowPtEtaAcc;
+   if(fHarmonicsIntAcc) delete fHarmonicsIntAcc;
+   if(fHarmonicsPtAcc) delete fHarmonicsPtAcc;
+   if(fHarmonicsEtaAcc) delete fHarmonicsEtaAcc;
+   if(fHarmonicsPtEtaAcc) delete fHarmonicsPtEtaAcc;
+   if(fSubsamplesIntAcc) delete fSubsamplesIntAcc;
+   if(fSubsamplesPtAcc) delete fSubsamplesPtAcc;
+   if(fSubsamplesEtaAcc) delete fSubsamplesEtaAcc;
+   if(fEventReplicaSums) delete [] fEventReplicaSums;
+   if(fEventReplicaCells) delete [] fEventReplicaCells;
+   if(fPairCorrelatorVsMAcc) delete fPairCorrelatorVsMAcc;
+   if(fMixedHarmonicsPtQ) delete [] fMixedHarmonicsPtQ;
+   if(fMixedHarmonicsPtOccupied) delete [] fMixedHarmonicsPtOccupied;
+   if(fMixedHarmonicsPairSums) delete [] fMixedHarmonicsPairSums;
 }
 
 //-----------------------------------------------------------------------
@@ -112,6 +231,7 @@ AliFlowAnalysisWithMCEventPlane_mod::~AliFlowAnalysisWithMCEventPlane_mod()
 void AliFlowAnalysisWithMCEventPlane_mod::WriteHistograms(TDirectoryFile *outputFileName)
 {
    //store the final results in output .root file
+   this->FlushAccumulators();
    fHistList->SetName("cobjMCEP");
    fHistList->SetOwner(kTRUE);
    outputFileName->Add(fHistList);
@@ -168,7 +288,8 @@ void AliFlowAnalysisWithMCEventPlane_mod::Init() {
    fHistProIntFlow->SetYTitle("");
    fHistList->Add(fHistProIntFlow);
 
-   fHistProIntFlowVsM = new TProfile("FlowPro_VsM_MCEP","FlowPro_VsM_MCEP",10000,0.,10000.); // to be improved - hardwired 10000
+   //one bin per multiplicity, but only from the lowest to the highest one filled (see fIntFlowVsMAcc):
+   fHistProIntFlowVsM = new TProfile("FlowPro_VsM_MCEP","FlowPro_VsM_MCEP",1,0.,1.);
    //fHistProIntFlowVsM->SetLabelSize(0.06);
    (fHistProIntFlowVsM->GetXaxis())->SetTitle("M");
    fHistProIntFlowVsM->SetYTitle("");
@@ -190,21 +311,14 @@ void AliFlowAnalysisWithMCEventPlane_mod::Init() {
    fHistList->Add(fHistProDiffFlowEtaRP);
 
 
-      //start sub graphs for RP
-      fHistDiffFlowEtaRPSubPt1 = new TProfile("SubPt1_Veta_RP","Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
-      fHistDiffFlowEtaRPSubPt1->SetXTitle("#eta");
-      fHistDiffFlowEtaRPSubPt1->SetYTitle("v_{1}");
-      fHistList->Add(fHistDiffFlowEtaRPSubPt1);
-
-      fHistDiffFlowEtaRPSubPt2 = new TProfile("SubPt2_Veta_RP","Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
-      fHistDiffFlowEtaRPSubPt2->SetXTitle("#eta");
-      fHistDiffFlowEtaRPSubPt2->SetYTitle("v_{1}");
-      fHistList->Add(fHistDiffFlowEtaRPSubPt2);
-
-      fHistDiffFlowEtaRPSubPt3 = new TProfile("SubPt3_Veta_RP","Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
-      fHistDiffFlowEtaRPSubPt3->SetXTitle("#eta");
-      fHistDiffFlowEtaRPSubPt3->SetYTitle("v_{1}");
-      fHistList->Add(fHistDiffFlowEtaRPSubPt3);
+      //start sub graphs for RP, one per pt slice
+      for(Int_t s=0;s<fNPtSlices;s++)
+      {
+         fHistDiffFlowEtaRPSubPt[s] = new TProfile(Form("SubPt%d_Veta_RP",s+1),"Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
+         fHistDiffFlowEtaRPSubPt[s]->SetXTitle("#eta");
+         fHistDiffFlowEtaRPSubPt[s]->SetYTitle("v_{1}");
+         fHistList->Add(fHistDiffFlowEtaRPSubPt[s]);
+      }
       //end sub graphs for RP
 
 
@@ -223,21 +337,14 @@ void AliFlowAnalysisWithMCEventPlane_mod::Init() {
    fHistProDiffFlowEtaPOI->SetYTitle("v_{1}");
    fHistList->Add(fHistProDiffFlowEtaPOI);
 
-      //start sub graphs for POI
-      fHistDiffFlowEtaPOISubPt1 = new TProfile("SubPt1_Veta_POI","Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
-      fHistDiffFlowEtaPOISubPt1->SetXTitle("#eta");
-      fHistDiffFlowEtaPOISubPt1->SetYTitle("v_{1}");
-      fHistList->Add(fHistDiffFlowEtaPOISubPt1);
-
-      fHistDiffFlowEtaPOISubPt2 = new TProfile("SubPt2_Veta_POI","Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
-      fHistDiffFlowEtaPOISubPt2->SetXTitle("#eta");
-      fHistDiffFlowEtaPOISubPt2->SetYTitle("v_{1}");
-      fHistList->Add(fHistDiffFlowEtaPOISubPt2);
-
-      fHistDiffFlowEtaPOISubPt3 = new TProfile("SubPt3_Veta_POI","Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
-      fHistDiffFlowEtaPOISubPt3->SetXTitle("#eta");
-      fHistDiffFlowEtaPOISubPt3->SetYTitle("v_{1}");
-      fHistList->Add(fHistDiffFlowEtaPOISubPt3);
+      //start sub graphs for POI, one per pt slice
+      for(Int_t s=0;s<fNPtSlices;s++)
+      {
+         fHistDiffFlowEtaPOISubPt[s] = new TProfile(Form("SubPt%d_Veta_POI",s+1),"Directed Flow v_{1}(#eta)",iNbinsEta,dEtaMin,dEtaMax);
+         fHistDiffFlowEtaPOISubPt[s]->SetXTitle("#eta");
+         fHistDiffFlowEtaPOISubPt[s]->SetYTitle("v_{1}");
+         fHistList->Add(fHistDiffFlowEtaPOISubPt[s]);
+      }
       //end sub graphs for POI
 
 
@@ -247,11 +354,45 @@ void AliFlowAnalysisWithMCEventPlane_mod::Init() {
    fHistSpreadOfFlow->SetYTitle("counts");
    fHistList->Add(fHistSpreadOfFlow);           
 
+   //flat accumulators for the profiles filled per track, on the bins of the profiles:
+   fIntFlowAcc = new AliFlowProfileAccumulator();
+   fIntFlowAcc->Book(1,fHistProIntFlow->GetXaxis());
+   fIntFlowAcc->SetProfile(0,fHistProIntFlow);
+   fIntFlowVsMAcc = new AliFlowAutoRangeProfileAccumulator();
+   fIntFlowVsMAcc->Book(1,1.);
+   fIntFlowVsMAcc->SetProfile(0,fHistProIntFlowVsM);
+   fDiffFlowPtAcc = new AliFlowProfileAccumulator();
+   fDiffFlowPtAcc->Book(2,fHistProDiffFlowPtRP->GetXaxis());
+   fDiffFlowPtAcc->SetProfile(0,fHistProDiffFlowPtRP);
+   fDiffFlowPtAcc->SetProfile(1,fHistProDiffFlowPtPOI);
+   fDiffFlowEtaAcc = new AliFlowProfileAccumulator();
+   fDiffFlowEtaAcc->Book(2,fHistProDiffFlowEtaRP->GetXaxis());
+   fDiffFlowEtaAcc->SetProfile(0,fHistProDiffFlowEtaRP);
+   fDiffFlowEtaAcc->SetProfile(1,fHistProDiffFlowEtaPOI);
+   //all pt slices of RPs and POIs in one block, [eta bin][slice]:
+   fDiffFlowEtaSubPtAcc = new AliFlowProfileAccumulator();
+   fDiffFlowEtaSubPtAcc->Book(2*fNPtSlices,fHistProDiffFlowEtaRP->GetXaxis());
+   for(Int_t s=0;s<fNPtSlices;s++)
+   {
+      fDiffFlowEtaSubPtAcc->SetProfile(s,fHistDiffFlowEtaRPSubPt[s]);
+      fDiffFlowEtaSubPtAcc->SetProfile(fNPtSlices+s,fHistDiffFlowEtaPOISubPt[s]);
+   }
+   fDiffFlowPtEtaAcc = new AliFlowProfileAccumulator();
+   fDiffFlowPtEtaAcc->Book(2,fHistProDiffFlowPtEtaRP->GetXaxis(),fHistProDiffFlowPtEtaRP->GetYaxis());
+   fDiffFlowPtEtaAcc->SetProfile(0,fHistProDiffFlowPtEtaRP);
+   fDiffFlowPtEtaAcc->SetProfile(1,fHistProDiffFlowPtEtaPOI);
+
    fEventNumber = 0;  //set number of events to zero
 
+   if(fNHarmonics) this->BookObjectsForHarmonics();
+
+   if(fNSubsamples) this->BookObjectsForSubsamples();
+
    if(fEvaluateMixedHarmonics) this->BookObjectsForMixedHarmonics();
         
    TH1::AddDirectory(oldHistAddStatus);
+
+   this->SelectKernels(); //fHarmonic is final by now
 } 
  
 //-----------------------------------------------------------------------
@@ -260,107 +401,764 @@ void AliFlowAnalysisWithMCEventPlane_mod::Make(AliFlowEventSimple* anEvent) {
 
    //Calculate v2 from the MC reaction plane
    if (anEvent) {
-  
-      // get the MC reaction plane angle
-      Double_t aRP = anEvent->GetMCReactionPlaneAngle();  
       //fill control histograms     
       fCommonHists->FillControlHistograms(anEvent);
 
-      //get the Q vector from the FlowEvent
-      AliFlowVector vQ = anEvent->GetQ(fHarmonic); 
-      //cout<<"vQ.Mod() = " << vQ.Mod() << endl;
-      //for chi calculation:
-      *fQsum += vQ;
-      //cout<<"fQsum.Mod() = "<<fQsum.Mod()<<endl;
-      fQ2sum += vQ.Mod2();
-      //cout<<"fQ2sum = "<<fQ2sum<<endl;
-        
-      fHistRP->Fill(aRP);   
-
-      Double_t dPhi = 0.;
-      Double_t dv  = 0.;
-      Double_t dPt  = 0.;
-      Double_t dEta = 0.;
-      //Double_t dPi = TMath::Pi();  
-
-      // profile to calculate flow e-b-y:
-      TProfile *flowEBE = new TProfile("flowEBE","flowEBE",1,0,1);
-                                                                                         
-      //calculate flow
-      //loop over the tracks of the event
-      Int_t iNumberOfTracks = anEvent->NumberOfTracks(); 
-      Int_t iNumberOfRPs = anEvent->GetEventNSelTracksRP(); 
-      for (Int_t i=0;i<iNumberOfTracks;i++) {
-         AliFlowTrackSimple* pTrack = anEvent->GetTrack(i) ; 
-         if (pTrack){
-            if (pTrack->InRPSelection()){
-               dPhi = pTrack->Phi();
-               dv  = TMath::Cos(fHarmonic*(dPhi-aRP));
-               dPt  = pTrack->Pt();
-               dEta = pTrack->Eta();
-               //reference flow:
-               fHistProIntFlow->Fill(0.,dv);
-               //reference flow versus multiplicity:
-               fHistProIntFlowVsM->Fill(iNumberOfRPs+0.5,dv);
-               //reference flow e-b-e:
-               flowEBE->Fill(0.,dv);
-               //differential flow (Pt, Eta, RP):
-               fHistProDiffFlowPtEtaRP->Fill(dPt,dEta,dv,1.);
-               //differential flow (Pt, RP):
-               fHistProDiffFlowPtRP->Fill(dPt,dv,1.);
-               //differential flow (Eta, RP):
-               fHistProDiffFlowEtaRP->Fill(dEta,dv,1.);
-
-               if (dPt<3) {
-                  fHistDiffFlowEtaRPSubPt1->Fill(dEta,dv,1.);
-               }
-               if (dPt>3) {
-                  fHistDiffFlowEtaRPSubPt2->Fill(dEta,dv,1.);
-               }
-               if (dPt>5) {
-                  fHistDiffFlowEtaRPSubPt3->Fill(dEta,dv,1.);
-               }
-            }
-            if (pTrack->InPOISelection()) {
-               dPhi = pTrack->Phi();
-               //calculate flow v1:
-               dv  = TMath::Cos(fHarmonic*(dPhi-aRP));
-               dPt  = pTrack->Pt();
-               dEta = pTrack->Eta();
-               //differential flow (Pt, Eta, POI):
-               fHistProDiffFlowPtEtaPOI->Fill(dPt,dEta,dv,1.);
-               //differential flow (Pt, POI):
-               fHistProDiffFlowPtPOI->Fill(dPt,dv,1.);
-               //differential flow (Eta, POI):
-               fHistProDiffFlowEtaPOI->Fill(dEta,dv,1.);
-
-               if (dPt<3) {
-                  fHistDiffFlowEtaPOISubPt1->Fill(dEta,dv,1.);
-               }
-               if (dPt>3) {
-                  fHistDiffFlowEtaPOISubPt2->Fill(dEta,dv,1.);
-               }
-               if (dPt>5) {
-                  fHistDiffFlowEtaPOISubPt3->Fill(dEta,dv,1.);
-               }
-            }       
-         }//track selected
-      }//loop over tracks
+      //copy the tracks into contiguous columns (reusing the memory of the previous event) and analyse those:
+      fArena->Reset();
+      AliFlowEventView view;
+      view.Set(anEvent,fArena);
+      this->MakeFromView(view);
+   }    
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::Make(const AliFlowEventView &anEvent) {
+
+   //Calculate v2 from the MC reaction plane, reading the tracks column by column
+   //(the same fills as for an event streamed through BeginEvent(), FillTrack() and EndEvent())
+   AliFlowEventView selected;
+   if (fRPSelectionBit != 0 || fPOISelectionBit != 1) fArena->Reset();
+   const AliFlowEventView &event = this->SelectTracks(anEvent,selected);
+   const Double_t *pt = event.GetPt();
+   const Double_t *eta = event.GetEta();
+   const Double_t *phi = event.GetPhi();
+   const UInt_t *selection = event.GetSelection();
+   Int_t iNumberOfTracks = event.NumberOfTracks();
+
+   this->StartEvent(event.GetMCReactionPlaneAngle(),event.GetEventNSelTracksRP(),event.GetReferenceMultiplicity(),event.GetEventIndex(),kTRUE);
+   (this->*fFillTracks[1])(iNumberOfTracks,pt,eta,phi,selection);
+   if (fHarmonicsIntAcc) this->FillHarmonics(iNumberOfTracks,pt,eta,phi,selection);
+   this->FinishEvent(event);
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::BeginEvent(Double_t dMCReactionPlaneAngle, Int_t iReferenceMultiplicity, Int_t nRPs, Int_t /*nPOIs*/, Long64_t iEventIndex) {
+
+   //Start an event streamed track by track from the generator, control histograms included
+   //(filled as for a view: track by track by FillTrack(), per event by EndEvent()); with other selection bits than
+   //those of the RP and POI cuts, EndEvent() analyses the whole event from its view instead
+   if (fRPSelectionBit != 0 || fPOISelectionBit != 1) return;
+   this->StartEvent(dMCReactionPlaneAngle,nRPs,iReferenceMultiplicity,iEventIndex,kTRUE);
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::FillTrack(Double_t dPt, Double_t dEta, Double_t dPhi, Int_t iCharge, UInt_t uiSelection) {
+
+   //Fill one track of the streamed event into the control histograms and flow profiles
+   //(by the kernel for fHarmonic: streaming into GetSink() instead of this saves the extra call per track)
+   fSink->FillTrack(dPt,dEta,dPhi,iCharge,uiSelection);
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::EndEvent(const AliFlowEventView &anEvent) {
+
+   //End an event streamed track by track (see BeginEvent())
+   if (fRPSelectionBit != 0 || fPOISelectionBit != 1) {
+      this->Make(anEvent);
+      return;
+   }
+   this->FinishEvent(anEvent);
+}
+
+//-----------------------------------------------------------------------
+
+const AliFlowEventView& AliFlowAnalysisWithMCEventPlane_mod::SelectTracks(const AliFlowEventView &anEvent, AliFlowEventView &selected) {
+
+   //anEvent with the RP and POI cuts as RPs and POIs; with other bits set by SetSelectionBits(), selected with those
+   //(its selection column taken from fArena, which the caller resets if it holds nothing else)
+   if (fRPSelectionBit == 0 && fPOISelectionBit == 1) return anEvent;
+   selected.Select(anEvent,fRPSelectionBit,fPOISelectionBit,fArena);
+   return selected;
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::FinishEvent(const AliFlowEventView &anEvent) {
+
+   //Fill what needs the whole event: multiplicities, Q vector, flow e-b-e and mixed harmonics
+   //(the control histograms as AliFlowCommonHist::FillControlHistograms() does, see FillTrackControl(): keep them in sync)
+   if (fEventControl) {
+      fCommonHists->GetHistMultRP()->Fill(fEventMultRP);
+      fCommonHists->GetHistMultPOI()->Fill(fEventMultPOI);
+      fCommonHists->GetHistMultPOIvsRP()->Fill(fEventMultRP,fEventMultPOI);
+      //the Q vector of the RPs at harmonic 2 per RP and the reference multiplicity, as in
+      //AliFlowCommonHist::FillControlHistograms():
+      TVector2 vQ(0.,0.);
+      if (fEventMultRP) vQ.Set(fEventQ2x/fEventMultRP,fEventQ2y/fEventMultRP);
+      fCommonHists->GetHistQ()->Fill(vQ.Mod());
+      fCommonHists->GetHistAngleQ()->Fill(vQ.Phi()/2);
+      fCommonHists->GetHistRefMult()->Fill(fEventRefMult);
+   }
+
+   if (fEventNReplicaCells) this->FinishEventSubsamples();
+
+   *fQsum += TVector2(fEventQx,fEventQy);
+   fQ2sum += fEventQx*fEventQx+fEventQy*fEventQy;
     
-      fEventNumber++;
+   fEventNumber++;
     
-      // store flow value for this event:
-      fHistSpreadOfFlow->Fill(flowEBE->GetBinContent(1),flowEBE->GetBinEntries(1));
-      delete flowEBE; 
+   // store flow value for this event:
+   fHistSpreadOfFlow->Fill(fEventFlowCount>0 ? fEventFlowSum/fEventFlowCount : 0.,fEventFlowCount);
 
-      if(fEvaluateMixedHarmonics) EvaluateMixedHarmonics(anEvent);
-   }    
+   if(fEvaluateMixedHarmonics) EvaluateMixedHarmonics(anEvent);
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::StartEvent(Double_t aRP, Int_t nRPs, Int_t iRefMult, Long64_t iEventIndex, Bool_t bControl) {
+
+   //Reset the sums of the event and fill its MC reaction plane angle
+   fEventRP = aRP;
+   fEventNRPs = nRPs;
+   fEventRefMult = iRefMult;
+   fEventIndex = iEventIndex;
+   fEventQx = 0.;
+   fEventQy = 0.;
+   fEventFlowSum = 0.;
+   fEventFlowCount = 0;
+   fEventMultRP = 0;
+   fEventMultPOI = 0;
+   fEventQ2x = 0.;
+   fEventQ2y = 0.;
+   fEventControl = bControl;
+   fEventBinM = fIntFlowVsMAcc->FindBin(nRPs+0.5);
+   if (fSubsamplesIntAcc) this->StartEventSubsamples();
+
+   fHistRP->Fill(aRP);   
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::StartEventSubsamples() {
+
+   //Pick the subsample of the event, or its weight in each bootstrap replica, with random numbers keyed by the index of
+   //the event in its random stream: they do not depend on which thread or worker analyses it, and two events never share
+   //them. An AliFlowEventSimple has no index; the counter of such events (carried along by Merge()) keys it instead
+   static const UInt_t uiKey[2] = {0x5AB5A3u,0xB0075u}; // any fixed key
+   UInt_t uiCounter[4] = {0,0,0,0};
+   ULong64_t uiEvent = (ULong64_t)(fEventIndex >= 0 ? fEventIndex : fEventCounter++);
+   uiCounter[0] = (UInt_t)(uiEvent & 0xFFFFFFFFULL);
+   uiCounter[1] = (UInt_t)(uiEvent >> 32);
+   uiCounter[2] = (fEventIndex >= 0 ? 0xFFFFFFFFu : 0xFFFFFFFEu); // indices and counters apart
+   UInt_t uiRandom[4];
+   fEventNSubsamples = 0;
+   if (!fBootstrap) {
+      AliFlowPhiloxRandom::Philox(uiCounter,uiKey,uiRandom);
+      fEventSubsamples[0] = (Int_t)(((ULong64_t)uiRandom[0]*fNSubsamples) >> 32);
+      fEventSubsampleWeights[0] = 1.;
+      fEventNSubsamples = 1;
+      return;
+   }
+   for (Int_t k=0;k<fNSubsamples;k++) {
+      if (k%4 == 0) {
+         uiCounter[3] = k/4;
+         AliFlowPhiloxRandom::Philox(uiCounter,uiKey,uiRandom);
+      }
+      //Poisson(1) by inversion: the weight is the first w with u < P(0)+...+P(w), P(w) = exp(-1)/w!
+      Double_t dU = (uiRandom[k%4]+0.5)/4294967296.;
+      Double_t dP = 0.36787944117144233;
+      Double_t dF = dP;
+      Int_t iWeight = 0;
+      while (dU > dF && iWeight < 20) {
+         iWeight++;
+         dP /= iWeight;
+         dF += dP;
+      }
+      if (!iWeight) continue; //not in this replica (a third of the events)
+      fEventSubsamples[fEventNSubsamples] = k;
+      fEventSubsampleWeights[fEventNSubsamples] = iWeight;
+      fEventNSubsamples++;
+   }
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::FillTrackSubsamples(Int_t iBinPt, Int_t iBinEta, Int_t rp, Double_t dPt, Double_t dEta, Double_t dv) {
+
+   //Fill the reference (RPs only) and differential flow of the subsample of the event, on the bins of the track; the
+   //bootstrap replicas take the sums of the event instead, filled once per bin by FinishEventSubsamples()
+   if (fBootstrap) {
+      const Int_t nPtCells = fSubsamplesPtAcc->GetAxisX().GetNBins()+2;
+      const Int_t nEtaCells = fSubsamplesEtaAcc->GetAxisX().GetNBins()+2;
+      if (rp == 0) this->AddToReplicaCell(0,0.,dv);
+      this->AddToReplicaCell(1+rp*nPtCells+iBinPt,dPt,dv);
+      this->AddToReplicaCell(1+2*nPtCells+rp*nEtaCells+iBinEta,dEta,dv);
+      return;
+   }
+   for (Int_t s=0;s<fEventNSubsamples;s++) {
+      const Int_t k = fEventSubsamples[s];
+      const Double_t w = fEventSubsampleWeights[s];
+      if (rp == 0) fSubsamplesIntAcc->Fill(1,k,0.,dv,w);
+      fSubsamplesPtAcc->Fill(iBinPt,2*k+rp,dPt,dv,w);
+      fSubsamplesEtaAcc->Fill(iBinEta,2*k+rp,dEta,dv,w);
+   }
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::FinishEventSubsamples() {
+
+   //Fill each bootstrap replica of the event once per bin the event filled, with the mean flow (and x) of its tracks
+   //there and the weight of the replica times their number: the contents and entries of the bins, and so the spread
+   //of the replicas, are those of one fill per track (only the sums of squares and the numbers of fills, which the
+   //errors from the replicas do not use, differ), at one fill per bin instead of per track
+   const Int_t nPtCells = fSubsamplesPtAcc->GetAxisX().GetNBins()+2;
+   const Int_t nEtaCells = fSubsamplesEtaAcc->GetAxisX().GetNBins()+2;
+   for (Int_t c=0;c<fEventNReplicaCells;c++) {
+      const Int_t iCell = fEventReplicaCells[c];
+      Double_t *sums = &fEventReplicaSums[3*iCell];
+      const Double_t dv = sums[1]/sums[0];
+      const Double_t dx = sums[2]/sums[0];
+      for (Int_t s=0;s<fEventNSubsamples;s++) {
+         const Int_t k = fEventSubsamples[s];
+         const Double_t w = fEventSubsampleWeights[s]*sums[0];
+         if (iCell == 0) {
+            fSubsamplesIntAcc->Fill(1,k,0.,dv,w);
+         } else if (iCell <= 2*nPtCells) {
+            fSubsamplesPtAcc->Fill((iCell-1)%nPtCells,2*k+(iCell-1)/nPtCells,dx,dv,w);
+         } else {
+            fSubsamplesEtaAcc->Fill((iCell-1-2*nPtCells)%nEtaCells,2*k+(iCell-1-2*nPtCells)/nEtaCells,dx,dv,w);
+         }
+      }
+      sums[0] = 0.;
+      sums[1] = 0.;
+      sums[2] = 0.;
+   }
+   fEventNReplicaCells = 0;
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::FillTrackControl(Double_t dPt, Double_t dEta, Double_t dPhi, UInt_t uiSelection) {
+
+   //Fill the track control histograms of fCommonHists, and sum the Q vector of the RPs for those filled by FinishEvent().
+   //With FinishEvent() this is a copy of AliFlowCommonHist::FillControlHistograms(), which fills the same histograms
+   //for an AliFlowEventSimple: keep the two in sync
+   if (dPhi<0.) dPhi+=TMath::TwoPi();
+   if (uiSelection & AliFlowEventBatch::kRP) {
+      fCommonHists->GetHistPtRP()->Fill(dPt);
+      fCommonHists->GetHistPhiRP()->Fill(dPhi);
+      fCommonHists->GetHistEtaRP()->Fill(dEta);
+      fCommonHists->GetHistPhiEtaRP()->Fill(dEta,dPhi);
+      fCommonHists->GetHistWeightvsPhi()->Fill(dPhi,1.);
+      fEventQ2x += TMath::Cos(2.*dPhi);
+      fEventQ2y += TMath::Sin(2.*dPhi);
+      fEventMultRP++;
+   }
+   if (uiSelection & AliFlowEventBatch::kPOI) {
+      fCommonHists->GetHistPtPOI()->Fill(dPt);
+      fCommonHists->GetHistPhiPOI()->Fill(dPhi);
+      fCommonHists->GetHistEtaPOI()->Fill(dEta);
+      fCommonHists->GetHistPhiEtaPOI()->Fill(dEta,dPhi);
+      fCommonHists->GetHistProMeanPtperBin()->Fill(dPt,dPt);
+      fEventMultPOI++;
+   }
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::SetSelectionBits(Int_t const iRPBit, Int_t const iPOIBit) {
+
+   //Analyse the tracks with bit iRPBit of the selection word as RPs and those with bit iPOIBit as POIs
+   if (iRPBit < 0 || iRPBit >= 32 || iPOIBit < 0 || iPOIBit >= 32) {
+      cout<<"WARNING (MCEP): the selection word has the bits 0 to 31, selection bits not changed."<<endl;
+      return;
+   }
+   fRPSelectionBit = iRPBit;
+   fPOISelectionBit = iPOIBit;
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::SetPtSlices(Int_t const nCutOffs, const Double_t *ptCutOffs) {
+
+   //Split v(eta) into the nCutOffs+1 pt slices between the increasing values of ptCutOffs (before Init())
+   if (nCutOffs >= fgMaxPtSlices) {
+      cout<<"WARNING (MCEP): at most "<<fgMaxPtSlices-1<<" pt cut-offs, pt slices not changed."<<endl;
+      return;
+   }
+   if (fIntFlowAcc) {
+      cout<<"WARNING (MCEP): the profiles are booked already, pt slices not changed."<<endl;
+      return;
+   }
+   for (Int_t k=1;k<nCutOffs;k++) {
+      if (!(ptCutOffs[k-1] < ptCutOffs[k])) {
+         cout<<"WARNING (MCEP): the pt cut-offs are not increasing, pt slices not changed."<<endl;
+         return;
+      }
+   }
+   fNPtSlices = (nCutOffs > 0 ? nCutOffs+1 : 0);
+   for (Int_t k=0;k<nCutOffs;k++) fPtSliceCutOffs[k] = ptCutOffs[k];
+   //one lookup per track: the cut-offs as the edges of an axis, whose underflow is the first slice and whose
+   //overflow is the last
+   if (fNPtSlices) fPtSliceBinner->Set(nCutOffs-1,fPtSliceCutOffs);
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::SetNHarmonics(Int_t const n) {
+
+   //Measure the harmonics 1, ..., n in the same pass as fHarmonic (before Init())
+   if (n < 0 || n > fgMaxHarmonics) {
+      cout<<"WARNING (MCEP): at most "<<fgMaxHarmonics<<" harmonics in one pass, number of harmonics not changed."<<endl;
+      return;
+   }
+   if (fHarmonicsIntAcc) {
+      cout<<"WARNING (MCEP): the harmonics are booked already, number of harmonics not changed."<<endl;
+      return;
+   }
+   fNHarmonics = n;
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::SetNSubsamples(Int_t const n, Bool_t const bootstrap) {
+
+   //Take the errors of fHarmonic from n subsamples of the events, or from n bootstrap replicas (before Init())
+   if (n < 0 || n == 1 || n > fgMaxSubsamples) {
+      cout<<"WARNING (MCEP): 2 to "<<fgMaxSubsamples<<" subsamples (or 0 for none), subsamples not changed."<<endl;
+      return;
+   }
+   if (fSubsamplesIntAcc) {
+      cout<<"WARNING (MCEP): the subsamples are booked already, subsamples not changed."<<endl;
+      return;
+   }
+   fNSubsamples = n;
+   fBootstrap = bootstrap;
+}
+
+//-----------------------------------------------------------------------
+
+template<Int_t kHarmonic>
+class AliFlowAnalysisWithMCEventPlane_mod::StreamSink : public AliFlowEventSink {
+
+   //The streamed events of an analysis, its FillTrack() calling the kernels for kHarmonic directly
+   public:
+      StreamSink(AliFlowAnalysisWithMCEventPlane_mod *analysis) : fAnalysis(analysis) {}
+      virtual void BeginEvent(Double_t dMCReactionPlaneAngle, Int_t iReferenceMultiplicity, Int_t nRPs, Int_t nPOIs, Long64_t iEventIndex) {
+         fAnalysis->BeginEvent(dMCReactionPlaneAngle,iReferenceMultiplicity,nRPs,nPOIs,iEventIndex);
+      }
+      virtual void FillTrack(Double_t dPt, Double_t dEta, Double_t dPhi, Int_t /*iCharge*/, UInt_t uiSelection) {
+         //(a streamed event always fills the control histograms, see BeginEvent())
+         if (!uiSelection || fAnalysis->fRPSelectionBit != 0 || fAnalysis->fPOISelectionBit != 1) return;
+         fAnalysis->FillTrackControl(dPt,dEta,dPhi,uiSelection);
+         fAnalysis->FillTrackFlow<kHarmonic>(dPt,dEta,dPhi,uiSelection);
+         if (fAnalysis->fHarmonicsIntAcc) fAnalysis->FillTrackHarmonics(dPt,dEta,dPhi,uiSelection);
+      }
+      virtual void EndEvent(const AliFlowEventView &anEvent) {
+         fAnalysis->EndEvent(anEvent);
+      }
+   private:
+      StreamSink(const StreamSink &sink);             //copy constructor
+      StreamSink& operator=(const StreamSink &sink);  //assignment operator
+      AliFlowAnalysisWithMCEventPlane_mod *fAnalysis; // the analysis filled
+};
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::SelectKernels() {
+
+   //Pick the kernels specialized for fHarmonic; the harmonics up to 4 get their own, all others the generic one
+   if (fSink) delete fSink;
+   switch (fHarmonic) {
+      case 1:
+         fSink = new StreamSink<1>(this);
+         fFillTracks[0] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<1,kFALSE>;
+         fFillTracks[1] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<1,kTRUE>;
+         break;
+      case 2:
+         fSink = new StreamSink<2>(this);
+         fFillTracks[0] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<2,kFALSE>;
+         fFillTracks[1] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<2,kTRUE>;
+         break;
+      case 3:
+         fSink = new StreamSink<3>(this);
+         fFillTracks[0] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<3,kFALSE>;
+         fFillTracks[1] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<3,kTRUE>;
+         break;
+      case 4:
+         fSink = new StreamSink<4>(this);
+         fFillTracks[0] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<4,kFALSE>;
+         fFillTracks[1] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<4,kTRUE>;
+         break;
+      default:
+         fSink = new StreamSink<0>(this);
+         fFillTracks[0] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<0,kFALSE>;
+         fFillTracks[1] = &AliFlowAnalysisWithMCEventPlane_mod::FillTracks<0,kTRUE>;
+   }
+}
+
+//-----------------------------------------------------------------------
+
+template<Int_t kHarmonic, Bool_t kControl>
+void AliFlowAnalysisWithMCEventPlane_mod::FillTracks(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const UInt_t *selection) {
+
+   //Fill all tracks of one event, with or without the control histograms
+   for (Int_t i=0;i<n;i++) {
+      if (!selection[i]) continue;
+      if (kControl) this->FillTrackControl(pt[i],eta[i],phi[i],selection[i]);
+      this->FillTrackFlow<kHarmonic>(pt[i],eta[i],phi[i],selection[i]);
+   }
+}
+
+//-----------------------------------------------------------------------
+
+template<Int_t kHarmonic>
+void AliFlowAnalysisWithMCEventPlane_mod::FillTrackFlow(Double_t dPt, Double_t dEta, Double_t dPhi, UInt_t uiSelection) {
+
+   //Fill the flow profiles with one track tagged RP and/or POI (for harmonic 1 without any multiplication)
+   //(into the flat accumulators; all pt and eta profiles of RPs and POIs are booked on the same two axes,
+   //so the bins of the track are looked up once for all of them)
+   Double_t dv = TMath::Cos(this->HarmonicAngle<kHarmonic>(dPhi-fEventRP));
+   const Int_t iBinPt = fDiffFlowPtEtaAcc->FindBinX(dPt);
+   const Int_t iBinEta = fDiffFlowPtEtaAcc->FindBinY(dEta);
+   const Int_t iPtSlice = fPtSliceBinner->FindBin(dPt);
+   if (uiSelection & AliFlowEventBatch::kRP) {
+      //the Q vector of the RPs, for chi calculation:
+      fEventQx += TMath::Cos(this->HarmonicAngle<kHarmonic>(dPhi));
+      fEventQy += TMath::Sin(this->HarmonicAngle<kHarmonic>(dPhi));
+      //reference flow (x = 0 is bin 1):
+      fIntFlowAcc->Fill(1,0,0.,dv);
+      //reference flow versus multiplicity:
+      fIntFlowVsMAcc->Fill(fEventBinM,0,fEventNRPs+0.5,dv);
+      //reference flow e-b-e:
+      fEventFlowSum += dv;
+      fEventFlowCount++;
+      //differential flow (Pt, Eta, RP):
+      fDiffFlowPtEtaAcc->Fill(iBinPt,iBinEta,0,dPt,dEta,dv);
+      //differential flow (Pt, RP):
+      fDiffFlowPtAcc->Fill(iBinPt,0,dPt,dv);
+      //differential flow (Eta, RP):
+      fDiffFlowEtaAcc->Fill(iBinEta,0,dEta,dv);
+      //differential flow (Eta, RP) in the pt slice of the track:
+      if (fNPtSlices) fDiffFlowEtaSubPtAcc->Fill(iBinEta,iPtSlice,dEta,dv);
+      //the same in the subsample(s) of the event:
+      if (fEventNSubsamples) this->FillTrackSubsamples(iBinPt,iBinEta,0,dPt,dEta,dv);
+   }
+   if (uiSelection & AliFlowEventBatch::kPOI) {
+      //differential flow (Pt, Eta, POI):
+      fDiffFlowPtEtaAcc->Fill(iBinPt,iBinEta,1,dPt,dEta,dv);
+      //differential flow (Pt, POI):
+      fDiffFlowPtAcc->Fill(iBinPt,1,dPt,dv);
+      //differential flow (Eta, POI):
+      fDiffFlowEtaAcc->Fill(iBinEta,1,dEta,dv);
+      //differential flow (Eta, POI) in the pt slice of the track:
+      if (fNPtSlices) fDiffFlowEtaSubPtAcc->Fill(iBinEta,fNPtSlices+iPtSlice,dEta,dv);
+      //the same in the subsample(s) of the event:
+      if (fEventNSubsamples) this->FillTrackSubsamples(iBinPt,iBinEta,1,dPt,dEta,dv);
+   }       
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::MakeFromView(const AliFlowEventView &anEvent) {
+
+   //Fill the flow profiles from a columnar event whose control histograms are filled elsewhere
+   AliFlowEventView selected;
+   const AliFlowEventView &event = this->SelectTracks(anEvent,selected); //anEvent is in fArena, which is not reset
+   const Double_t *pt = event.GetPt();
+   const Double_t *eta = event.GetEta();
+   const Double_t *phi = event.GetPhi();
+   const UInt_t *selection = event.GetSelection();
+   Int_t iNumberOfTracks = event.NumberOfTracks(); 
+
+   this->StartEvent(event.GetMCReactionPlaneAngle(),event.GetEventNSelTracksRP(),event.GetReferenceMultiplicity(),event.GetEventIndex(),kFALSE);
+   //loop over the tracks of the event
+   (this->*fFillTracks[0])(iNumberOfTracks,pt,eta,phi,selection);
+   if (fHarmonicsIntAcc) this->FillHarmonics(iNumberOfTracks,pt,eta,phi,selection);
+   this->FinishEvent(event);
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::FillHarmonics(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const UInt_t *selection) {
+
+   //Fill the harmonics 1, ..., fNHarmonics with all tracks of one event
+   for (Int_t i=0;i<n;i++) {
+      if (!selection[i]) continue;
+      this->FillTrackHarmonics(pt[i],eta[i],phi[i],selection[i]);
+   }
+}
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::FillTrackHarmonics(Double_t dPt, Double_t dEta, Double_t dPhi, UInt_t uiSelection) {
+
+   //Fill cos(n(phi-RP)) and sin(n(phi-RP)) of one track for all harmonics n booked by Init(), from a single cos and
+   //sin of phi-RP: cos(n x) + i sin(n x) = (cos((n-1) x) + i sin((n-1) x))(cos(x) + i sin(x)), so each next harmonic
+   //costs four multiplications instead of a call to cos and one to sin (the rounding grows only linearly with n)
+   const Double_t dAngle = dPhi-fEventRP;
+   const Double_t dCos1 = TMath::Cos(dAngle);
+   const Double_t dSin1 = TMath::Sin(dAngle);
+   const Int_t iBinPt = fHarmonicsPtEtaAcc->FindBinX(dPt);
+   const Int_t iBinEta = fHarmonicsPtEtaAcc->FindBinY(dEta);
+   const Int_t nHarmonics = fHarmonicsIntAcc->GetNProfiles()/2;
+   Double_t dCosSin[2] = {dCos1,dSin1}; //cos(n(phi-RP)), sin(n(phi-RP))
+   for (Int_t k=0;k<nHarmonics;k++) {
+      if (k>0) {
+         const Double_t dCos = dCosSin[0]*dCos1-dCosSin[1]*dSin1;
+         dCosSin[1] = dCosSin[1]*dCos1+dCosSin[0]*dSin1;
+         dCosSin[0] = dCos;
+      }
+      for (Int_t cs=0;cs<2;cs++) {
+         if (uiSelection & AliFlowEventBatch::kRP) {
+            //reference flow and differential flow (Pt, Eta, Pt-Eta) of the RPs:
+            fHarmonicsIntAcc->Fill(1,2*k+cs,0.,dCosSin[cs]);
+            fHarmonicsPtAcc->Fill(iBinPt,4*k+cs,dPt,dCosSin[cs]);
+            fHarmonicsEtaAcc->Fill(iBinEta,4*k+cs,dEta,dCosSin[cs]);
+            fHarmonicsPtEtaAcc->Fill(iBinPt,iBinEta,4*k+cs,dPt,dEta,dCosSin[cs]);
+         }
+         if (uiSelection & AliFlowEventBatch::kPOI) {
+            //differential flow (Pt, Eta, Pt-Eta) of the POIs:
+            fHarmonicsPtAcc->Fill(iBinPt,4*k+2+cs,dPt,dCosSin[cs]);
+            fHarmonicsEtaAcc->Fill(iBinEta,4*k+2+cs,dEta,dCosSin[cs]);
+            fHarmonicsPtEtaAcc->Fill(iBinPt,iBinEta,4*k+2+cs,dPt,dEta,dCosSin[cs]);
+         }
+      }
+   }
+}
+
+//--------------------------------------------------------------------    
+
+TList* AliFlowAnalysisWithMCEventPlane_mod::GetHistList() {
+   // the output histograms, with all fills of Make() so far
+   this->FlushAccumulators();
+   return fHistList;
+}
+
+//--------------------------------------------------------------------    
+
+void AliFlowAnalysisWithMCEventPlane_mod::FlushAccumulators() {
+   // add the fills of Make() since the last call to the output profiles
+   if (fIntFlowAcc) fIntFlowAcc->Flush();
+   if (fIntFlowVsMAcc) fIntFlowVsMAcc->Flush();
+   if (fDiffFlowPtAcc) fDiffFlowPtAcc->Flush();
+   if (fDiffFlowEtaAcc) fDiffFlowEtaAcc->Flush();
+   if (fDiffFlowEtaSubPtAcc) fDiffFlowEtaSubPtAcc->Flush();
+   if (fDiffFlowPtEtaAcc) fDiffFlowPtEtaAcc->Flush();
+   if (fHarmonicsIntAcc) fHarmonicsIntAcc->Flush();
+   if (fHarmonicsPtAcc) fHarmonicsPtAcc->Flush();
+   if (fHarmonicsEtaAcc) fHarmonicsEtaAcc->Flush();
+   if (fHarmonicsPtEtaAcc) fHarmonicsPtEtaAcc->Flush();
+   if (fSubsamplesIntAcc) fSubsamplesIntAcc->Flush();
+   if (fSubsamplesPtAcc) fSubsamplesPtAcc->Flush();
+   if (fSubsamplesEtaAcc) fSubsamplesEtaAcc->Flush();
+   if (fPairCorrelatorVsMAcc) fPairCorrelatorVsMAcc->Flush();
+}
+
+//--------------------------------------------------------------------    
+
+Bool_t AliFlowAnalysisWithMCEventPlane_mod::Merge(AliFlowAnalysisWithMCEventPlane_mod &other) {
+   // add everything other has analysed to this analysis, both booked alike by Init(); the fills other still had pending
+   // move here (its accumulators are reset, so a later flush of other cannot count them twice), its histograms stay
+   // (threads merge their analyses pairwise, in a tree; the cost grows with the bins, not with the objects)
+   // a) the fills still pending in the flat accumulators, bin by bin
+   // b) the fills still pending in the accumulators of the profiles versus multiplicity
+   // c) all histograms, bin by bin with TH1::Add() (no clones, no lists of objects to merge), but the profiles versus
+   //    multiplicity, whose ranges differ, through their accumulators
+   // d) the sums over the events
+   // e) reset the accumulators of other
+   if (!fIntFlowAcc || !other.fIntFlowAcc || !fHistList || !other.fHistList) {
+      cout<<"WARNING (MCEP): Merge() needs two analyses after Init(), nothing merged."<<endl;
+      return kFALSE;
+   }
+   if ((fHarmonicsIntAcc != NULL) != (other.fHarmonicsIntAcc != NULL) || (fSubsamplesIntAcc != NULL) != (other.fSubsamplesIntAcc != NULL)
+       || (fPairCorrelatorVsMAcc != NULL) != (other.fPairCorrelatorVsMAcc != NULL)) {
+      cout<<"WARNING (MCEP): Merge() of analyses booked differently, nothing merged."<<endl;
+      return kFALSE;
+   }
+
+   // a) the fills still pending in the flat accumulators:
+   Bool_t bMerged = fIntFlowAcc->Merge(*other.fIntFlowAcc);
+   bMerged = fDiffFlowPtAcc->Merge(*other.fDiffFlowPtAcc) && bMerged;
+   bMerged = fDiffFlowEtaAcc->Merge(*other.fDiffFlowEtaAcc) && bMerged;
+   bMerged = fDiffFlowEtaSubPtAcc->Merge(*other.fDiffFlowEtaSubPtAcc) && bMerged;
+   bMerged = fDiffFlowPtEtaAcc->Merge(*other.fDiffFlowPtEtaAcc) && bMerged;
+   if (fHarmonicsIntAcc) {
+      bMerged = fHarmonicsIntAcc->Merge(*other.fHarmonicsIntAcc) && bMerged;
+      bMerged = fHarmonicsPtAcc->Merge(*other.fHarmonicsPtAcc) && bMerged;
+      bMerged = fHarmonicsEtaAcc->Merge(*other.fHarmonicsEtaAcc) && bMerged;
+      bMerged = fHarmonicsPtEtaAcc->Merge(*other.fHarmonicsPtEtaAcc) && bMerged;
+   }
+   if (fSubsamplesIntAcc) {
+      bMerged = fSubsamplesIntAcc->Merge(*other.fSubsamplesIntAcc) && bMerged;
+      bMerged = fSubsamplesPtAcc->Merge(*other.fSubsamplesPtAcc) && bMerged;
+      bMerged = fSubsamplesEtaAcc->Merge(*other.fSubsamplesEtaAcc) && bMerged;
+   }
+
+   // b) the fills still pending in the accumulators of the profiles versus multiplicity:
+   bMerged = fIntFlowVsMAcc->Merge(*other.fIntFlowVsMAcc) && bMerged;
+   if (fPairCorrelatorVsMAcc) bMerged = fPairCorrelatorVsMAcc->Merge(*other.fPairCorrelatorVsMAcc) && bMerged;
+
+   // c) all histograms, the profiles versus multiplicity through their accumulators (TH1::Add() is not guaranteed to be
+   //    thread safe, so analyses merged on parallel threads take turns here):
+   {
+      R__LOCKGUARD(gROOTMutex);
+      this->MergeHistograms(fHistList,other.fHistList);
+   }
+
+   // d) the sums over the events:
+   *fQsum += *other.fQsum;
+   fQ2sum += other.fQ2sum;
+   fEventNumber += other.fEventNumber;
+   fEventCounter = TMath::Max(fEventCounter,other.fEventCounter); // past the keys of both
+
+   // e) reset the accumulators of other:
+   other.ResetAccumulators();
+
+   return bMerged;
+}
+
+//--------------------------------------------------------------------    
+
+void AliFlowAnalysisWithMCEventPlane_mod::ResetAccumulators() {
+   // drop the fills still pending in the accumulators, leaving the output profiles as they are
+   if (fIntFlowAcc) fIntFlowAcc->Reset();
+   if (fIntFlowVsMAcc) fIntFlowVsMAcc->Reset();
+   if (fDiffFlowPtAcc) fDiffFlowPtAcc->Reset();
+   if (fDiffFlowEtaAcc) fDiffFlowEtaAcc->Reset();
+   if (fDiffFlowEtaSubPtAcc) fDiffFlowEtaSubPtAcc->Reset();
+   if (fDiffFlowPtEtaAcc) fDiffFlowPtEtaAcc->Reset();
+   if (fHarmonicsIntAcc) fHarmonicsIntAcc->Reset();
+   if (fHarmonicsPtAcc) fHarmonicsPtAcc->Reset();
+   if (fHarmonicsEtaAcc) fHarmonicsEtaAcc->Reset();
+   if (fHarmonicsPtEtaAcc) fHarmonicsPtEtaAcc->Reset();
+   if (fSubsamplesIntAcc) fSubsamplesIntAcc->Reset();
+   if (fSubsamplesPtAcc) fSubsamplesPtAcc->Reset();
+   if (fSubsamplesEtaAcc) fSubsamplesEtaAcc->Reset();
+   if (fPairCorrelatorVsMAcc) fPairCorrelatorVsMAcc->Reset();
+}
+
+//--------------------------------------------------------------------    
+
+void AliFlowAnalysisWithMCEventPlane_mod::ResetHistograms() {
+   // back to the state right after Init(): no pending fills, all histograms empty and as booked, no sums over the events;
+   // the settings filled by Init() stay. One analysis can so take block after block of the deterministic mode, each
+   // as a new analysis would, at the cost of one pass over the bins instead of booking and deleting them
+   // a) the pending fills and the histograms
+   // b) the profiles versus multiplicity back to one bin, and their accumulators to no bins
+   // c) the sums over the events
+   if (!fIntFlowAcc || !fHistList) {
+      cout<<"WARNING (MCEP): ResetHistograms() needs an analysis after Init(), nothing reset."<<endl;
+      return;
+   }
+
+   // a) the pending fills and the histograms (analyses reset on parallel threads take turns, as in Merge()):
+   this->ResetAccumulators();
+   R__LOCKGUARD(gROOTMutex);
+   this->ResetHistograms(fHistList);
+
+   // b) the profiles versus multiplicity back to one bin, and their accumulators to no bins (as booked by Init()):
+   fHistProIntFlowVsM->SetBins(1,0.,1.);
+   fIntFlowVsMAcc->Book(1,1.);
+   fIntFlowVsMAcc->SetProfile(0,fHistProIntFlowVsM);
+   if (fPairCorrelatorVsMAcc) {
+      Double_t dMultBinWidth = (this->GetMultBinWidth() > 0. ? this->GetMultBinWidth() : 1.);
+      fPairCorrelatorVsMAcc->Book(2,dMultBinWidth,fMinMult);
+      for (Int_t cs=0;cs<2;cs++) {
+         fPairCorrelatorVsM[cs]->SetBins(1,fMinMult,fMinMult+dMultBinWidth);
+         fPairCorrelatorVsMAcc->SetProfile(cs,fPairCorrelatorVsM[cs]);
+      }
+   }
+
+   // c) the sums over the events:
+   fQsum->Set(0.,0.);
+   fQ2sum = 0.;
+   fEventNumber = 0;
+   fEventCounter = 0;
+}
+
+//--------------------------------------------------------------------    
+
+void AliFlowAnalysisWithMCEventPlane_mod::ResetHistograms(TList *list) {
+   // empty every histogram of list, descending into nested lists and the common histograms; the settings filled by
+   // Init() stay (the arrays of squared weights the fills created stay too, zeroed: whether the root of the blocks has
+   // them depends on the blocks merged into it, not on which analysis took them)
+   for (Int_t k=0;k<list->GetEntries();k++) {
+      TObject *object = list->At(k);
+      if (object == fMixedHarmonicsSettings || object == fSubsamplesSettings || object == fCommonHists->GetHarmonic()) continue;
+      if (object->InheritsFrom(TList::Class())) {
+         this->ResetHistograms(static_cast<TList*>(object));
+      } else if (object->InheritsFrom(AliFlowCommonHist::Class())) {
+         this->ResetHistograms(static_cast<AliFlowCommonHist*>(object)->GetHistList());
+      } else if (object->InheritsFrom(TH1::Class())) {
+         static_cast<TH1*>(object)->Reset();
+      }
+   }
+}
+
+//--------------------------------------------------------------------    
+
+Bool_t AliFlowAnalysisWithMCEventPlane_mod::MergeOutput(TList *outputList) {
+   // add the output histograms of an analysis booked alike (its GetHistList(), e.g. sent by a PROOF worker) to this
+   // analysis, as Merge() does with those of an analysis; the sums over the events are not in the list and stay as
+   // they are. The profiles versus multiplicity are flushed, so the result is the same as of Merge() and a flush
+   if (!fIntFlowAcc || !fHistList || !outputList) {
+      cout<<"WARNING (MCEP): MergeOutput() needs an analysis after Init() and an output list, nothing merged."<<endl;
+      return kFALSE;
+   }
+   {
+      R__LOCKGUARD(gROOTMutex); //see Merge()
+      this->MergeHistograms(fHistList,outputList);
+   }
+   fIntFlowVsMAcc->Flush();
+   if (fPairCorrelatorVsMAcc) fPairCorrelatorVsMAcc->Flush();
+   return kTRUE;
+}
+
+//--------------------------------------------------------------------    
+
+void AliFlowAnalysisWithMCEventPlane_mod::MergeHistograms(TList *target, TList *source) {
+   // add the objects of source to those of target, booked alike, entry by entry and descending into nested lists;
+   // the profiles versus multiplicity go to their accumulators, to be added on the next flush
+   if (target->GetEntries() != source->GetEntries()) {
+      cout<<"WARNING (MCEP): "<<target->GetName()<<" holds other objects than in the analysis merged, not merged."<<endl;
+      return;
+   }
+   for (Int_t k=0;k<target->GetEntries();k++) {
+      TObject *pTarget = target->At(k);
+      TObject *pSource = source->At(k);
+      if (pTarget == fHistProIntFlowVsM) {
+         fIntFlowVsMAcc->Absorb(0,static_cast<TProfile*>(pSource));
+         continue;
+      }
+      if (pTarget == fPairCorrelatorVsM[0] || pTarget == fPairCorrelatorVsM[1]) {
+         fPairCorrelatorVsMAcc->Absorb((pTarget == fPairCorrelatorVsM[0] ? 0 : 1),static_cast<TProfile*>(pSource));
+         continue;
+      }
+      if (pTarget->InheritsFrom(TList::Class())) {
+         this->MergeHistograms(static_cast<TList*>(pTarget),static_cast<TList*>(pSource));
+      } else if (pTarget->InheritsFrom(AliFlowCommonHist::Class())) {
+         this->MergeHistograms(static_cast<AliFlowCommonHist*>(pTarget)->GetHistList(),static_cast<AliFlowCommonHist*>(pSource)->GetHistList());
+      } else if (pTarget->InheritsFrom(TH1::Class())) {
+         if (!static_cast<TH1*>(pTarget)->Add(static_cast<TH1*>(pSource))) {
+            cout<<"WARNING (MCEP): "<<pTarget->GetName()<<" has other bins than in the analysis merged, not merged."<<endl;
+         }
+      } else {
+         //anything else (the results, filled by Finish() only) through its own Merge():
+         ROOT::MergeFunc_t merge = pTarget->IsA()->GetMerge();
+         if (!merge) {
+            cout<<"WARNING (MCEP): "<<pTarget->GetName()<<" cannot be merged, kept as it is."<<endl;
+            continue;
+         }
+         TList others;
+         others.Add(pSource);
+         merge(pTarget,&others,NULL);
+      }
+   }
 }
 
 //--------------------------------------------------------------------    
 
 void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistograms(TList *outputListHistos) {
    // get the pointers to all output histograms before calling Finish()
+   // (the pending fills go to the profiles booked by Init(), not to the ones found here)
+   this->FlushAccumulators();
    if (outputListHistos) {
       //Get the common histograms from the output list
       AliFlowCommonHist *pCommonHists = dynamic_cast<AliFlowCommonHist*> 
@@ -381,15 +1179,6 @@ void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistograms(TList *outputListH
       TProfile *pHistProDiffFlowEtaRP = dynamic_cast<TProfile*> 
          (outputListHistos->FindObject("FlowPro_VetaRP_MCEP"));
 
-      TProfile *pHistDiffFlowEtaRPSubPt1 = dynamic_cast<TProfile*> 
-         (outputListHistos->FindObject("SubPt1_Veta_RP"));
-
-      TProfile *pHistDiffFlowEtaRPSubPt2 = dynamic_cast<TProfile*> 
-         (outputListHistos->FindObject("SubPt2_Veta_RP"));
-
-      TProfile *pHistDiffFlowEtaRPSubPt3 = dynamic_cast<TProfile*> 
-         (outputListHistos->FindObject("SubPt3_Veta_RP"));
- 
       TProfile2D *pHistProDiffFlowPtEtaPOI = dynamic_cast<TProfile2D*> 
          (outputListHistos->FindObject("FlowPro_VPtEtaPOI_MCEP")); 
           
@@ -399,14 +1188,6 @@ void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistograms(TList *outputListH
       TProfile *pHistProDiffFlowEtaPOI = dynamic_cast<TProfile*> 
          (outputListHistos->FindObject("FlowPro_VetaPOI_MCEP"));
 
-      TProfile *pHistDiffFlowEtaPOISubPt1 = dynamic_cast<TProfile*> 
-         (outputListHistos->FindObject("SubPt1_Veta_POI"));
-
-      TProfile *pHistDiffFlowEtaPOISubPt2 = dynamic_cast<TProfile*> 
-         (outputListHistos->FindObject("SubPt2_Veta_POI"));
-
-      TProfile *pHistDiffFlowEtaPOISubPt3 = dynamic_cast<TProfile*> 
-         (outputListHistos->FindObject("SubPt3_Veta_POI"));                        
 
       if (pCommonHists && pCommonHistResults && pHistProIntFlow && 
          pHistProDiffFlowPtRP && pHistProDiffFlowEtaRP && 
@@ -417,15 +1198,21 @@ void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistograms(TList *outputListH
          this->SetHistProDiffFlowPtEtaRP(pHistProDiffFlowPtEtaRP);
          this->SetHistProDiffFlowPtRP(pHistProDiffFlowPtRP);      
          this->SetHistProDiffFlowEtaRP(pHistProDiffFlowEtaRP);
-         this->SetHistProDiffFlowEtaRPSubPt1(pHistDiffFlowEtaRPSubPt1);
-         this->SetHistProDiffFlowEtaRPSubPt2(pHistDiffFlowEtaRPSubPt2);
-         this->SetHistProDiffFlowEtaRPSubPt3(pHistDiffFlowEtaRPSubPt3);
          this->SetHistProDiffFlowPtEtaPOI(pHistProDiffFlowPtEtaPOI);
          this->SetHistProDiffFlowPtPOI(pHistProDiffFlowPtPOI);      
          this->SetHistProDiffFlowEtaPOI(pHistProDiffFlowEtaPOI);      
-         this->SetHistProDiffFlowEtaPOISubPt1(pHistDiffFlowEtaPOISubPt1);
-         this->SetHistProDiffFlowEtaPOISubPt2(pHistDiffFlowEtaPOISubPt2);
-         this->SetHistProDiffFlowEtaPOISubPt3(pHistDiffFlowEtaPOISubPt3);
+         //the pt slices, as many as there are in the list:
+         fNPtSlices = 0;
+         for (Int_t s=0;s<fgMaxPtSlices;s++) {
+            TProfile *pHistDiffFlowEtaRPSubPt = dynamic_cast<TProfile*> 
+               (outputListHistos->FindObject(Form("SubPt%d_Veta_RP",s+1)));
+            TProfile *pHistDiffFlowEtaPOISubPt = dynamic_cast<TProfile*> 
+               (outputListHistos->FindObject(Form("SubPt%d_Veta_POI",s+1)));
+            if (!pHistDiffFlowEtaRPSubPt || !pHistDiffFlowEtaPOISubPt) break;
+            this->SetHistProDiffFlowEtaRPSubPt(pHistDiffFlowEtaRPSubPt,s);
+            this->SetHistProDiffFlowEtaPOISubPt(pHistDiffFlowEtaPOISubPt,s);
+            fNPtSlices++;
+         }
       } else {
          cout<<"WARNING: Histograms needed to run Finish() are not accessible!"<<endl;  }
     
@@ -434,6 +1221,14 @@ void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistograms(TList *outputListH
       TList *pMixedHarmonicsList = dynamic_cast<TList*> 
          (outputListHistos->FindObject("Mixed Harmonics"));
       if(pMixedHarmonicsList) {this->GetOutputHistoramsForMixedHarmonics(pMixedHarmonicsList);} 
+
+      TList *pHarmonicsList = dynamic_cast<TList*> 
+         (outputListHistos->FindObject("Harmonics"));
+      if(pHarmonicsList) {this->GetOutputHistogramsForHarmonics(pHarmonicsList);} 
+
+      TList *pSubsamplesList = dynamic_cast<TList*> 
+         (outputListHistos->FindObject("Subsamples"));
+      if(pSubsamplesList) {this->GetOutputHistogramsForSubsamples(pSubsamplesList);} 
   
   } else { cout << "histogram list pointer is empty" << endl;}
 
@@ -462,22 +1257,52 @@ void AliFlowAnalysisWithMCEventPlane_mod::Finish() {
    
    //*************make histograms etc. 
    if (fDebug) cout<<"AliFlowAnalysisWithMCEventPlane_mod::Terminate()"<<endl;
+   this->FlushAccumulators();
    
-   Int_t iNbinsPt  = AliFlowCommonConstants::GetMaster()->GetNbinsPt();  
-   Int_t iNbinsEta = AliFlowCommonConstants::GetMaster()->GetNbinsEta(); 
-  
    // access harmonic:
    if(fCommonHists && fCommonHists->GetHarmonic())
    {
       fHarmonic = (Int_t)(fCommonHists->GetHarmonic())->GetBinContent(1); // to be improved (moved somewhere else?)
    } 
          
+   //the errors from the subsamples, if there are any:
+   Bool_t bSubsamples = (fNSubsamples > 1 && fSubsampleIntFlow[0]);
+   if (bSubsamples) {
+      cout<<"errors of v"<<fHarmonic<<" from the spread of "<<fNSubsamples<<(fBootstrap ? " bootstrap replicas" : " subsamples")<<":"<<endl;
+   }
+   this->FinishHarmonic(fHarmonic,fCommonHistsRes,fHistProIntFlow,fHistProDiffFlowPtRP,fHistProDiffFlowEtaRP,
+                        fHistProDiffFlowPtPOI,fHistProDiffFlowEtaPOI,bSubsamples);
+
+   //harmonics 1, ..., fNHarmonics, from their cos profiles:
+   for(Int_t k=0;k<fNHarmonics;k++)
+   {
+      if(!fHarmonicResults[k]) continue;
+      this->FinishHarmonic(k+1,fHarmonicResults[k],fHarmonicIntFlow[k][0],fHarmonicDiffFlowPt[k][0][0],fHarmonicDiffFlowEta[k][0][0],
+                           fHarmonicDiffFlowPt[k][1][0],fHarmonicDiffFlowEta[k][1][0]);
+   }
+  
+   cout<<endl;                 
+   //cout<<".....finished"<<endl;
+}
+
+//--------------------------------------------------------------------    
+
+void AliFlowAnalysisWithMCEventPlane_mod::FinishHarmonic(Int_t iHarmonic, AliFlowCommonHistResults *results, TProfile *intFlow, TProfile *diffFlowPtRP, TProfile *diffFlowEtaRP,
+                                                         TProfile *diffFlowPtPOI, TProfile *diffFlowEtaPOI, Bool_t bSubsamples) {
+
+   //Fill results with the reference, integrated and differential flow of harmonic iHarmonic from its profiles
+   //(the pt spectra of fCommonHists weigh the integrated flow of every harmonic), with the errors from the spread of
+   //the subsamples if bSubsamples
+   Int_t iNbinsPt  = AliFlowCommonConstants::GetMaster()->GetNbinsPt();  
+   Int_t iNbinsEta = AliFlowCommonConstants::GetMaster()->GetNbinsEta(); 
+
    //reference flow :
-   Double_t dV = fHistProIntFlow->GetBinContent(1);  
-   Double_t dErrV = fHistProIntFlow->GetBinError(1); // to be improved (treatment of errors for non-Gaussian distribution needed!)  
+   Double_t dV = intFlow->GetBinContent(1);  
+   Double_t dErrV = intFlow->GetBinError(1); // to be improved (treatment of errors for non-Gaussian distribution needed!)  
+   if(bSubsamples) dErrV = this->SubsampleError(fSubsampleIntFlow,1);
    //fill reference flow:
-   fCommonHistsRes->FillIntegratedFlow(dV,dErrV);
-   cout<<"dV"<<fHarmonic<<"{MC} is       "<<dV<<" +- "<<dErrV<<endl;
+   results->FillIntegratedFlow(dV,dErrV);
+   cout<<"dV"<<iHarmonic<<"{MC} is       "<<dV<<" +- "<<dErrV<<endl;
   
    //RP:
    TH1F* fHistPtRP = NULL;
@@ -494,9 +1319,10 @@ void AliFlowAnalysisWithMCEventPlane_mod::Finish() {
    Double_t dErrvPtRP = 0.;
    for(Int_t b=1;b<=iNbinsPt;b++)
    {
-      dvPtRP    = fHistProDiffFlowPtRP->GetBinContent(b);
-      dErrvPtRP = fHistProDiffFlowPtRP->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
-      fCommonHistsRes->FillDifferentialFlowPtRP(b, dvPtRP, dErrvPtRP);
+      dvPtRP    = diffFlowPtRP->GetBinContent(b);
+      dErrvPtRP = diffFlowPtRP->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
+      if(bSubsamples) dErrvPtRP = this->SubsampleError(fSubsampleDiffFlowPt[0],b);
+      results->FillDifferentialFlowPtRP(b, dvPtRP, dErrvPtRP);
       if(fHistPtRP){
          //integrated flow (RP)
          dYieldPtRP = fHistPtRP->GetBinContent(b);
@@ -512,18 +1338,20 @@ void AliFlowAnalysisWithMCEventPlane_mod::Finish() {
       dErrVRP /= (dSumRP*dSumRP);
       dErrVRP = TMath::Sqrt(dErrVRP); 
    }
+   if(bSubsamples && fHistPtRP) dErrVRP = this->SubsampleError(fSubsampleDiffFlowPt[0],0,fHistPtRP);
    // fill integrated flow (RP):
-   fCommonHistsRes->FillIntegratedFlowRP(dVRP,dErrVRP);
-   cout<<"dV"<<fHarmonic<<"{MC} (RP) is  "<<dVRP<<" +- "<<dErrVRP<<endl;
+   results->FillIntegratedFlowRP(dVRP,dErrVRP);
+   cout<<"dV"<<iHarmonic<<"{MC} (RP) is  "<<dVRP<<" +- "<<dErrVRP<<endl;
   
    //differential flow (RP, Eta): 
    Double_t dvEtaRP = 0.;           
    Double_t dErrvEtaRP = 0.;
    for(Int_t b=1;b<=iNbinsEta;b++)
    {
-      dvEtaRP    = fHistProDiffFlowEtaRP->GetBinContent(b);
-      dErrvEtaRP = fHistProDiffFlowEtaRP->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
-      fCommonHistsRes->FillDifferentialFlowEtaRP(b, dvEtaRP, dErrvEtaRP);
+      dvEtaRP    = diffFlowEtaRP->GetBinContent(b);
+      dErrvEtaRP = diffFlowEtaRP->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
+      if(bSubsamples) dErrvEtaRP = this->SubsampleError(fSubsampleDiffFlowEta[0],b);
+      results->FillDifferentialFlowEtaRP(b, dvEtaRP, dErrvEtaRP);
    }
                                                                                                                                    
    //POI:
@@ -541,12 +1369,13 @@ void AliFlowAnalysisWithMCEventPlane_mod::Finish() {
    Double_t dvproEtaPOI = 0.;
    Double_t dErrdifcombEtaPOI = 0.;   
    //Pt:
-   if(fHistProDiffFlowPtPOI) {
+   if(diffFlowPtPOI) {
       for(Int_t b=1;b<=iNbinsPt;b++){
-         dvproPtPOI = fHistProDiffFlowPtPOI->GetBinContent(b);
-         dErrdifcombPtPOI = fHistProDiffFlowPtPOI->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
+         dvproPtPOI = diffFlowPtPOI->GetBinContent(b);
+         dErrdifcombPtPOI = diffFlowPtPOI->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
+         if(bSubsamples) dErrdifcombPtPOI = this->SubsampleError(fSubsampleDiffFlowPt[1],b);
          //fill TH1D
-         fCommonHistsRes->FillDifferentialFlowPtPOI(b, dvproPtPOI, dErrdifcombPtPOI); 
+         results->FillDifferentialFlowPtPOI(b, dvproPtPOI, dErrdifcombPtPOI); 
          if (fHistPtPOI){
             //integrated flow (POI)
             dYieldPtPOI = fHistPtPOI->GetBinContent(b);
@@ -563,28 +1392,308 @@ void AliFlowAnalysisWithMCEventPlane_mod::Finish() {
       dErrVPOI /= (dSumPOI*dSumPOI);
       dErrVPOI = TMath::Sqrt(dErrVPOI); 
    }
-   cout<<"dV"<<fHarmonic<<"{MC} (POI) is "<<dVPOI<<" +- "<<dErrVPOI<<endl;
+   if(bSubsamples && fHistPtPOI) dErrVPOI = this->SubsampleError(fSubsampleDiffFlowPt[1],0,fHistPtPOI);
+   cout<<"dV"<<iHarmonic<<"{MC} (POI) is "<<dVPOI<<" +- "<<dErrVPOI<<endl;
 
-   fCommonHistsRes->FillIntegratedFlowPOI(dVPOI,dErrVPOI);
+   results->FillIntegratedFlowPOI(dVPOI,dErrVPOI);
   
    //Eta:
-   if(fHistProDiffFlowEtaPOI)
+   if(diffFlowEtaPOI)
    {
       for(Int_t b=1;b<=iNbinsEta;b++)
       {
-         dvproEtaPOI = fHistProDiffFlowEtaPOI->GetBinContent(b);
-         dErrdifcombEtaPOI = fHistProDiffFlowEtaPOI->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
+         dvproEtaPOI = diffFlowEtaPOI->GetBinContent(b);
+         dErrdifcombEtaPOI = diffFlowEtaPOI->GetBinError(b);//to be improved (treatment of errors for non-Gaussian distribution needed!)
+         if(bSubsamples) dErrdifcombEtaPOI = this->SubsampleError(fSubsampleDiffFlowEta[1],b);
          //fill common hist results:
-         fCommonHistsRes->FillDifferentialFlowEtaPOI(b, dvproEtaPOI, dErrdifcombEtaPOI); 
+         results->FillDifferentialFlowEtaPOI(b, dvproEtaPOI, dErrdifcombEtaPOI); 
       }
    }   
   
-   cout<<endl;                 
-   //cout<<".....finished"<<endl;
 }
 
 //-----------------------------------------------------------------------
 
+void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForHarmonics()
+{
+   // Book all objects needed for the harmonics 1, ..., fNHarmonics.
+
+   // List holding one list per harmonic:
+   fHarmonicsList->SetName("Harmonics");
+   fHarmonicsList->SetOwner(kTRUE);
+   fHistList->Add(fHarmonicsList);
+
+   Int_t iNbinsPt = AliFlowCommonConstants::GetMaster()->GetNbinsPt();
+   Double_t dPtMin = AliFlowCommonConstants::GetMaster()->GetPtMin();       
+   Double_t dPtMax = AliFlowCommonConstants::GetMaster()->GetPtMax();
+   Int_t iNbinsEta = AliFlowCommonConstants::GetMaster()->GetNbinsEta();
+   Double_t dEtaMin = AliFlowCommonConstants::GetMaster()->GetEtaMin();       
+   Double_t dEtaMax = AliFlowCommonConstants::GetMaster()->GetEtaMax();  
+
+   // The cos profiles carry the names of the profiles of fHarmonic, the sin profiles (which average to zero for
+   // the MC reaction plane and only check the fills) the prefix SinPro instead of FlowPro:
+   TString cosSinFlag[2] = {"FlowPro","SinPro"};
+   TString rpPoiFlag[2] = {"RP","POI"};
+   for(Int_t k=0;k<fNHarmonics;k++)
+   {
+      TList *harmonicList = new TList();
+      harmonicList->SetName(Form("v%d",k+1));
+      harmonicList->SetOwner(kTRUE);
+      fHarmonicsList->Add(harmonicList);
+
+      fHarmonicResults[k] = new AliFlowCommonHistResults(Form("AliFlowCommonHistResultsMCEP_v%d",k+1),"",k+1);
+      harmonicList->Add(fHarmonicResults[k]);
+
+      for(Int_t cs=0;cs<2;cs++)
+      {
+         fHarmonicIntFlow[k][cs] = new TProfile(Form("%s_V_MCEP",cosSinFlag[cs].Data()),Form("%s_V_MCEP",cosSinFlag[cs].Data()),1,0.,1.);
+         fHarmonicIntFlow[k][cs]->SetLabelSize(0.06);
+         (fHarmonicIntFlow[k][cs]->GetXaxis())->SetBinLabel(1,Form("v_{%d}{MCEP}",k+1));
+         harmonicList->Add(fHarmonicIntFlow[k][cs]);
+         for(Int_t rp=0;rp<2;rp++)
+         {
+            fHarmonicDiffFlowPtEta[k][rp][cs] = new TProfile2D(Form("%s_VPtEta%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data()),Form("%s_VPtEta%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data()),iNbinsPt,dPtMin,dPtMax,iNbinsEta,dEtaMin,dEtaMax);
+            fHarmonicDiffFlowPtEta[k][rp][cs]->SetXTitle("P_{t}");
+            fHarmonicDiffFlowPtEta[k][rp][cs]->SetYTitle("#eta");
+            harmonicList->Add(fHarmonicDiffFlowPtEta[k][rp][cs]);
+
+            fHarmonicDiffFlowPt[k][rp][cs] = new TProfile(Form("%s_VPt%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data()),Form("%s_VPt%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data()),iNbinsPt,dPtMin,dPtMax);
+            fHarmonicDiffFlowPt[k][rp][cs]->SetXTitle("P_{t}");
+            harmonicList->Add(fHarmonicDiffFlowPt[k][rp][cs]);
+
+            fHarmonicDiffFlowEta[k][rp][cs] = new TProfile(Form("%s_Veta%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data()),Form("%s_Veta%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data()),iNbinsEta,dEtaMin,dEtaMax);
+            fHarmonicDiffFlowEta[k][rp][cs]->SetXTitle("#eta");
+            fHarmonicDiffFlowEta[k][rp][cs]->SetYTitle(Form("v_{%d}",k+1));
+            harmonicList->Add(fHarmonicDiffFlowEta[k][rp][cs]);
+         } // end of for(Int_t rp=0;rp<2;rp++)
+      } // end of for(Int_t cs=0;cs<2;cs++)
+   } // end of for(Int_t k=0;k<fNHarmonics;k++)
+
+   // Flat accumulators of all harmonics, one per axis, so a track looks up its bins once for all of them:
+   fHarmonicsIntAcc = new AliFlowProfileAccumulator();
+   fHarmonicsIntAcc->Book(2*fNHarmonics,fHarmonicIntFlow[0][0]->GetXaxis());
+   fHarmonicsPtAcc = new AliFlowProfileAccumulator();
+   fHarmonicsPtAcc->Book(4*fNHarmonics,fHarmonicDiffFlowPt[0][0][0]->GetXaxis());
+   fHarmonicsEtaAcc = new AliFlowProfileAccumulator();
+   fHarmonicsEtaAcc->Book(4*fNHarmonics,fHarmonicDiffFlowEta[0][0][0]->GetXaxis());
+   fHarmonicsPtEtaAcc = new AliFlowProfileAccumulator();
+   fHarmonicsPtEtaAcc->Book(4*fNHarmonics,fHarmonicDiffFlowPtEta[0][0][0]->GetXaxis(),fHarmonicDiffFlowPtEta[0][0][0]->GetYaxis());
+   for(Int_t k=0;k<fNHarmonics;k++)
+   {
+      for(Int_t cs=0;cs<2;cs++)
+      {
+         fHarmonicsIntAcc->SetProfile(2*k+cs,fHarmonicIntFlow[k][cs]);
+         for(Int_t rp=0;rp<2;rp++)
+         {
+            fHarmonicsPtAcc->SetProfile(4*k+2*rp+cs,fHarmonicDiffFlowPt[k][rp][cs]);
+            fHarmonicsEtaAcc->SetProfile(4*k+2*rp+cs,fHarmonicDiffFlowEta[k][rp][cs]);
+            fHarmonicsPtEtaAcc->SetProfile(4*k+2*rp+cs,fHarmonicDiffFlowPtEta[k][rp][cs]);
+         }
+      }
+   }
+
+} // end of void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForHarmonics()
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistogramsForHarmonics(TList *harmonicsList)
+{
+   // Get pointers to the objects of the harmonics, as many as there are lists "v1", "v2", ... in harmonicsList.
+   if(harmonicsList)
+   {
+      TString cosSinFlag[2] = {"FlowPro","SinPro"};
+      TString rpPoiFlag[2] = {"RP","POI"};
+      fNHarmonics = 0;
+      for(Int_t k=0;k<fgMaxHarmonics;k++)
+      {
+         TList *harmonicList = dynamic_cast<TList*>(harmonicsList->FindObject(Form("v%d",k+1)));
+         if(!harmonicList) break;
+         fHarmonicResults[k] = dynamic_cast<AliFlowCommonHistResults*>
+            (harmonicList->FindObject(Form("AliFlowCommonHistResultsMCEP_v%d",k+1)));
+         for(Int_t cs=0;cs<2;cs++)
+         {
+            fHarmonicIntFlow[k][cs] = dynamic_cast<TProfile*>(harmonicList->FindObject(Form("%s_V_MCEP",cosSinFlag[cs].Data())));
+            for(Int_t rp=0;rp<2;rp++)
+            {
+               fHarmonicDiffFlowPtEta[k][rp][cs] = dynamic_cast<TProfile2D*>
+                  (harmonicList->FindObject(Form("%s_VPtEta%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data())));
+               fHarmonicDiffFlowPt[k][rp][cs] = dynamic_cast<TProfile*>
+                  (harmonicList->FindObject(Form("%s_VPt%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data())));
+               fHarmonicDiffFlowEta[k][rp][cs] = dynamic_cast<TProfile*>
+                  (harmonicList->FindObject(Form("%s_Veta%s_MCEP",cosSinFlag[cs].Data(),rpPoiFlag[rp].Data())));
+            }
+         }
+         if(!fHarmonicResults[k] || !fHarmonicIntFlow[k][0] || !fHarmonicDiffFlowPt[k][0][0] || !fHarmonicDiffFlowEta[k][0][0]
+            || !fHarmonicDiffFlowPt[k][1][0] || !fHarmonicDiffFlowEta[k][1][0])
+         {
+            cout<<"WARNING (MCEP): histograms of harmonic "<<k+1<<" needed to run Finish() are not accessible!"<<endl;
+            fHarmonicResults[k] = NULL; // skipped by Finish()
+         }
+         fNHarmonics++;
+      } // end of for(Int_t k=0;k<fgMaxHarmonics;k++)
+   } else
+   {
+      cout<<endl;
+      cout<<"WARNING (MCEP): harmonicsList in NULL in MCEP::GetOutputHistogramsForHarmonics() !!!! "<<endl;
+      cout<<endl;
+   } 
+
+} // end of void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistogramsForHarmonics(TList *harmonicsList)
+
+//-----------------------------------------------------------------------
+
+Double_t AliFlowAnalysisWithMCEventPlane_mod::SubsampleError(TProfile *const *subsamples, Int_t bin, const TH1F *yield) const
+{
+   // Error of the flow in bin from the spread of its value over the subsamples (those that have entries there); with a
+   // yield, of the flow averaged over all bins with the yield as weights, as the integrated flow: the same sum over the
+   // same bins as the central value in FinishHarmonic(), a bin a subsample has no entries in counting
+   // as zero flow there too. A subsample holds about
+   // 1/n of the events, so the error of the mean of all is the spread over sqrt(n); a bootstrap replica holds as many
+   // events as all, so its spread is the error itself.
+
+   Double_t dSum = 0.;
+   Double_t dSum2 = 0.;
+   Int_t n = 0;
+   for(Int_t k=0;k<fNSubsamples;k++)
+   {
+      if(!subsamples[k]) continue;
+      Double_t dv = 0.;
+      if(yield)
+      {
+         Double_t dYield = 0.;
+         for(Int_t b=1;b<=subsamples[k]->GetNbinsX();b++)
+         {
+            dv += subsamples[k]->GetBinContent(b)*yield->GetBinContent(b);
+            dYield += yield->GetBinContent(b);
+         }
+         if(TMath::AreEqualAbs(dYield,0.0,1e-10)) continue;
+         dv /= dYield;
+      } else
+      {
+         if(subsamples[k]->GetBinEntries(bin) <= 0.) continue;
+         dv = subsamples[k]->GetBinContent(bin);
+      }
+      dSum += dv;
+      dSum2 += dv*dv;
+      n++;
+   }
+   if(n < 2) return 0.;
+   Double_t dVariance = TMath::Max((dSum2-dSum*dSum/n)/(n-1),0.);
+
+   return TMath::Sqrt(fBootstrap ? dVariance : dVariance/n);
+
+} // end of Double_t AliFlowAnalysisWithMCEventPlane_mod::SubsampleError(TProfile *const *subsamples, Int_t bin, const TH1F *yield) const
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForSubsamples()
+{
+   // Book all objects needed for the subsamples (or bootstrap replicas).
+
+   // List holding the settings and the profiles of all subsamples:
+   fSubsamplesList = new TList();
+   fSubsamplesList->SetName("Subsamples");
+   fSubsamplesList->SetOwner(kTRUE);
+   fHistList->Add(fSubsamplesList);
+
+   fSubsamplesSettings = new TProfile("fSubsamplesSettings","Settings for Subsamples",2,0,2);
+   fSubsamplesSettings->GetXaxis()->SetBinLabel(1,"fNSubsamples");
+   fSubsamplesSettings->Fill(0.5,fNSubsamples);
+   fSubsamplesSettings->GetXaxis()->SetBinLabel(2,"fBootstrap");
+   fSubsamplesSettings->Fill(1.5,(Int_t)fBootstrap);
+   fSubsamplesList->Add(fSubsamplesSettings);
+
+   // The profiles of fHarmonic per subsample, on their bins, with the suffix _Sub<k>:
+   TString rpPoiFlag[2] = {"RP","POI"};
+   for(Int_t k=0;k<fNSubsamples;k++)
+   {
+      fSubsampleIntFlow[k] = new TProfile(Form("FlowPro_V_MCEP_Sub%d",k),Form("FlowPro_V_MCEP_Sub%d",k),1,0.,1.);
+      fSubsamplesList->Add(fSubsampleIntFlow[k]);
+      for(Int_t rp=0;rp<2;rp++)
+      {
+         fSubsampleDiffFlowPt[rp][k] = static_cast<TProfile*>(fHistProDiffFlowPtRP->Clone(Form("FlowPro_VPt%s_MCEP_Sub%d",rpPoiFlag[rp].Data(),k)));
+         fSubsampleDiffFlowPt[rp][k]->Reset();
+         fSubsamplesList->Add(fSubsampleDiffFlowPt[rp][k]);
+         fSubsampleDiffFlowEta[rp][k] = static_cast<TProfile*>(fHistProDiffFlowEtaRP->Clone(Form("FlowPro_Veta%s_MCEP_Sub%d",rpPoiFlag[rp].Data(),k)));
+         fSubsampleDiffFlowEta[rp][k]->Reset();
+         fSubsamplesList->Add(fSubsampleDiffFlowEta[rp][k]);
+      }
+   }
+
+   // Flat accumulators of all subsamples, one per axis (the axes of fDiffFlowPtAcc and fDiffFlowEtaAcc, so the bins of a track are looked up once):
+   fSubsamplesIntAcc = new AliFlowProfileAccumulator();
+   fSubsamplesIntAcc->Book(fNSubsamples,fSubsampleIntFlow[0]->GetXaxis());
+   fSubsamplesPtAcc = new AliFlowProfileAccumulator();
+   fSubsamplesPtAcc->Book(2*fNSubsamples,fHistProDiffFlowPtRP->GetXaxis());
+   fSubsamplesEtaAcc = new AliFlowProfileAccumulator();
+   fSubsamplesEtaAcc->Book(2*fNSubsamples,fHistProDiffFlowEtaRP->GetXaxis());
+   for(Int_t k=0;k<fNSubsamples;k++)
+   {
+      fSubsamplesIntAcc->SetProfile(k,fSubsampleIntFlow[k]);
+      for(Int_t rp=0;rp<2;rp++)
+      {
+         fSubsamplesPtAcc->SetProfile(2*k+rp,fSubsampleDiffFlowPt[rp][k]);
+         fSubsamplesEtaAcc->SetProfile(2*k+rp,fSubsampleDiffFlowEta[rp][k]);
+      }
+   }
+
+   // Bootstrap: the sums of one event per bin, the integrated one, pt of RPs and POIs and eta of them, under- and
+   // overflow included (see FinishEventSubsamples()):
+   if(fBootstrap)
+   {
+      Int_t nCells = 1+2*(fSubsamplesPtAcc->GetAxisX().GetNBins()+2)+2*(fSubsamplesEtaAcc->GetAxisX().GetNBins()+2);
+      fEventReplicaSums = new Double_t[3*nCells];
+      for(Int_t c=0;c<3*nCells;c++){fEventReplicaSums[c] = 0.;}
+      fEventReplicaCells = new Int_t[nCells];
+      fEventNReplicaCells = 0;
+   }
+
+} // end of void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForSubsamples()
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistogramsForSubsamples(TList *subsamplesList)
+{
+   // Get pointers to the settings and profiles of the subsamples in subsamplesList.
+   if(subsamplesList)
+   {
+      fSubsamplesSettings = dynamic_cast<TProfile*>(subsamplesList->FindObject("fSubsamplesSettings"));
+      if(!fSubsamplesSettings)
+      {
+         cout<<"WARNING (MCEP): fSubsamplesSettings is not accessible, errors not from the subsamples!"<<endl;
+         fNSubsamples = 0;
+         return;
+      }
+      // the settings are the same in every analysis merged, so their means are those of each:
+      fNSubsamples = TMath::Min(TMath::Nint(fSubsamplesSettings->GetBinContent(1)),fgMaxSubsamples);
+      fBootstrap = (TMath::Nint(fSubsamplesSettings->GetBinContent(2)) != 0);
+      TString rpPoiFlag[2] = {"RP","POI"};
+      for(Int_t k=0;k<fNSubsamples;k++)
+      {
+         fSubsampleIntFlow[k] = dynamic_cast<TProfile*>(subsamplesList->FindObject(Form("FlowPro_V_MCEP_Sub%d",k)));
+         for(Int_t rp=0;rp<2;rp++)
+         {
+            fSubsampleDiffFlowPt[rp][k] = dynamic_cast<TProfile*>(subsamplesList->FindObject(Form("FlowPro_VPt%s_MCEP_Sub%d",rpPoiFlag[rp].Data(),k)));
+            fSubsampleDiffFlowEta[rp][k] = dynamic_cast<TProfile*>(subsamplesList->FindObject(Form("FlowPro_Veta%s_MCEP_Sub%d",rpPoiFlag[rp].Data(),k)));
+         }
+         if(!fSubsampleIntFlow[k] || !fSubsampleDiffFlowPt[0][k] || !fSubsampleDiffFlowPt[1][k] || !fSubsampleDiffFlowEta[0][k] || !fSubsampleDiffFlowEta[1][k])
+         {
+            cout<<"WARNING (MCEP): profiles of subsample "<<k<<" are not accessible, errors not from the subsamples!"<<endl;
+            fNSubsamples = 0;
+            return;
+         }
+      }
+   } else
+   {
+      cout<<endl;
+      cout<<"WARNING (MCEP): subsamplesList in NULL in MCEP::GetOutputHistogramsForSubsamples() !!!! "<<endl;
+      cout<<endl;
+   }
+
+} // end of void AliFlowAnalysisWithMCEventPlane_mod::GetOutputHistogramsForSubsamples(TList *subsamplesList)
+
+//-----------------------------------------------------------------------
+
 void AliFlowAnalysisWithMCEventPlane_mod::InitalizeArraysForMixedHarmonics()
 {
    // Iinitialize all arrays for mixed harmonics.
@@ -614,7 +1723,7 @@ void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForMixedHarmonics()
  
    // Profile holding settings relevant for mixed harmonics:
    TString mixedHarmonicsSettingsName = "fMixedHarmonicsSettings";
-   fMixedHarmonicsSettings = new TProfile(mixedHarmonicsSettingsName.Data(),"Settings for Mixed Harmonics",4,0,4);
+   fMixedHarmonicsSettings = new TProfile(mixedHarmonicsSettingsName.Data(),"Settings for Mixed Harmonics",7,0,7);
    //fMixedHarmonicsSettings->GetXaxis()->SetLabelSize(0.025);
    fMixedHarmonicsSettings->GetXaxis()->SetBinLabel(1,"fEvaluateMixedHarmonics");
    fMixedHarmonicsSettings->Fill(0.5,(Int_t)fEvaluateMixedHarmonics); 
@@ -624,7 +1733,17 @@ void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForMixedHarmonics()
    fMixedHarmonicsSettings->Fill(2.5,(Int_t)fMinCorrelator);
    fMixedHarmonicsSettings->GetXaxis()->SetBinLabel(4,"x in #phi_{pair}"); // phi_{pair} = x*phi1+(1-x)*phi2
    fMixedHarmonicsSettings->Fill(3.5,fXinPairAngle); 
+   fMixedHarmonicsSettings->GetXaxis()->SetBinLabel(5,"fPairwiseMixedHarmonics");
+   fMixedHarmonicsSettings->Fill(4.5,(Int_t)fPairwiseMixedHarmonics); 
+   fMixedHarmonicsSettings->GetXaxis()->SetBinLabel(7,"fMaxPairsPairwise");
+   fMixedHarmonicsSettings->Fill(6.5,fMaxPairsPairwise); 
    fMixedHarmonicsList->Add(fMixedHarmonicsSettings);
+
+   // Events evaluated pair by pair (exact) and from the Q-vectors (one entry per event, approximate versus pt sum and difference):
+   fMixedHarmonicsMode = new TH1D("fMixedHarmonicsMode","Events per evaluation of the mixed harmonics",2,0,2);
+   fMixedHarmonicsMode->GetXaxis()->SetBinLabel(1,"pair by pair");
+   fMixedHarmonicsMode->GetXaxis()->SetBinLabel(2,"Q-vectors");
+   fMixedHarmonicsList->Add(fMixedHarmonicsMode);
  
    // Profiles used to calculate <cos[m*phi_{pair}-n*RP]> and <sin[m*phi_{pair}-n*RP]>, where phi_{pair} = x*phi1+(1-x)*phi2:
    TString cosSinFlag[2] = {"Cos","Sin"};
@@ -644,14 +1763,20 @@ void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForMixedHarmonics()
    //Double_t dPtMax = AliFlowCommonConstants::GetMaster()->GetPtMax(); 
    Double_t dPtMin = 0.;      
    Double_t dPtMax = 50.; 
+   // Versus multiplicity the bins of fnBinsMult in [fMinMult,fMaxMult) and beyond, but only those between the lowest
+   // and the highest multiplicity filled (see fPairCorrelatorVsMAcc):
+   Double_t dMultBinWidth = (this->GetMultBinWidth() > 0. ? this->GetMultBinWidth() : 1.);
+   fPairCorrelatorVsMAcc = new AliFlowAutoRangeProfileAccumulator();
+   fPairCorrelatorVsMAcc->Book(2,dMultBinWidth,fMinMult);
    for(Int_t cs=0;cs<2;cs++)
    {
       fPairCorrelator[cs] = new TProfile(Form("%s, %s",pairCorrelatorName.Data(),cosSinFlag[cs].Data()),cosSinTitleFlag[cs].Data(),1,0.,1.);
       fPairCorrelator[cs]->GetXaxis()->SetBinLabel(1,cosSinTitleFlag[cs].Data());
       fMixedHarmonicsList->Add(fPairCorrelator[cs]); 
   
-      fPairCorrelatorVsM[cs] = new TProfile(Form("%s, %s",pairCorrelatorVsMName.Data(),cosSinFlag[cs].Data()),cosSinTitleFlag[cs].Data(),fnBinsMult,fMinMult,fMaxMult);
+      fPairCorrelatorVsM[cs] = new TProfile(Form("%s, %s",pairCorrelatorVsMName.Data(),cosSinFlag[cs].Data()),cosSinTitleFlag[cs].Data(),1,fMinMult,fMinMult+dMultBinWidth);
       fPairCorrelatorVsM[cs]->GetXaxis()->SetTitle("# of RPs");
+      fPairCorrelatorVsMAcc->SetProfile(cs,fPairCorrelatorVsM[cs]);
       fMixedHarmonicsList->Add(fPairCorrelatorVsM[cs]); 
   
       for(Int_t sd=0;sd<2;sd++)
@@ -662,20 +1787,226 @@ void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForMixedHarmonics()
       } // end of for(Int_t sd=0;sd<2;sd++)
    } // end of for(Int_t cs=0;cs<2;cs++)
 
+   // Q-vectors per pt bin and sums over the pairs per pt sum and difference, for one event at a time:
+   if(fnBinsPtInQVectors <= 0){fnBinsPtInQVectors = 4*iNbinsPt;}
+   fMixedHarmonicsSettings->GetXaxis()->SetBinLabel(6,"fnBinsPtInQVectors");
+   fMixedHarmonicsSettings->Fill(5.5,fnBinsPtInQVectors); 
+   fMixedHarmonicsPtQ = new Double_t[9*fnBinsPtInQVectors];
+   for(Int_t k=0;k<9*fnBinsPtInQVectors;k++){fMixedHarmonicsPtQ[k] = 0.;}
+   fMixedHarmonicsPtOccupied = new Int_t[2*fnBinsPtInQVectors];
+   fMixedHarmonicsPairSums = new Double_t[3*(3*fnBinsPtInQVectors-1)];
+   for(Int_t k=0;k<3*(3*fnBinsPtInQVectors-1);k++){fMixedHarmonicsPairSums[k] = 0.;}
+
 } // end of void AliFlowAnalysisWithMCEventPlane_mod::BookObjectsForMixedHarmonics()
 
 //-----------------------------------------------------------------------
 
 void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonics(AliFlowEventSimple* anEvent)
 {
-   // Evaluate correlators relevant for the mixed harmonics.
+   // Evaluate correlators relevant for the mixed harmonics (compatibility with AliFlowEventSimple).
+
+   fArena->Reset();
+   AliFlowEventView view;
+   view.Set(anEvent,fArena);
+   this->EvaluateMixedHarmonics(view);
+
+} // end of void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonics(AliFlowEventSimple* anEvent)
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonics(const AliFlowEventView &anEvent)
+{
+   // Evaluate correlators relevant for the mixed harmonics, over all pairs of an RP (1) and a different POI (2).
+   // With Q_{a}(S) the sum of exp(i*a*phi) over the tracks in S, the sum over these pairs
+   //    sum exp(i(m*phi_{pair}-n*RP)) = [Q_{m*x}(RPs) Q_{m*(1-x)}(POIs) - Q_{m}(RPs that are POIs)] exp(-i*n*RP),
+   // where the last term removes the pairs of a track with itself, takes one pass over the tracks instead of one
+   // over the pairs. Each event then enters the profiles once, with its average over the pairs and their number as
+   // weight. This gives the same averages as one fill per pair, but not the same entries and errors: there is one
+   // entry per event, and the errors follow from the spread of the event averages (the pairs of one event are
+   // correlated through their common reaction plane, which one fill per pair ignores). Versus the pt sum and
+   // difference the same holds per pair of pt bins of the Q-vectors (fnBinsPtInQVectors over the range of those
+   // profiles, tracks outside of it only count for the rest), with the pairs of two bins spread over the profile bins
+   // as those of tracks uniform in their bins would be. So only events with more than fMaxPairsPairwise RPs x POIs
+   // take this path; the others, and all of them if fPairwiseMixedHarmonics, go through the exact loop over the pairs
+   // of EvaluateMixedHarmonicsPairwise(), which costs about as much at a few thousand pairs. fMixedHarmonicsMode
+   // counts the events of either path.
+
+   // a) Q-vectors of the event, in total and per pt bin;
+   // b) Correlators and correlators versus multiplicity;
+   // c) Correlators versus pt sum and difference, from the pairs of pt bins;
+   // d) Reset the pt bins for the next event.
+
+   Int_t nPOI = 0;
+   for(Int_t i=0;i<anEvent.NumberOfTracks();i++){if(anEvent.GetSelection()[i] & AliFlowEventBatch::kPOI){nPOI++;}}
+   if(fPairwiseMixedHarmonics || (Double_t)anEvent.GetEventNSelTracksRP()*nPOI <= fMaxPairsPairwise)
+   {
+      fMixedHarmonicsMode->Fill(0.5);
+      this->EvaluateMixedHarmonicsPairwise(anEvent);
+      return;
+   }
+   fMixedHarmonicsMode->Fill(1.5);
+
+   // a) Q-vectors of the event, in total and per pt bin:
+   Double_t dReactionPlane = anEvent.GetMCReactionPlaneAngle();  
+   Int_t iNumberOfTracks = anEvent.NumberOfTracks(); 
+   Int_t nRP = anEvent.GetEventNSelTracksRP(); // number of Reference Particles
+   const Double_t *pt = anEvent.GetPt();
+   const Double_t *phi = anEvent.GetPhi();
+   const UInt_t *selection = anEvent.GetSelection();
+   Double_t n = fNinCorrelator; // shortcut
+   Double_t m = fMinCorrelator; // shortcut
+   Double_t x = fXinPairAngle; // shortcut
+   Int_t nBins = fnBinsPtInQVectors; // shortcut
+   Double_t dPtMin = fPairCorrelatorVsPtSumDiff[0][0]->GetXaxis()->GetXmin();
+   Double_t dBinWidth = (fPairCorrelatorVsPtSumDiff[0][0]->GetXaxis()->GetXmax()-dPtMin)/nBins;
+   Double_t dQ[9] = {0.}; // RP re, im, count, POI re, im, count, RP and POI re, im, count
+   Int_t *iOccupiedRP = fMixedHarmonicsPtOccupied;
+   Int_t *iOccupiedPOI = fMixedHarmonicsPtOccupied+nBins;
+   Int_t nOccupiedRP = 0;
+   Int_t nOccupiedPOI = 0;
+   const UInt_t uiRPAndPOI = AliFlowEventBatch::kRP | AliFlowEventBatch::kPOI;
+   const Bool_t bHalf = (x == 0.5); // phi_{pair} = (phi1+phi2)/2: both tracks take the same factor
+   for(Int_t i=0;i<iNumberOfTracks;i++) 
+   {
+      if(!(selection[i] & uiRPAndPOI)) continue;
+      Double_t dTrack[9] = {0.}; // the terms of this track
+      Double_t dCos1 = TMath::Cos(m*x*phi[i]);
+      Double_t dSin1 = TMath::Sin(m*x*phi[i]);
+      Double_t dCos2 = (bHalf ? dCos1 : TMath::Cos(m*(1.-x)*phi[i]));
+      Double_t dSin2 = (bHalf ? dSin1 : TMath::Sin(m*(1.-x)*phi[i]));
+      if(selection[i] & AliFlowEventBatch::kRP){dTrack[0] = dCos1; dTrack[1] = dSin1; dTrack[2] = 1.;}
+      if(selection[i] & AliFlowEventBatch::kPOI){dTrack[3] = dCos2; dTrack[4] = dSin2; dTrack[5] = 1.;}
+      if((selection[i] & uiRPAndPOI) == uiRPAndPOI) // exp(i*m*phi) = exp(i*m*x*phi) exp(i*m*(1-x)*phi)
+      {
+         dTrack[6] = dCos1*dCos2-dSin1*dSin2;
+         dTrack[7] = dSin1*dCos2+dCos1*dSin2;
+         dTrack[8] = 1.;
+      }
+      for(Int_t k=0;k<9;k++){dQ[k] += dTrack[k];}
+      Int_t iBin = (Int_t)TMath::Floor((pt[i]-dPtMin)/dBinWidth);
+      if(iBin < 0 || iBin >= nBins) continue;
+      Double_t *dQBin = &fMixedHarmonicsPtQ[9*iBin];
+      if(dTrack[2] > 0. && dQBin[2] == 0.){iOccupiedRP[nOccupiedRP++] = iBin;}
+      if(dTrack[5] > 0. && dQBin[5] == 0.){iOccupiedPOI[nOccupiedPOI++] = iBin;}
+      for(Int_t k=0;k<9;k++){dQBin[k] += dTrack[k];}
+   } // end of for(Int_t i=0;i<iNumberOfTracks;i++) 
+
+   // b) Correlators and correlators versus multiplicity:
+   Double_t dCosRP = TMath::Cos(n*dReactionPlane);
+   Double_t dSinRP = TMath::Sin(n*dReactionPlane);
+   Double_t dPairs = dQ[2]*dQ[5]-dQ[8];
+   if(dPairs > 0.)
+   {
+      Double_t dRe = dQ[0]*dQ[3]-dQ[1]*dQ[4]-dQ[6];
+      Double_t dIm = dQ[0]*dQ[4]+dQ[1]*dQ[3]-dQ[7];
+      Double_t dCorrelator[2] = {(dRe*dCosRP+dIm*dSinRP)/dPairs,(dIm*dCosRP-dRe*dSinRP)/dPairs};
+      Int_t iBinM = fPairCorrelatorVsMAcc->FindBin(nRP+0.5);
+      for(Int_t cs=0;cs<2;cs++)
+      {
+         fPairCorrelator[cs]->Fill(0.5,dCorrelator[cs],dPairs); 
+         fPairCorrelatorVsMAcc->Fill(iBinM,cs,nRP+0.5,dCorrelator[cs],dPairs);
+      }
+   }
+
+   // c) Correlators versus pt sum and difference, from the pairs of pt bins (the pt sum of bins b1 and b2 depends
+   //    only on b1+b2, their difference only on |b1-b2|):
+   Double_t *dPairSumsSum = fMixedHarmonicsPairSums; // [b1+b2][cos, sin, pairs]
+   Double_t *dPairSumsDiff = fMixedHarmonicsPairSums+3*(2*nBins-1); // [|b1-b2|][cos, sin, pairs]
+   for(Int_t r=0;r<nOccupiedRP;r++)
+   {
+      Int_t b1 = iOccupiedRP[r];
+      const Double_t *dQ1 = &fMixedHarmonicsPtQ[9*b1];
+      for(Int_t p=0;p<nOccupiedPOI;p++)
+      {
+         Int_t b2 = iOccupiedPOI[p];
+         const Double_t *dQ2 = &fMixedHarmonicsPtQ[9*b2];
+         Double_t dRe = dQ1[0]*dQ2[3]-dQ1[1]*dQ2[4];
+         Double_t dIm = dQ1[0]*dQ2[4]+dQ1[1]*dQ2[3];
+         Double_t dPairsBins = dQ1[2]*dQ2[5];
+         if(b1 == b2)
+         {
+            dRe -= dQ1[6];
+            dIm -= dQ1[7];
+            dPairsBins -= dQ1[8];
+         }
+         if(!(dPairsBins > 0.)) continue;
+         Double_t *dSum = &dPairSumsSum[3*(b1+b2)];
+         Double_t *dDiff = &dPairSumsDiff[3*TMath::Abs(b1-b2)];
+         dSum[0] += dRe; dSum[1] += dIm; dSum[2] += dPairsBins;
+         dDiff[0] += dRe; dDiff[1] += dIm; dDiff[2] += dPairsBins;
+      } // end of for(Int_t p=0;p<nOccupiedPOI;p++)
+   } // end of for(Int_t r=0;r<nOccupiedRP;r++)
+   for(Int_t sd=0;sd<2;sd++)
+   {
+      Double_t *dPairSums = (sd == 0 ? dPairSumsSum : dPairSumsDiff);
+      Int_t nPairBins = (sd == 0 ? 2*nBins-1 : nBins);
+      TAxis *axis = fPairCorrelatorVsPtSumDiff[0][sd]->GetXaxis();
+      Double_t dProfileMin = axis->GetXmin();
+      Double_t dProfileBinWidth = (axis->GetXmax()-dProfileMin)/axis->GetNbins();
+      for(Int_t k=0;k<nPairBins;k++)
+      {
+         Double_t *dSums = &dPairSums[3*k];
+         if(dSums[2] > 0.)
+         {
+            // For tracks uniform in their bins the pt sum (1/2)(pt1+pt2) spreads as a triangle of half width
+            // dBinWidth/2 around that of the bin centres, the difference |pt1-pt2| as one of half width dBinWidth
+            // around theirs (folded at 0 for the same bin); each profile bin gets the fraction of the pairs the
+            // triangle puts into it, so that no bin takes all pairs whose centre falls on its edge:
+            Double_t dCentre = (sd == 0 ? dPtMin+0.5*(k+1)*dBinWidth : k*dBinWidth);
+            Double_t dHalfWidth = (sd == 0 ? 0.5 : 1.)*dBinWidth;
+            Bool_t bFolded = (sd == 1 && k == 0);
+            Double_t dLow = (bFolded ? dCentre : dCentre-dHalfWidth);
+            Double_t dHigh = dCentre+dHalfWidth;
+            Double_t dCorrelator[2] = {(dSums[0]*dCosRP+dSums[1]*dSinRP)/dSums[2],(dSums[1]*dCosRP-dSums[0]*dSinRP)/dSums[2]};
+            Int_t jLow = TMath::Max(0,(Int_t)TMath::Floor((dLow-dProfileMin)/dProfileBinWidth));
+            Int_t jHigh = TMath::Min(axis->GetNbins()-1,(Int_t)TMath::Floor((dHigh-dProfileMin)/dProfileBinWidth));
+            for(Int_t j=jLow;j<=jHigh;j++)
+            {
+               Double_t dFrom = TMath::Max(dLow,dProfileMin+j*dProfileBinWidth);
+               Double_t dTo = TMath::Min(dHigh,dProfileMin+(j+1)*dProfileBinWidth);
+               Double_t dFraction = (bFolded ? 2. : 1.)*(TriangleCDF((dTo-dCentre)/dHalfWidth)-TriangleCDF((dFrom-dCentre)/dHalfWidth));
+               if(!(dFraction > 0.)) continue;
+               for(Int_t cs=0;cs<2;cs++){fPairCorrelatorVsPtSumDiff[cs][sd]->Fill(0.5*(dFrom+dTo),dCorrelator[cs],dFraction*dSums[2]);}
+            }
+         }
+         dSums[0] = 0.; dSums[1] = 0.; dSums[2] = 0.;
+      }
+   } // end of for(Int_t sd=0;sd<2;sd++)
+
+   // d) Reset the pt bins for the next event:
+   for(Int_t r=0;r<nOccupiedRP;r++){for(Int_t k=0;k<9;k++){fMixedHarmonicsPtQ[9*iOccupiedRP[r]+k] = 0.;}}
+   for(Int_t p=0;p<nOccupiedPOI;p++){for(Int_t k=0;k<9;k++){fMixedHarmonicsPtQ[9*iOccupiedPOI[p]+k] = 0.;}}
+
+} // end of void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonics(const AliFlowEventView &anEvent)
+
+//-----------------------------------------------------------------------
+
+Double_t AliFlowAnalysisWithMCEventPlane_mod::TriangleCDF(Double_t t)
+{
+   // Fraction of the area of the triangle of half width 1 around 0 below t: the distribution of the sum (or
+   // difference) of two uniform variables of range 1 around that of their centres.
+
+   if(t <= -1.) return 0.;
+   if(t >= 1.) return 1.;
+   return (t < 0. ? 0.5*(1.+t)*(1.+t) : 1.-0.5*(1.-t)*(1.-t));
+
+} // end of Double_t AliFlowAnalysisWithMCEventPlane_mod::TriangleCDF(Double_t t)
+
+//-----------------------------------------------------------------------
+
+void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonicsPairwise(const AliFlowEventView &anEvent)
+{
+   // Evaluate correlators relevant for the mixed harmonics pair by pair (one fill per pair of an RP and a different
+   // POI): exact, for the events with few pairs.
  
    // Get the MC reaction plane angle:
-   Double_t dReactionPlane = anEvent->GetMCReactionPlaneAngle();  
+   Double_t dReactionPlane = anEvent.GetMCReactionPlaneAngle();  
    // Get the number of tracks:
-   Int_t iNumberOfTracks = anEvent->NumberOfTracks(); 
-   Int_t nRP = anEvent->GetEventNSelTracksRP(); // number of Reference Particles
-   AliFlowTrackSimple *pTrack = NULL;
+   Int_t iNumberOfTracks = anEvent.NumberOfTracks(); 
+   Int_t nRP = anEvent.GetEventNSelTracksRP(); // number of Reference Particles
+   const Double_t *pt = anEvent.GetPt();
+   const Double_t *phi = anEvent.GetPhi();
+   const UInt_t *selection = anEvent.GetSelection();
    Double_t dPhi1 = 0.;
    Double_t dPhi2 = 0.;
    Double_t dPt1 = 0.;
@@ -683,36 +2014,29 @@ void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonics(AliFlowEventSim
    Double_t n = fNinCorrelator; // shortcut
    Double_t m = fMinCorrelator; // shortcut
    Double_t x = fXinPairAngle; // shortcut
+   Int_t iBinM = fPairCorrelatorVsMAcc->FindBin(nRP+0.5); // the same for all pairs
    for(Int_t i=0;i<iNumberOfTracks;i++) 
    {
-      pTrack = anEvent->GetTrack(i); 
-      if(pTrack && pTrack->InRPSelection())
-      {
-         dPhi1 = pTrack->Phi();
-         dPt1 = pTrack->Pt();
-      }
+      if(!(selection[i] & AliFlowEventBatch::kRP)) continue;
+      dPhi1 = phi[i];
+      dPt1 = pt[i];
       for(Int_t j=0;j<iNumberOfTracks;j++) 
       {
          if(j==i) continue;
-         pTrack = anEvent->GetTrack(j); 
-         if(pTrack && pTrack->InPOISelection())
-         {
-            dPhi2 = pTrack->Phi();
-            dPt2 = pTrack->Pt();
-         }  
+         if(!(selection[j] & AliFlowEventBatch::kPOI)) continue;
+         dPhi2 = phi[j];
+         dPt2 = pt[j];
          Double_t dPhiPair = x*dPhi1+(1.-x)*dPhi2;
          Double_t dPtSum = 0.5*(dPt1+dPt2);
          Double_t dPtDiff = TMath::Abs(dPt1-dPt2);
          fPairCorrelator[0]->Fill(0.5,TMath::Cos(m*dPhiPair-n*dReactionPlane),1.); 
          fPairCorrelator[1]->Fill(0.5,TMath::Sin(m*dPhiPair-n*dReactionPlane),1.); 
-         fPairCorrelatorVsM[0]->Fill(nRP+0.5,TMath::Cos(m*dPhiPair-n*dReactionPlane),1.);
-         fPairCorrelatorVsM[1]->Fill(nRP+0.5,TMath::Sin(m*dPhiPair-n*dReactionPlane),1.);
+         fPairCorrelatorVsMAcc->Fill(iBinM,0,nRP+0.5,TMath::Cos(m*dPhiPair-n*dReactionPlane),1.);
+         fPairCorrelatorVsMAcc->Fill(iBinM,1,nRP+0.5,TMath::Sin(m*dPhiPair-n*dReactionPlane),1.);
          fPairCorrelatorVsPtSumDiff[0][0]->Fill(dPtSum,TMath::Cos(m*dPhiPair-n*dReactionPlane),1.);
          fPairCorrelatorVsPtSumDiff[1][0]->Fill(dPtSum,TMath::Sin(m*dPhiPair-n*dReactionPlane),1.);
          fPairCorrelatorVsPtSumDiff[0][1]->Fill(dPtDiff,TMath::Cos(m*dPhiPair-n*dReactionPlane),1.);
          fPairCorrelatorVsPtSumDiff[1][1]->Fill(dPtDiff,TMath::Sin(m*dPhiPair-n*dReactionPlane),1.);
-      } // end of for(Int_t j=i+1;j<iNumberOfTracks;j++) 
+      } // end of for(Int_t j=0;j<iNumberOfTracks;j++) 
    } // end of for(Int_t i=0;i<iNumberOfTracks;i++) 
-} // end of void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonics()
-
-
+} // end of void AliFlowAnalysisWithMCEventPlane_mod::EvaluateMixedHarmonicsPairwise(const AliFlowEventView &anEvent)
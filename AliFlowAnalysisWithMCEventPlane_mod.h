@@ -9,12 +9,19 @@
 #ifndef AliFlowAnalysisWithMCEventPlane_MOD_H
 #define AliFlowAnalysisWithMCEventPlane_MOD_H
 
+#include "AliFlowEventSink.h"
+
 class TVector2;
 class TString;
 class TDirectoryFile;
 
 class AliFlowTrackSimple;
 class AliFlowEventSimple;
+class AliFlowEventView;
+class AliFlowTrackArena;
+class AliFlowProfileAccumulator;
+class AliFlowAxisBinner;
+class AliFlowAutoRangeProfileAccumulator;
 class AliFlowCommonHist;
 class AliFlowCommonHistResults;
 
@@ -30,7 +37,7 @@ class Riostream;
 
 
  
-class AliFlowAnalysisWithMCEventPlane_mod {
+class AliFlowAnalysisWithMCEventPlane_mod : public AliFlowEventSink {
 
    public:
  
@@ -40,17 +47,33 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       void      WriteHistograms(TDirectoryFile *outputFileName);
       void      Init();                                       //defines variables and histograms
       void      Make(AliFlowEventSimple* anEvent);            //calculates variables and fills histograms
+      void      Make(const AliFlowEventView &anEvent);        //same, for an event stored column by column
+      // same, for an event streamed track by track from the generator (AliFlowEventSink):
+      virtual void BeginEvent(Double_t dMCReactionPlaneAngle, Int_t iReferenceMultiplicity, Int_t nRPs, Int_t nPOIs, Long64_t iEventIndex);
+      virtual void FillTrack(Double_t dPt, Double_t dEta, Double_t dPhi, Int_t iCharge, UInt_t uiSelection);
+      virtual void EndEvent(const AliFlowEventView &anEvent);
+      // the same sink with FillTrack() specialized for fHarmonic (picked by Init()), to stream the events into instead of this:
+      AliFlowEventSink* GetSink() const {return this->fSink;};
       void      GetOutputHistograms(TList *outputListHistos); //get pointers to all output histograms (called before Finish()) 
       void      Finish();                                     //saves histograms
+      void      FlushAccumulators();                          //adds the fills of Make() to the output profiles
+      Bool_t    Merge(AliFlowAnalysisWithMCEventPlane_mod &other); //adds all other analysed (booked alike), bin by bin; takes over its pending fills
+      Bool_t    MergeOutput(TList *outputList);              //adds the output histograms of an analysis booked alike, bin by bin
+      void      ResetAccumulators();                          //drops the fills of Make() not flushed yet
+      void      ResetHistograms();                            //back to the state after Init() (the settings stay), for other events
 
       void      SetDebug(Bool_t kt)          { this->fDebug = kt ; }
       Bool_t    GetDebug() const             { return this->fDebug ; }
 
       void      SetEventNumber(Int_t n)      { this->fEventNumber = n; }
       Int_t     GetEventNumber() const       { return this->fEventNumber; }
+      // Events without an index (AliFlowEventSimple) key their subsamples by this counter: analyses that share such a
+      // stream and are merged later start at the number of events before their part
+      void      SetEventCounter(Long64_t n)  { this->fEventCounter = n; }
+      Long64_t  GetEventCounter() const      { return this->fEventCounter; }
 
       // Output 
-      TList*    GetHistList() const          { return this->fHistList ; }  
+      TList*    GetHistList();                                //output histograms, with the fills of Make() so far
       AliFlowCommonHist* GetCommonHists() const  { return this->fCommonHists; }
       void      SetCommonHists(AliFlowCommonHist* const aCommonHist)  
         { this->fCommonHists = aCommonHist; }
@@ -82,17 +105,9 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       void      SetHistProDiffFlowEtaRP(TProfile* const aHistProDiffFlowEtaRP) 
         {this->fHistProDiffFlowEtaRP = aHistProDiffFlowEtaRP; }
 
-      TProfile* GetHistProDiffFlowEtaRPSubPt1() const   {return this->fHistDiffFlowEtaRPSubPt1; } 
-      void      SetHistProDiffFlowEtaRPSubPt1(TProfile* const aHistDiffFlowEtaRPSubPt1) 
-        {this->fHistDiffFlowEtaRPSubPt1 = aHistDiffFlowEtaRPSubPt1; }
-
-      TProfile* GetHistProDiffFlowEtaRPSubPt2() const   {return this->fHistDiffFlowEtaRPSubPt2; } 
-      void      SetHistProDiffFlowEtaRPSubPt2(TProfile* const aHistDiffFlowEtaRPSubPt2) 
-        {this->fHistDiffFlowEtaRPSubPt2 = aHistDiffFlowEtaRPSubPt2; }
-
-      TProfile* GetHistProDiffFlowEtaRPSubPt3() const   {return this->fHistDiffFlowEtaRPSubPt3; } 
-      void      SetHistProDiffFlowEtaRPSubPt3(TProfile* const aHistDiffFlowEtaRPSubPt3) 
-        {this->fHistDiffFlowEtaRPSubPt3 = aHistDiffFlowEtaRPSubPt3; }
+      TProfile* GetHistProDiffFlowEtaRPSubPt(Int_t const s) const   {return (s >= 0 && s < fNPtSlices ? this->fHistDiffFlowEtaRPSubPt[s] : NULL); } 
+      void      SetHistProDiffFlowEtaRPSubPt(TProfile* const aHistDiffFlowEtaRPSubPt, Int_t const s) 
+        {if (s >= 0 && s < fgMaxPtSlices) this->fHistDiffFlowEtaRPSubPt[s] = aHistDiffFlowEtaRPSubPt; }
         
       TProfile2D* GetHistProDiffFlowPtEtaPOI()const     {return this->fHistProDiffFlowPtEtaPOI; } 
       void      SetHistProDiffFlowPtEtaPOI(TProfile2D* const aHistProDiffFlowPtEtaPOI) 
@@ -106,17 +121,9 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       void      SetHistProDiffFlowEtaPOI(TProfile* const aHistProDiffFlowEtaPOI) 
         {this->fHistProDiffFlowEtaPOI = aHistProDiffFlowEtaPOI; }
 
-      TProfile* GetHistProDiffFlowEtaPOISubPt1() const   {return this->fHistDiffFlowEtaPOISubPt1; } 
-      void      SetHistProDiffFlowEtaPOISubPt1(TProfile* const aHistDiffFlowEtaPOISubPt1) 
-        {this->fHistDiffFlowEtaPOISubPt1 = aHistDiffFlowEtaPOISubPt1; }
-
-      TProfile* GetHistProDiffFlowEtaPOISubPt2() const   {return this->fHistDiffFlowEtaPOISubPt2; } 
-      void      SetHistProDiffFlowEtaPOISubPt2(TProfile* const aHistDiffFlowEtaPOISubPt2) 
-        {this->fHistDiffFlowEtaPOISubPt2 = aHistDiffFlowEtaPOISubPt2; }
-
-      TProfile* GetHistProDiffFlowEtaPOISubPt3() const   {return this->fHistDiffFlowEtaPOISubPt3; } 
-      void      SetHistProDiffFlowEtaPOISubPt3(TProfile* const aHistDiffFlowEtaPOISubPt3) 
-        {this->fHistDiffFlowEtaPOISubPt3 = aHistDiffFlowEtaPOISubPt3; }
+      TProfile* GetHistProDiffFlowEtaPOISubPt(Int_t const s) const   {return (s >= 0 && s < fNPtSlices ? this->fHistDiffFlowEtaPOISubPt[s] : NULL); } 
+      void      SetHistProDiffFlowEtaPOISubPt(TProfile* const aHistDiffFlowEtaPOISubPt, Int_t const s) 
+        {if (s >= 0 && s < fgMaxPtSlices) this->fHistDiffFlowEtaPOISubPt[s] = aHistDiffFlowEtaPOISubPt; }
         
       TH1D* GetHistSpreadOfFlow()const   {return this->fHistSpreadOfFlow; } 
       void      SetHistSpreadOfFlow(TH1D* const aHistSpreadOfFlow) 
@@ -126,6 +133,13 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       void SetHarmonic(Int_t const harmonic) {this->fHarmonic = harmonic;};
       Int_t GetHarmonic() const {return this->fHarmonic;};
 
+      // tracks analysed: RPs are the tracks with bit iRPBit of the selection word set, POIs those with bit iPOIBit (the
+      // default 0 and 1 are the RP and POI cuts); a higher bit is a cut set of AliFlowEventSimpleMakerOnTheFly_mod::AddSelection(),
+      // so that analyses of different selections can share one generated sample:
+      void SetSelectionBits(Int_t const iRPBit, Int_t const iPOIBit);
+      Int_t GetRPSelectionBit() const {return this->fRPSelectionBit;};
+      Int_t GetPOISelectionBit() const {return this->fPOISelectionBit;};
+
 
       // rapidity plotting range:
       void SetEtaRange(Double_t const etaMin, Double_t const etaMax) {this->fEtaMin = etaMin; this->fEtaMax = etaMax;};
@@ -135,12 +149,51 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       void SetPtRange(Double_t const ptMin, Double_t const ptMax) {this->fPtMin = ptMin; this->fPtMax = ptMax;};
       void SetNbinsPt(Int_t const nBinsPt) {this->fNbinsPt = nBinsPt;};
 
+      // pt slices of v(eta), the profiles SubPt<s>_Veta_RP and _POI: slice s = 1, ..., nCutOffs+1 is
+      // ptCutOffs[s-2] <= pt < ptCutOffs[s-1], open at both ends (default: 3 and 5 GeV, nCutOffs = 0: no slices):
+      void SetPtSlices(Int_t const nCutOffs, const Double_t *ptCutOffs);
+      Int_t GetNPtSlices() const {return this->fNPtSlices;};
+      static const Int_t fgMaxPtSlices = 32; // maximal number of pt slices
+
+      // harmonics 1, ..., n measured in the same pass (besides fHarmonic), from cos and sin of one angle per track:
+      // a) methods:
+      virtual void BookObjectsForHarmonics();
+      virtual void GetOutputHistogramsForHarmonics(TList *harmonicsList);
+      // b) setters and getters:
+      static const Int_t fgMaxHarmonics = 8; // highest harmonic measured in one pass
+      void SetNHarmonics(Int_t const n); // n = 0: only fHarmonic
+      Int_t GetNHarmonics() const {return this->fNHarmonics;};
+      TList* GetHarmonicsList() const {return this->fHarmonicsList;}
+      AliFlowCommonHistResults* GetHarmonicResults(Int_t const n) const {return (n >= 1 && n <= fNHarmonics ? this->fHarmonicResults[n-1] : NULL);}
+      TProfile* GetHarmonicIntFlow(Int_t const n, Int_t const cs) const {return (n >= 1 && n <= fNHarmonics ? this->fHarmonicIntFlow[n-1][cs] : NULL);}
+      TProfile* GetHarmonicDiffFlowPt(Int_t const n, Int_t const rp, Int_t const cs) const {return (n >= 1 && n <= fNHarmonics ? this->fHarmonicDiffFlowPt[n-1][rp][cs] : NULL);}
+      TProfile* GetHarmonicDiffFlowEta(Int_t const n, Int_t const rp, Int_t const cs) const {return (n >= 1 && n <= fNHarmonics ? this->fHarmonicDiffFlowEta[n-1][rp][cs] : NULL);}
+      TProfile2D* GetHarmonicDiffFlowPtEta(Int_t const n, Int_t const rp, Int_t const cs) const {return (n >= 1 && n <= fNHarmonics ? this->fHarmonicDiffFlowPtEta[n-1][rp][cs] : NULL);}
+
+      // statistical errors of fHarmonic from subsamples of the events (or bootstrap replicas), without storing the events:
+      // a) methods:
+      virtual void BookObjectsForSubsamples();
+      virtual void GetOutputHistogramsForSubsamples(TList *subsamplesList);
+      // b) setters and getters:
+      static const Int_t fgMaxSubsamples = 64; // most subsamples or replicas
+      // n subsamples, each event in one of them, or n replicas with Poisson(1) weights per event (bootstrap); the errors of
+      // the reference, integrated and differential flow become the spread of the subsamples (n = 0: the profile errors)
+      void SetNSubsamples(Int_t const n, Bool_t const bootstrap = kFALSE);
+      Int_t GetNSubsamples() const {return this->fNSubsamples;};
+      Bool_t GetBootstrap() const {return this->fBootstrap;};
+      TList* GetSubsamplesList() const {return this->fSubsamplesList;}
+      TProfile* GetSubsampleIntFlow(Int_t const k) const {return (k >= 0 && k < fNSubsamples ? this->fSubsampleIntFlow[k] : NULL);}
+      TProfile* GetSubsampleDiffFlowPt(Int_t const rp, Int_t const k) const {return (k >= 0 && k < fNSubsamples ? this->fSubsampleDiffFlowPt[rp][k] : NULL);}
+      TProfile* GetSubsampleDiffFlowEta(Int_t const rp, Int_t const k) const {return (k >= 0 && k < fNSubsamples ? this->fSubsampleDiffFlowEta[rp][k] : NULL);}
+
       // mixed harmonics:
       // a) methods:
       virtual void InitalizeArraysForMixedHarmonics();
       virtual void BookObjectsForMixedHarmonics();
       virtual void EvaluateMixedHarmonics(AliFlowEventSimple* anEvent);
+      virtual void EvaluateMixedHarmonics(const AliFlowEventView &anEvent);
       virtual void GetOutputHistoramsForMixedHarmonics(TList *mixedHarmonicsList);
+      virtual void EvaluateMixedHarmonicsPairwise(const AliFlowEventView &anEvent);
       // b) setters and getters:
       void SetMixedHarmonicsList(TList* const mhl) {this->fMixedHarmonicsList = mhl;}
       TList* GetMixedHarmonicsList() const {return this->fMixedHarmonicsList;}    
@@ -158,12 +211,22 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       Double_t GetMinMult() const {return this->fMinMult;};
       void SetMaxMult(Double_t const maxm) {this->fMaxMult = maxm;};
       Double_t GetMaxMult() const {return this->fMaxMult;};   
+      // The bins versus multiplicity, of width (fMaxMult-fMinMult)/fnBinsMult (setting it moves fMaxMult):
+      void SetMultBinWidth(Double_t const mbw) {this->fMaxMult = this->fMinMult+this->fnBinsMult*mbw;};
+      Double_t GetMultBinWidth() const {return (this->fnBinsMult > 0 ? (this->fMaxMult-this->fMinMult)/this->fnBinsMult : 0.);};  
       void SetPairCorrelatorVsPtSumDiff(TProfile* const spcVspsd, Int_t const cs, Int_t const sd) {this->fPairCorrelatorVsPtSumDiff[cs][sd] = spcVspsd;};
       TProfile* GetPairCorrelatorVsPtSumDiff(Int_t const cs, Int_t const sd) const {return this->fPairCorrelatorVsPtSumDiff[cs][sd];};
       void SetNinCorrelator(Int_t const n) {this->fNinCorrelator = n;};
       Int_t GetNinCorrelator() const {return this->fNinCorrelator;};     
       void SetMinCorrelator(Int_t const m) {this->fMinCorrelator = m;};
       Int_t GetMinCorrelator() const {return this->fMinCorrelator;};     
+      void SetPairwiseMixedHarmonics(Bool_t const pmh) {this->fPairwiseMixedHarmonics = pmh;};
+      Bool_t GetPairwiseMixedHarmonics() const {return this->fPairwiseMixedHarmonics;};
+      void SetMaxPairsPairwise(Int_t const mpp) {this->fMaxPairsPairwise = mpp;};
+      Int_t GetMaxPairsPairwise() const {return this->fMaxPairsPairwise;};
+      TH1D* GetMixedHarmonicsMode() const {return this->fMixedHarmonicsMode;};
+      void SetnBinsPtInQVectors(Int_t const nbpq) {this->fnBinsPtInQVectors = nbpq;};
+      Int_t GetnBinsPtInQVectors() const {return this->fnBinsPtInQVectors;};
       void SetXinPairAngle(Double_t const xipa) {this->fXinPairAngle = xipa;};
       Double_t GetXinPairAngle() const {return this->fXinPairAngle;};   
   
@@ -171,6 +234,36 @@ class AliFlowAnalysisWithMCEventPlane_mod {
  
       AliFlowAnalysisWithMCEventPlane_mod(const AliFlowAnalysisWithMCEventPlane_mod& aAnalysis);             //copy constructor
       AliFlowAnalysisWithMCEventPlane_mod& operator=(const AliFlowAnalysisWithMCEventPlane_mod& aAnalysis);  //assignment operator 
+      void      MakeFromView(const AliFlowEventView &anEvent);           //fills the flow profiles
+      const AliFlowEventView& SelectTracks(const AliFlowEventView &anEvent, AliFlowEventView &selected); //anEvent, or selected with the bits of SetSelectionBits()
+      void      FinishEvent(const AliFlowEventView &anEvent);            //fills what needs the whole event
+      void      StartEvent(Double_t aRP, Int_t nRPs, Int_t iRefMult, Long64_t iEventIndex, Bool_t bControl);   //resets the sums of one event
+      void      FillTrackControl(Double_t dPt, Double_t dEta, Double_t dPhi, UInt_t uiSelection);  //fills the control histograms of fCommonHists
+      //kernels specialized on the harmonic (kHarmonic = 0: any harmonic, read from fHarmonic) and on filling the control
+      //histograms, picked once by SelectKernels() so that the track loops carry no configuration tests:
+      typedef void (AliFlowAnalysisWithMCEventPlane_mod::*FillTracksFn)(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const UInt_t *selection);
+      void      SelectKernels();                                         //picks the kernels for fHarmonic
+      template<Int_t kHarmonic> Double_t HarmonicAngle(Double_t dAngle) const {return (kHarmonic == 0 ? fHarmonic*dAngle : (kHarmonic == 1 ? dAngle : kHarmonic*dAngle));}
+      template<Int_t kHarmonic> void FillTrackFlow(Double_t dPt, Double_t dEta, Double_t dPhi, UInt_t uiSelection);   //fills the flow profiles
+      template<Int_t kHarmonic, Bool_t kControl> void FillTracks(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const UInt_t *selection); //all tracks of one event
+      template<Int_t kHarmonic> class StreamSink;               //the streamed events, one track by FillTrackFlow<kHarmonic>()
+      void      FillTrackHarmonics(Double_t dPt, Double_t dEta, Double_t dPhi, UInt_t uiSelection);  //fills harmonics 1, ..., fNHarmonics
+      void      FillHarmonics(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const UInt_t *selection); //the same, all tracks of one event
+      void      StartEventSubsamples();                          //picks the subsample (or the replica weights) of the event
+      void      FillTrackSubsamples(Int_t iBinPt, Int_t iBinEta, Int_t rp, Double_t dPt, Double_t dEta, Double_t dv); //fills them with one track
+      void      AddToReplicaCell(Int_t iCell, Double_t dx, Double_t dv) //adds one track to the sums of the event in one bin of the replicas
+      {
+         Double_t *sums = &fEventReplicaSums[3*iCell];
+         if (sums[0] == 0.) fEventReplicaCells[fEventNReplicaCells++] = iCell;
+         sums[0] += 1.; sums[1] += dv; sums[2] += dx;
+      }
+      void      FinishEventSubsamples();                         //fills the replicas with the sums of the event, once per bin
+      void      MergeHistograms(TList *target, TList *source);  //adds the histograms of source to those of target (or their accumulators), entry by entry
+      void      ResetHistograms(TList *list);                 //empties the histograms of list, nested ones too, as booked (but the settings)
+      void      FinishHarmonic(Int_t iHarmonic, AliFlowCommonHistResults *results, TProfile *intFlow, TProfile *diffFlowPtRP, TProfile *diffFlowEtaRP,
+                               TProfile *diffFlowPtPOI, TProfile *diffFlowEtaPOI, Bool_t bSubsamples = kFALSE); //reference, integrated and differential flow of one harmonic
+      Double_t  SubsampleError(TProfile *const *subsamples, Int_t bin, const TH1F *yield = NULL) const; //spread of the subsamples in bin (or yield-weighted over all bins)
+      static Double_t TriangleCDF(Double_t t);                   //fraction of a triangle of half width 1 around 0 below t
 
       
       #ifndef __CINT__
@@ -178,7 +271,26 @@ class AliFlowAnalysisWithMCEventPlane_mod {
          Double_t     fQ2sum;             // flow vector sum squared
       #endif /*__CINT__*/
 
+      AliFlowTrackArena* fArena;       //! memory for the columns of events handed over as AliFlowEventSimple
+
+      // the event being analysed:
+      Double_t     fEventRP;           //! MC reaction plane angle
+      Int_t        fEventNRPs;         //! number of RPs
+      Int_t        fEventRefMult;      //! reference multiplicity
+      Long64_t     fEventIndex;        //! index of the event in its random stream, keys its subsamples (-1: not known)
+      Double_t     fEventQx;           //! Q vector of the RPs, x
+      Double_t     fEventQy;           //! Q vector of the RPs, y
+      Double_t     fEventFlowSum;      //! sum of cos(n(phi-RP)) over the RPs
+      Int_t        fEventFlowCount;    //! number of terms in fEventFlowSum
+      Int_t        fEventMultRP;       //! RPs filled into the control histograms
+      Int_t        fEventMultPOI;      //! POIs filled into the control histograms
+      Double_t     fEventQ2x;          //! Q vector of the RPs at harmonic 2 for the control histograms, x
+      Double_t     fEventQ2y;          //! Q vector of the RPs at harmonic 2 for the control histograms, y
+      Bool_t       fEventControl;      //! fill the control histograms too
+      Int_t        fEventBinM;         //! grid bin of the number of RPs in fHistProIntFlowVsM
+
       Int_t        fEventNumber;       // event counter
+      Long64_t     fEventCounter;      // key of the subsamples of the next event without an index
       Bool_t       fDebug ;            //! flag for lyz analysis: more print statements
 
       TList*       fHistList;          //list to hold all output histograms  
@@ -192,31 +304,78 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       TProfile2D*  fHistProDiffFlowPtEtaRP;  // profile used to calculate the differential flow (Pt,Eta) of RP particles
       TProfile*    fHistProDiffFlowPtRP;     // profile used to calculate the differential flow (Pt) of RP particles 
       TProfile*    fHistProDiffFlowEtaRP;    // profile used to calculate the differential flow (Eta) of RP particles 
-      TProfile*    fHistDiffFlowEtaRPSubPt1;
-      TProfile*    fHistDiffFlowEtaRPSubPt2;
-      TProfile*    fHistDiffFlowEtaRPSubPt3;
+      TProfile*    fHistDiffFlowEtaRPSubPt[fgMaxPtSlices];  // profiles used to calculate the differential flow (Eta) of RP particles per pt slice
       TProfile2D*  fHistProDiffFlowPtEtaPOI; // profile used to calculate the differential flow (Pt,Eta) of POI particles
       TProfile*    fHistProDiffFlowPtPOI;    // profile used to calculate the differential flow (Pt) of POI particles 
       TProfile*    fHistProDiffFlowEtaPOI;   // profile used to calculate the differential flow (Eta) of POI particles
-      TProfile*    fHistDiffFlowEtaPOISubPt1;
-      TProfile*    fHistDiffFlowEtaPOISubPt2;
-      TProfile*    fHistDiffFlowEtaPOISubPt3;
+      TProfile*    fHistDiffFlowEtaPOISubPt[fgMaxPtSlices]; // profiles used to calculate the differential flow (Eta) of POI particles per pt slice
       TH1D*        fHistSpreadOfFlow;        // histogram filled with reference flow calculated e-b-e    
       Int_t        fHarmonic;                // harmonic 
+      Int_t        fRPSelectionBit;          // bit of the selection word of the tracks analysed as RPs
+      Int_t        fPOISelectionBit;         // bit of the selection word of the tracks analysed as POIs
+      AliFlowEventSink* fSink;               //! StreamSink<> for fHarmonic
+      FillTracksFn fFillTracks[2];           //! FillTracks<> for fHarmonic, without [0] and with [1] the control histograms
+
+      // flat accumulators taking the fills of Make(), added to the profiles above by FlushAccumulators():
+      AliFlowProfileAccumulator* fIntFlowAcc;        //! fHistProIntFlow
+      AliFlowAutoRangeProfileAccumulator* fIntFlowVsMAcc; //! fHistProIntFlowVsM, only the multiplicities filled
+      AliFlowProfileAccumulator* fDiffFlowPtAcc;     //! fHistProDiffFlowPtRP, fHistProDiffFlowPtPOI
+      AliFlowProfileAccumulator* fDiffFlowEtaAcc;    //! fHistProDiffFlowEtaRP, fHistProDiffFlowEtaPOI
+      AliFlowProfileAccumulator* fDiffFlowEtaSubPtAcc; //! fHistDiffFlowEtaRPSubPt[s] (s), fHistDiffFlowEtaPOISubPt[s] (fNPtSlices+s)
+      AliFlowProfileAccumulator* fDiffFlowPtEtaAcc;  //! fHistProDiffFlowPtEtaRP, fHistProDiffFlowPtEtaPOI
+
+      // harmonics 1, ..., fNHarmonics:
+      Int_t fNHarmonics; // number of harmonics measured in one pass, 0 for none
+      TList *fHarmonicsList; // list to hold the lists "v1", ..., "vN" of the harmonics
+      AliFlowCommonHistResults *fHarmonicResults[fgMaxHarmonics]; // results per harmonic
+      TProfile *fHarmonicIntFlow[fgMaxHarmonics][2]; // <cos(n(phi-RP))> (0) and <sin(n(phi-RP))> (1) of the RPs
+      TProfile *fHarmonicDiffFlowPt[fgMaxHarmonics][2][2]; // the same versus pt, [n-1][RP = 0, POI = 1][cos = 0, sin = 1]
+      TProfile *fHarmonicDiffFlowEta[fgMaxHarmonics][2][2]; // the same versus eta
+      TProfile2D *fHarmonicDiffFlowPtEta[fgMaxHarmonics][2][2]; // the same versus (pt,eta)
+      AliFlowProfileAccumulator *fHarmonicsIntAcc; //! fHarmonicIntFlow, profile 2*(n-1)+cs
+      AliFlowProfileAccumulator *fHarmonicsPtAcc; //! fHarmonicDiffFlowPt, profile 4*(n-1)+2*rp+cs
+      AliFlowProfileAccumulator *fHarmonicsEtaAcc; //! fHarmonicDiffFlowEta, the same
+      AliFlowProfileAccumulator *fHarmonicsPtEtaAcc; //! fHarmonicDiffFlowPtEta, the same
+
+      // subsamples (or bootstrap replicas) of the events, for the errors of fHarmonic:
+      Int_t fNSubsamples; // number of subsamples or replicas, 0 for none
+      Bool_t fBootstrap; // replicas with Poisson(1) weights per event instead of one subsample per event
+      TList *fSubsamplesList; // list to hold the settings and profiles of the subsamples (NULL without subsamples)
+      TProfile *fSubsamplesSettings; // profile holding fNSubsamples and fBootstrap
+      TProfile *fSubsampleIntFlow[fgMaxSubsamples]; // fHistProIntFlow of each subsample
+      TProfile *fSubsampleDiffFlowPt[2][fgMaxSubsamples]; // fHistProDiffFlowPtRP (0) and fHistProDiffFlowPtPOI (1) of each subsample
+      TProfile *fSubsampleDiffFlowEta[2][fgMaxSubsamples]; // fHistProDiffFlowEtaRP (0) and fHistProDiffFlowEtaPOI (1) of each subsample
+      AliFlowProfileAccumulator *fSubsamplesIntAcc; //! fSubsampleIntFlow, profile k
+      AliFlowProfileAccumulator *fSubsamplesPtAcc; //! fSubsampleDiffFlowPt, profile 2*k+rp
+      AliFlowProfileAccumulator *fSubsamplesEtaAcc; //! fSubsampleDiffFlowEta, the same
+      Int_t fEventNSubsamples; //! subsamples or replicas the event being analysed goes to
+      Int_t fEventSubsamples[fgMaxSubsamples]; //! which ones
+      Double_t fEventSubsampleWeights[fgMaxSubsamples]; //! with which weights
+      Double_t *fEventReplicaSums; //! bootstrap: tracks, sum of the flow and of x of the event per bin, the integrated one, then pt of RPs and POIs, then eta of them
+      Int_t *fEventReplicaCells; //! bootstrap: the bins of fEventReplicaSums the event filled
+      Int_t fEventNReplicaCells; //! how many
 
       // mixed harmonics:
       TList *fMixedHarmonicsList; // list to hold all objects relevant for mixed harmonics 
       Bool_t fEvaluateMixedHarmonics; // evaluate and store objects relevant for mixed harmonics
       TProfile *fMixedHarmonicsSettings; // profile used to hold all flags relevant for the mixed harmonics
-      TProfile *fPairCorrelator[2]; // profiles used to calculate <cos[m*phi_{pair}-n*RP]> and <sin[m*phi_{pair}-n*RP]> (0 = cos, 1 = sin), where phi_{pair} = x*phi1+(1-x)*phi2
-      TProfile *fPairCorrelatorVsM[2]; // <cos[m*phi_{pair}-n*RP]> and <sin[m*phi_{pair}-n*RP]> versus multiplicity (0 = cos, 1 = sin), where phi_{pair} = x*phi1+(1-x)*phi2
-      Int_t fnBinsMult; // number of multiplicity bins for mixed harmonics analysis versus multiplicity  
-      Double_t fMinMult; // minimal multiplicity for mixed harmonics analysis versus multiplicity  
-      Double_t fMaxMult; // maximal multiplicity for mixed harmonics analysis versus multiplicity    
-      TProfile *fPairCorrelatorVsPtSumDiff[2][2]; // <cos/sin[m*phi_{pair}-n*RP]> vs (1/2)(pt1+pt2) (0) and |pt1-pt2| (1), where phi_{pair} = x*phi1+(1-x)*phi2
+      TProfile *fPairCorrelator[2]; // profiles used to calculate <cos[m*phi_{pair}-n*RP]> and <sin[m*phi_{pair}-n*RP]> (0 = cos, 1 = sin), where phi_{pair} = x*phi1+(1-x)*phi2; one entry per pair in the events evaluated pair by pair, one per event (its average over the pairs, weighted by their number) in the others
+      TProfile *fPairCorrelatorVsM[2]; // <cos[m*phi_{pair}-n*RP]> and <sin[m*phi_{pair}-n*RP]> versus multiplicity (0 = cos, 1 = sin), where phi_{pair} = x*phi1+(1-x)*phi2; entries as in fPairCorrelator
+      AliFlowAutoRangeProfileAccumulator *fPairCorrelatorVsMAcc; //! fPairCorrelatorVsM[cs] (cs), only the multiplicities filled
+      Int_t fnBinsMult; // number of multiplicity bins for mixed harmonics analysis versus multiplicity, in [fMinMult,fMaxMult)
+      Double_t fMinMult; // minimal multiplicity for mixed harmonics analysis versus multiplicity (the profiles hold the bins filled, also outside)
+      Double_t fMaxMult; // maximal multiplicity for mixed harmonics analysis versus multiplicity
+      TProfile *fPairCorrelatorVsPtSumDiff[2][2]; // <cos/sin[m*phi_{pair}-n*RP]> vs (1/2)(pt1+pt2) (0) and |pt1-pt2| (1), where phi_{pair} = x*phi1+(1-x)*phi2; one entry per pair in the events evaluated pair by pair, one per event and pair of pt bins (weighted by its number of pairs) in the others
       Int_t fNinCorrelator; // n in <cos[m*phi_{pair}-n*RP]> and <sin[m*phi_{pair}-n*RP]>, where phi_{pair} = x*phi1+(1-x)*phi2
       Int_t fMinCorrelator; // m in <cos[m*phi_{pair}-n*RP]> and <sin[m*phi_{pair}-n*RP]>, where phi_{pair} = x*phi1+(1-x)*phi2   
       Double_t fXinPairAngle; // x in definition phi_{pair} = x*phi1+(1-x)*phi2
+      Bool_t fPairwiseMixedHarmonics; // loop over all pairs (exact, for validation) instead of using the Q-vectors
+      Int_t fMaxPairsPairwise; // also loop over the pairs in events with at most this many RPs x POIs (0: never)
+      TH1D *fMixedHarmonicsMode; // events evaluated pair by pair (exact, bin 1) and from the Q-vectors (approximate versus pt sum and difference, bin 2)
+      Int_t fnBinsPtInQVectors; // pt bins of the Q-vectors for the correlators vs pt sum and difference, over the range of those (0: four per bin of them)
+      Double_t *fMixedHarmonicsPtQ; //! Q-vectors of one event per pt bin: [bin][RP re, im, count, POI re, im, count, RP and POI re, im, count]
+      Int_t *fMixedHarmonicsPtOccupied; //! pt bins of the Q-vectors holding RPs ([0,fnBinsPtInQVectors)) and POIs (the next fnBinsPtInQVectors)
+      Double_t *fMixedHarmonicsPairSums; //! sums over the pairs of one event per pt sum (2*fnBinsPtInQVectors-1) and difference (fnBinsPtInQVectors): [cos, sin, pairs]
 
       // rapidity plotting range and resolution:
       Int_t fNbinsEta;
@@ -227,6 +386,11 @@ class AliFlowAnalysisWithMCEventPlane_mod {
       Int_t fNbinsPt;
       Double_t fPtMin;
       Double_t fPtMax;
+
+      // pt slices of v(eta):
+      Int_t fNPtSlices; // number of pt slices, 0 for none
+      Double_t fPtSliceCutOffs[fgMaxPtSlices]; // the fNPtSlices-1 pt values between the slices
+      AliFlowAxisBinner* fPtSliceBinner; //! pt slice of a track: its bin on the axis of the cut-offs, under- and overflow included
                                           
       ClassDef(AliFlowAnalysisWithMCEventPlane_mod,0)  // Analyse particle distribution versus MC reaction plane
   
@@ -0,0 +1,292 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Deterministic mode: merges the   *
+ * analyses of blocks of events in  *
+ * a tree fixed by their number.    *
+ ************************************/
+
+#include <cstdio>
+
+#include "Riostream.h"
+#include "TMath.h"
+#include "TList.h"
+#include "TH1.h"
+#include "AliFlowCommonHist.h"
+#include "AliFlowAnalysisWithMCEventPlane_mod.h"
+#include "AliFlowBlockMerger.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowBlockMerger)
+
+//====================================================================================================================
+
+AliFlowBlockMerger::AliFlowBlockMerger(Long64_t nBlocks, AnalysisFactory af):
+   fNBlocks(TMath::Max(nBlocks,(Long64_t)1)),
+   fAnalysisFactory(af),
+   fAnalyses(TMath::Max(nBlocks,(Long64_t)1),(AliFlowAnalysisWithMCEventPlane_mod*)NULL),
+   fLevels(TMath::Max(nBlocks,(Long64_t)1),-1),
+   fRoot(NULL)
+{
+   // Constructor.
+
+} // end of AliFlowBlockMerger::AliFlowBlockMerger(Long64_t nBlocks, AnalysisFactory af)
+
+//====================================================================================================================
+
+AliFlowBlockMerger::~AliFlowBlockMerger()
+{
+   // Destructor.
+
+   for(UInt_t b=0;b<fAnalyses.size();b++){if(fAnalyses[b]){DeleteNode(fAnalyses[b]);}}
+   if(fRoot){DeleteNode(fRoot);}
+   for(UInt_t s=0;s<fSpares.size();s++){DeleteNode(fSpares[s]);}
+
+} // end of AliFlowBlockMerger::~AliFlowBlockMerger()
+
+//====================================================================================================================
+
+AliFlowAnalysisWithMCEventPlane_mod* AliFlowBlockMerger::NewBlockAnalysis()
+{
+   // An analysis for the next block: the last node merged away, already reset, or a new one of the factory.
+
+   if(fSpares.empty()){return (fAnalysisFactory ? fAnalysisFactory() : NULL);}
+   AliFlowAnalysisWithMCEventPlane_mod *analysis = fSpares.back();
+   fSpares.pop_back();
+   return analysis;
+
+} // end of AliFlowAnalysisWithMCEventPlane_mod* AliFlowBlockMerger::NewBlockAnalysis()
+
+//====================================================================================================================
+
+Bool_t AliFlowBlockMerger::Add(Long64_t iIndex, Int_t iLevel, AliFlowAnalysisWithMCEventPlane_mod *analysis)
+{
+   // Take the node (iLevel,iIndex), owned by the merger from now on, and merge it with its sibling, and the parent with its sibling, and so on, for as
+   // long as the sibling is held; the first node whose sibling is not is held until the sibling comes.
+
+   Long64_t width = ((Long64_t)1<<iLevel);
+   if(!analysis || iIndex < 0 || iIndex >= fNBlocks || iIndex%width != 0 || fRoot)
+   {
+      cout<<"WARNING: AliFlowBlockMerger::Add(): no node "<<iIndex<<" at level "<<iLevel<<" in the tree of "<<fNBlocks<<" blocks, not merged."<<endl;
+      if(analysis){DeleteNode(analysis);}
+      return kFALSE;
+   }
+   if(this->Overlaps(iIndex,iLevel))
+   {
+      cout<<"WARNING: AliFlowBlockMerger::Add(): blocks of node "<<iIndex<<" at level "<<iLevel<<" came before, the node is left out."<<endl;
+      DeleteNode(analysis);
+      return kFALSE;
+   }
+   Long64_t i = iIndex;
+   for(Int_t level=iLevel;((Long64_t)1<<level)<fNBlocks;level++)
+   {
+      width = (Long64_t)1<<level;
+      Bool_t bLeft = ((i/width)%2 == 0);
+      Long64_t iSibling = (bLeft ? i+width : i-width);
+      if(iSibling >= fNBlocks){continue;} // no right sibling: the node goes up as it is
+      if(fLevels[iSibling] != level)
+      {
+         fAnalyses[i] = analysis;
+         fLevels[i] = level;
+         return kTRUE;
+      }
+      AliFlowAnalysisWithMCEventPlane_mod *pSibling = fAnalyses[iSibling];
+      fAnalyses[iSibling] = NULL;
+      fLevels[iSibling] = -1;
+      AliFlowAnalysisWithMCEventPlane_mod *pLeft = (bLeft ? analysis : pSibling);
+      AliFlowAnalysisWithMCEventPlane_mod *pRight = (bLeft ? pSibling : analysis);
+      MergeNodes(pLeft,pRight);
+      pRight->ResetHistograms(); // as new, for the next block
+      fSpares.push_back(pRight);
+      analysis = pLeft;
+      i = TMath::Min(i,iSibling);
+   }
+   fRoot = analysis; // all blocks are merged
+   return kTRUE;
+
+} // end of Bool_t AliFlowBlockMerger::Add(Long64_t iIndex, Int_t iLevel, AliFlowAnalysisWithMCEventPlane_mod *analysis)
+
+//====================================================================================================================
+
+Bool_t AliFlowBlockMerger::Overlaps(Long64_t iIndex, Int_t iLevel) const
+{
+   // Whether a node held shares blocks with the node (iLevel,iIndex): one of its ancestors (the node itself included),
+   // which holds the index of its first block, or one of its descendants.
+
+   for(Int_t level=0;level<64 && ((Long64_t)1<<level)<2*fNBlocks;level++)
+   {
+      Long64_t j = (iIndex>>level)<<level;
+      if(fAnalyses[j] && fLevels[j] >= level){return kTRUE;}
+   }
+   for(Long64_t j=iIndex+1;j<TMath::Min(iIndex+((Long64_t)1<<iLevel),fNBlocks);j++)
+   {
+      if(fAnalyses[j]){return kTRUE;}
+   }
+   return kFALSE;
+
+} // end of Bool_t AliFlowBlockMerger::Overlaps(Long64_t iIndex, Int_t iLevel) const
+
+//====================================================================================================================
+
+Bool_t AliFlowBlockMerger::Add(Long64_t iIndex, Int_t iLevel, TList *outputList)
+{
+   // Copy the node sent as its output list into a new analysis and take it. The copy is exact (all sums start from
+   // zero, the settings filled by Init() too, as they come with the list), so the node merges as the analysis that
+   // sent it would.
+
+   if(!outputList){return kFALSE;}
+   AliFlowAnalysisWithMCEventPlane_mod *analysis = this->NewBlockAnalysis();
+   if(!analysis){return kFALSE;}
+   ResetHistograms(analysis->GetHistList());
+   if(!analysis->MergeOutput(outputList))
+   {
+      DeleteNode(analysis);
+      return kFALSE;
+   }
+   analysis->FlushAccumulators();
+   return this->Add(iIndex,iLevel,analysis);
+
+} // end of Bool_t AliFlowBlockMerger::Add(Long64_t iIndex, Int_t iLevel, TList *outputList)
+
+//====================================================================================================================
+
+void AliFlowBlockMerger::ExportNodes(TList *list)
+{
+   // Add the output lists of all nodes held, named by NodeName(), to list, and delete their analyses (not the lists).
+
+   for(Long64_t i=0;i<fNBlocks;i++)
+   {
+      if(!fAnalyses[i]){continue;}
+      TList *outputList = fAnalyses[i]->GetHistList();
+      outputList->SetName(NodeName(i,fLevels[i]).Data());
+      list->Add(outputList);
+      delete fAnalyses[i];
+      fAnalyses[i] = NULL;
+      fLevels[i] = -1;
+   }
+   if(fRoot)
+   {
+      TList *outputList = fRoot->GetHistList();
+      Int_t iLevel = 0;
+      while(((Long64_t)1<<iLevel) < fNBlocks){iLevel++;}
+      outputList->SetName(NodeName(0,iLevel).Data());
+      list->Add(outputList);
+      delete fRoot;
+      fRoot = NULL;
+   }
+
+} // end of void AliFlowBlockMerger::ExportNodes(TList *list)
+
+//====================================================================================================================
+
+AliFlowAnalysisWithMCEventPlane_mod* AliFlowBlockMerger::GetRoot() const
+{
+   // The analysis of all blocks; while some are missing, NULL, with the missing blocks reported.
+
+   if(fRoot){return fRoot;}
+   Long64_t nMissing = 0;
+   Long64_t iFirstMissing = -1;
+   for(Long64_t i=0;i<fNBlocks;)
+   {
+      if(!fAnalyses[i])
+      {
+         if(iFirstMissing < 0){iFirstMissing = i;}
+         nMissing++;
+         i++;
+         continue;
+      }
+      i += ((Long64_t)1<<fLevels[i]);
+   }
+   cout<<"ERROR: AliFlowBlockMerger: "<<nMissing<<" of "<<fNBlocks<<" blocks missing, the first is block "<<iFirstMissing<<"."<<endl;
+   return NULL;
+
+} // end of AliFlowAnalysisWithMCEventPlane_mod* AliFlowBlockMerger::GetRoot() const
+
+//====================================================================================================================
+
+void AliFlowBlockMerger::MergeNodes(AliFlowAnalysisWithMCEventPlane_mod *left, AliFlowAnalysisWithMCEventPlane_mod *right)
+{
+   // Merge right into left and flush: the nodes are kept flushed, so no sums are pending in a merge and every node
+   // holds the same histograms whichever backend merged it.
+
+   left->Merge(*right);
+   left->FlushAccumulators();
+
+} // end of void AliFlowBlockMerger::MergeNodes(AliFlowAnalysisWithMCEventPlane_mod *left, AliFlowAnalysisWithMCEventPlane_mod *right)
+
+//====================================================================================================================
+
+void AliFlowBlockMerger::DeleteNode(AliFlowAnalysisWithMCEventPlane_mod *analysis)
+{
+   // Delete analysis and its output list (which the analysis does not own).
+
+   TList *outputList = analysis->GetHistList();
+   if(outputList)
+   {
+      outputList->SetOwner(kTRUE);
+      delete outputList;
+   }
+   delete analysis;
+
+} // end of void AliFlowBlockMerger::DeleteNode(AliFlowAnalysisWithMCEventPlane_mod *analysis)
+
+//====================================================================================================================
+
+void AliFlowBlockMerger::ResetHistograms(TList *list)
+{
+   // Reset all histograms in list, descending into nested lists and the common histograms.
+
+   for(Int_t k=0;k<list->GetEntries();k++)
+   {
+      TObject *object = list->At(k);
+      if(object->InheritsFrom(TList::Class())){ResetHistograms(static_cast<TList*>(object));}
+      else if(object->InheritsFrom(AliFlowCommonHist::Class())){ResetHistograms(static_cast<AliFlowCommonHist*>(object)->GetHistList());}
+      else if(object->InheritsFrom(TH1::Class())){static_cast<TH1*>(object)->Reset();}
+   }
+
+} // end of void AliFlowBlockMerger::ResetHistograms(TList *list)
+
+//====================================================================================================================
+
+TString AliFlowBlockMerger::NodeName(Long64_t iIndex, Int_t iLevel)
+{
+   // Name of the output list of node (iLevel,iIndex).
+
+   return TString::Format("cobjMCEP_node%lld_level%d",iIndex,iLevel);
+
+} // end of TString AliFlowBlockMerger::NodeName(Long64_t iIndex, Int_t iLevel)
+
+//====================================================================================================================
+
+Bool_t AliFlowBlockMerger::ParseNodeName(const char *name, Long64_t &iIndex, Int_t &iLevel)
+{
+   // Inverse of NodeName().
+
+   return (sscanf(name,"cobjMCEP_node%lld_level%d",&iIndex,&iLevel) == 2);
+
+} // end of Bool_t AliFlowBlockMerger::ParseNodeName(const char *name, Long64_t &iIndex, Int_t &iLevel)
+
+//====================================================================================================================
+
+Long64_t AliFlowBlockMerger::GetNumberOfBlocks(Long64_t nEvents, Int_t nEventsPerBlock)
+{
+   // Blocks of nEventsPerBlock events in nEvents events, the last one partial if need be.
+
+   if(nEventsPerBlock <= 0){return 0;}
+   return (nEvents+nEventsPerBlock-1)/nEventsPerBlock;
+
+} // end of Long64_t AliFlowBlockMerger::GetNumberOfBlocks(Long64_t nEvents, Int_t nEventsPerBlock)
@@ -0,0 +1,73 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Deterministic mode: merges the   *
+ * analyses of blocks of events in  *
+ * a tree fixed by their number.    *
+ ************************************/
+
+#ifndef ALIFLOWBLOCKMERGER_H
+#define ALIFLOWBLOCKMERGER_H
+
+#include <vector>
+#include <functional>
+
+#include "Rtypes.h"
+#include "TString.h"
+
+class TList;
+
+class AliFlowAnalysisWithMCEventPlane_mod;
+
+// The blocks [0,nBlocks) are the leaves of a binary tree: the node of level L at index i (a multiple of 2^L) holds
+// the blocks [i,i+2^L) and is merged from its children (L-1,i) and (L-1,i+2^(L-1)), always the right one into the left
+// one; a left child without a right sibling goes up as it is. Every merge is MergeNodes(), so the result depends on
+// the blocks alone, not on which thread or PROOF worker analysed or merged them. Serial; AliFlowOnTheFlyRunner walks
+// the same tree on its threads. The right node of a merge is reset and handed out again by NewBlockAnalysis(), so
+// that only as many analyses are booked as nodes wait for their siblings at a time, not one per block.
+class AliFlowBlockMerger{
+   public:
+      typedef std::function<AliFlowAnalysisWithMCEventPlane_mod*()> AnalysisFactory; // configured and initialized analysis
+
+      AliFlowBlockMerger(Long64_t nBlocks, AnalysisFactory af); // constructor
+      virtual ~AliFlowBlockMerger(); // destructor, deletes the nodes still held
+      // An analysis for the next block, as the factory would create it: a node merged away before, reset, or else a
+      // new one of the factory; owned by the caller until it is added:
+      AliFlowAnalysisWithMCEventPlane_mod* NewBlockAnalysis();
+      // Take the node (iLevel,iIndex), flushed, and merge it up for as long as its sibling is held:
+      Bool_t Add(Long64_t iIndex, Int_t iLevel, AliFlowAnalysisWithMCEventPlane_mod *analysis);
+      // Same, for a node sent as its output list (copied into a new analysis of the factory; the list is left as it is):
+      Bool_t Add(Long64_t iIndex, Int_t iLevel, TList *outputList);
+      // Add the output lists of all nodes held to list, named by NodeName(), and let go of them (PROOF workers):
+      void ExportNodes(TList *list);
+      // The analysis of all blocks, NULL (with the missing blocks reported) while some are missing; owned by the merger:
+      AliFlowAnalysisWithMCEventPlane_mod* GetRoot() const;
+      Long64_t GetNumberOfBlocks() const {return this->fNBlocks;}
+      // Merge the node right into its sibling left, both flushed, and flush (the step of every backend):
+      static void MergeNodes(AliFlowAnalysisWithMCEventPlane_mod *left, AliFlowAnalysisWithMCEventPlane_mod *right);
+      // Delete analysis with its output list:
+      static void DeleteNode(AliFlowAnalysisWithMCEventPlane_mod *analysis);
+      static TString NodeName(Long64_t iIndex, Int_t iLevel); // "cobjMCEP_node<iIndex>_level<iLevel>"
+      static Bool_t ParseNodeName(const char *name, Long64_t &iIndex, Int_t &iLevel); // kFALSE if name is not a node
+      static Long64_t GetNumberOfBlocks(Long64_t nEvents, Int_t nEventsPerBlock); // the last block may be partial
+
+   private:
+      AliFlowBlockMerger(const AliFlowBlockMerger& aMerger); // copy constructor
+      AliFlowBlockMerger& operator=(const AliFlowBlockMerger& aMerger); // assignment operator
+      Bool_t Overlaps(Long64_t iIndex, Int_t iLevel) const; // whether a node held shares blocks with node (iLevel,iIndex)
+      static void ResetHistograms(TList *list); // all histograms of list, nested ones too
+      Long64_t fNBlocks; // number of blocks
+      AnalysisFactory fAnalysisFactory; // creates the analyses of the nodes received as lists
+      std::vector<AliFlowAnalysisWithMCEventPlane_mod*> fAnalyses; // analysis of the node held at the index of its first block
+      std::vector<Int_t> fLevels; // level of the node held at that index, -1 if none
+      std::vector<AliFlowAnalysisWithMCEventPlane_mod*> fSpares; // nodes merged away, reset for NewBlockAnalysis()
+      AliFlowAnalysisWithMCEventPlane_mod *fRoot; // all blocks merged (NULL until then)
+
+   ClassDef(AliFlowBlockMerger,0) // merges the analyses of blocks of events in a fixed tree
+};
+
+#endif
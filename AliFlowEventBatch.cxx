@@ -0,0 +1,133 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Reusable buffer holding the      *
+ * tracks of many events created    *
+ * 'on the fly', column by column.  *
+ ************************************/
+
+#include "AliFlowEventSimple.h"
+#include "AliFlowTrackSimple.h"
+#include "AliFlowEventBatch.h"
+
+ClassImp(AliFlowEventBatch)
+
+//====================================================================================================================
+
+AliFlowEventBatch::AliFlowEventBatch()
+{
+   // Constructor.
+
+   fOffset.push_back(0);
+
+} // end of AliFlowEventBatch::AliFlowEventBatch()
+
+//====================================================================================================================
+
+void AliFlowEventBatch::Clear()
+{
+   // Forget all events; the capacity of all columns is kept, so refilling does not allocate.
+
+   fEventIndex.clear();
+   fOffset.clear();
+   fOffset.push_back(0);
+   fMultiplicity.clear();
+   fReactionPlane.clear();
+   fReactionPlaneWithError.clear();
+   fNumberOfRPs.clear();
+   fNumberOfPOIs.clear();
+   fPt.clear();
+   fEta.clear();
+   fPhi.clear();
+   fCharge.clear();
+   fSelection.clear();
+
+} // end of void AliFlowEventBatch::Clear()
+
+//====================================================================================================================
+
+void AliFlowEventBatch::Reserve(Int_t nEvents, Int_t nTracks)
+{
+   // Allocate room for nEvents events with nTracks tracks in total.
+
+   fEventIndex.reserve(nEvents);
+   fOffset.reserve(nEvents+1);
+   fMultiplicity.reserve(nEvents);
+   fReactionPlane.reserve(nEvents);
+   fReactionPlaneWithError.reserve(nEvents);
+   fNumberOfRPs.reserve(nEvents);
+   fNumberOfPOIs.reserve(nEvents);
+   fPt.reserve(nTracks);
+   fEta.reserve(nTracks);
+   fPhi.reserve(nTracks);
+   fCharge.reserve(nTracks);
+   fSelection.reserve(nTracks);
+
+} // end of void AliFlowEventBatch::Reserve(Int_t nEvents, Int_t nTracks)
+
+//====================================================================================================================
+
+void AliFlowEventBatch::BeginEvent(Long64_t iEvent, Int_t iMult, Double_t dReactionPlane)
+{
+   // Open a new event; its tracks follow via AddTrack().
+
+   fEventIndex.push_back(iEvent);
+   fMultiplicity.push_back(iMult);
+   fReactionPlane.push_back(dReactionPlane);
+
+} // end of void AliFlowEventBatch::BeginEvent(Long64_t iEvent, Int_t iMult, Double_t dReactionPlane)
+
+//====================================================================================================================
+
+void AliFlowEventBatch::EndEvent(Double_t dReactionPlaneWithError, Int_t nRPs, Int_t nPOIs)
+{
+   // Close the event opened by the last BeginEvent().
+
+   fOffset.push_back((Int_t)fPt.size());
+   fReactionPlaneWithError.push_back(dReactionPlaneWithError);
+   fNumberOfRPs.push_back(nRPs);
+   fNumberOfPOIs.push_back(nPOIs);
+
+} // end of void AliFlowEventBatch::EndEvent(Double_t dReactionPlaneWithError, Int_t nRPs, Int_t nPOIs)
+
+//====================================================================================================================
+
+AliFlowEventSimple* AliFlowEventBatch::CreateFlowEventSimple(Int_t i) const
+{
+   // Copy event i into a new AliFlowEventSimple (owned by the caller).
+
+   AliFlowEventSimple *pEvent = new AliFlowEventSimple(fMultiplicity[i]);
+   pEvent->SetReferenceMultiplicity(fMultiplicity[i]);
+   pEvent->SetMCReactionPlaneAngle(fReactionPlaneWithError[i]);
+   for(Int_t t=fOffset[i];t<fOffset[i+1];t++)
+   {
+      AliFlowTrackSimple *pTrack = new AliFlowTrackSimple();
+      pTrack->SetPt(fPt[t]);
+      pTrack->SetEta(fEta[t]);
+      pTrack->SetPhi(fPhi[t]);
+      pTrack->SetCharge(fCharge[t]);
+      if(fSelection[t] & kRP){pTrack->TagRP(kTRUE);}
+      if(fSelection[t] & kPOI){pTrack->TagPOI(kTRUE);}
+      pEvent->AddTrack(pTrack);
+   }
+   pEvent->SetNumberOfRPs(fNumberOfRPs[i]);
+   pEvent->SetNumberOfPOIs(fNumberOfPOIs[i]);
+
+   return pEvent;
+
+} // end of AliFlowEventSimple* AliFlowEventBatch::CreateFlowEventSimple(Int_t i) const
+
+//====================================================================================================================
@@ -0,0 +1,86 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Reusable buffer holding the      *
+ * tracks of many events created    *
+ * 'on the fly', column by column.  *
+ ************************************/
+
+#ifndef ALIFLOWEVENTBATCH_H
+#define ALIFLOWEVENTBATCH_H
+
+#include <vector>
+
+#include "Rtypes.h"
+
+class AliFlowEventSimple;
+
+class AliFlowEventBatch{
+   public:
+      enum ESelection {kRP = 1, kPOI = 2}; // bits of the track selection word
+
+      AliFlowEventBatch(); // constructor
+      virtual ~AliFlowEventBatch() {} // destructor
+      void Clear(); // forget all events but keep the allocated memory
+      void Reserve(Int_t nEvents, Int_t nTracks);
+
+      // Filling:
+      void BeginEvent(Long64_t iEvent, Int_t iMult, Double_t dReactionPlane);
+      void AddTrack(Double_t dPt, Double_t dEta, Double_t dPhi, Int_t iCharge, UInt_t uiSelection)
+      {
+         fPt.push_back(dPt);
+         fEta.push_back(dEta);
+         fPhi.push_back(dPhi);
+         fCharge.push_back(iCharge);
+         fSelection.push_back(uiSelection);
+      }
+      void EndEvent(Double_t dReactionPlaneWithError, Int_t nRPs, Int_t nPOIs);
+
+      // Events:
+      Int_t GetNumberOfEvents() const {return (Int_t)fEventIndex.size();}
+      Long64_t GetEventIndex(Int_t i) const {return this->fEventIndex[i];}
+      Int_t GetOffset(Int_t i) const {return this->fOffset[i];} // first track of event i
+      Int_t GetNumberOfTracks(Int_t i) const {return this->fOffset[i+1]-this->fOffset[i];}
+      Int_t GetReferenceMultiplicity(Int_t i) const {return this->fMultiplicity[i];}
+      Double_t GetReactionPlane(Int_t i) const {return this->fReactionPlane[i];} // true reaction plane
+      Double_t GetMCReactionPlaneAngle(Int_t i) const {return this->fReactionPlaneWithError[i];} // with limited resolution
+      Int_t GetNumberOfRPs(Int_t i) const {return this->fNumberOfRPs[i];}
+      Int_t GetNumberOfPOIs(Int_t i) const {return this->fNumberOfPOIs[i];}
+
+      // Tracks of all events, contiguous:
+      Int_t GetNumberOfTracks() const {return (Int_t)fPt.size();}
+      const Double_t* GetPt() const {return fPt.empty() ? NULL : &fPt[0];}
+      const Double_t* GetEta() const {return fEta.empty() ? NULL : &fEta[0];}
+      const Double_t* GetPhi() const {return fPhi.empty() ? NULL : &fPhi[0];}
+      const Int_t* GetCharge() const {return fCharge.empty() ? NULL : &fCharge[0];}
+      const UInt_t* GetSelection() const {return fSelection.empty() ? NULL : &fSelection[0];}
+
+      // Compatibility with the analysis of AliFlowEventSimple:
+      AliFlowEventSimple* CreateFlowEventSimple(Int_t i) const;
+
+   private:
+      AliFlowEventBatch(const AliFlowEventBatch& aBatch); // copy constructor
+      AliFlowEventBatch& operator=(const AliFlowEventBatch& aBatch); // assignment operator
+      // per event:
+      std::vector<Long64_t> fEventIndex; // index of the event in its random stream
+      std::vector<Int_t> fOffset; // [nEvents+1] first track of each event
+      std::vector<Int_t> fMultiplicity; // reference multiplicity (before efficiency losses)
+      std::vector<Double_t> fReactionPlane; // true reaction plane
+      std::vector<Double_t> fReactionPlaneWithError; // reaction plane with limited angular resolution
+      std::vector<Int_t> fNumberOfRPs; // number of RP tagged tracks
+      std::vector<Int_t> fNumberOfPOIs; // number of POI tagged tracks
+      // per track:
+      std::vector<Double_t> fPt; // transverse momentum
+      std::vector<Double_t> fEta; // pseudorapidity
+      std::vector<Double_t> fPhi; // azimuthal angle
+      std::vector<Int_t> fCharge; // charge
+      std::vector<UInt_t> fSelection; // kRP | kPOI, higher bits from AliFlowEventSimpleMakerOnTheFly_mod::AddSelection()
+
+   ClassDef(AliFlowEventBatch,0) // batch of events created 'on the fly'
+};
+
+#endif
@@ -25,8 +25,16 @@
 #include "TMath.h"
 #include "TF1.h"
 #include "TH3.h"
-#include "TRandom3.h"
+#include "AliFlowSIMD.h"
+#include "AliFlowPhiloxRandom.h"
 #include "AliFlowEventSimpleMakerOnTheFly_mod.h"
+#include "AliFlowOnTheFlySamplers.h"
+#include "AliFlowOnTheFlyTables.h"
+#include "AliFlowOnTheFlyTelemetry.h"
+#include "AliFlowTrackCutSets.h"
+#include "AliFlowEventBatch.h"
+#include "AliFlowEventView.h"
+#include "AliFlowEventSink.h"
 #include "AliFlowEventSimple.h"
 #include "AliFlowTrackSimple.h"
 #include "AliFlowTrackSimpleCuts.h"
@@ -37,8 +45,9 @@ ClassImp(AliFlowEventSimpleMakerOnTheFly_mod)
 
 //========================================================================================================================================
 
-AliFlowEventSimpleMakerOnTheFly_mod::AliFlowEventSimpleMakerOnTheFly_mod(UInt_t uiSeed):
-   fCount(0),
+AliFlowEventSimpleMakerOnTheFly_mod::AliFlowEventSimpleMakerOnTheFly_mod(UInt_t uiSeed, UInt_t uiStream):
+   fEventIndex(0),
+   fRandom(NULL),
    fCClass(0),
    fMinMult(0),
    fMaxMult(0),  
@@ -52,15 +61,39 @@ AliFlowEventSimpleMakerOnTheFly_mod::AliFlowEventSimpleMakerOnTheFly_mod(UInt_t
    fPtMin(0),
    fPtMax(10.),
    fPi(TMath::Pi()),
-   fUniformEfficiency(kTRUE)
+   fUniformEfficiency(kTRUE),
+   fUseTF1Sampling(kFALSE),
+   fPtSampler(NULL),
+   fPhiSampler(NULL),
+   fEtaSampler(NULL),
+   fFoldEfficiency(kFALSE),
+   fPtSamplerFolded(NULL),
+   fMeanEfficiency(1.),
+   fEtaCoefficient(0.),
+   fNEfficiencyBins(13),
+   fEfficiencyBins(&fgEfficiencyBins[0][0][0]),
+   fTablesFile(""),
+   fTables(NULL),
+   fSharedTables(NULL),
+   fTelemetryFile(""),
+   fTelemetry(NULL),
+   fBatch(NULL),
+   fTrack(NULL),
+   fCutSets(NULL),
+   fGenerateTracks(NULL),
+   fAcceptPtArray(NULL)
 {
    // Constructor.
   
-   // Determine seed for gRandom:
-   delete gRandom;
-   gRandom = new TRandom3(uiSeed); // if uiSeed is 0, the seed is determined uniquely in space and time via TUUID
+   // Each generator owns its random numbers, keyed by (seed, stream, event index):
+   fRandom = new AliFlowPhiloxRandom(uiSeed,uiStream); // if uiSeed is 0, the seed is determined uniquely in space and time via TUUID
 
-} // end of AliFlowEventSimpleMakerOnTheFly_mod::AliFlowEventSimpleMakerOnTheFly_mod(UInt_t uiSeed):
+   fBatch = new AliFlowEventBatch();
+   fTrack = new AliFlowTrackSimple();
+   fCutSets = new AliFlowTrackCutSets(2); // RP and POI cuts, compiled again when other cuts are passed in
+   fTelemetry = new AliFlowOnTheFlyTelemetry();
+
+} // end of AliFlowEventSimpleMakerOnTheFly_mod::AliFlowEventSimpleMakerOnTheFly_mod(UInt_t uiSeed, UInt_t uiStream):
 
 //====================================================================================================================
 
@@ -71,21 +104,84 @@ AliFlowEventSimpleMakerOnTheFly_mod::~AliFlowEventSimpleMakerOnTheFly_mod()
    if(fPtSpectra){delete fPtSpectra;}
    if(fPhiDistribution){delete fPhiDistribution;}
    if(fEtaDistribution){delete fEtaDistribution;}
-   if(gRandom){delete gRandom;}
+   if(fPtSampler){delete fPtSampler;}
+   if(fPhiSampler){delete fPhiSampler;}
+   if(fEtaSampler){delete fEtaSampler;}
+   if(fPtSamplerFolded){delete fPtSamplerFolded;}
+   if(fTables){delete fTables;} // after the samplers attached to it
+   if(fTelemetry){delete fTelemetry;}
+   if(fRandom){delete fRandom;}
+   if(fBatch){delete fBatch;}
+   if(fTrack){delete fTrack;}
+   if(fCutSets){delete fCutSets;}
 
 } // end of AliFlowEventSimpleMakerOnTheFly_mod::~AliFlowEventSimpleMakerOnTheFly_mod() 
 
 //====================================================================================================================
 
+void AliFlowEventSimpleMakerOnTheFly_mod::SetStream(UInt_t uiStream)
+{
+   // Select an independent random stream, e.g. one per thread or PROOF worker sharing the same seed.
+
+   fRandom->SetStream(uiStream);
+
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::SetStream(UInt_t uiStream)
+
+//====================================================================================================================
+
+UInt_t AliFlowEventSimpleMakerOnTheFly_mod::GetStream() const
+{
+   // Random stream of this generator.
+
+   return fRandom->GetStream();
+
+} // end of UInt_t AliFlowEventSimpleMakerOnTheFly_mod::GetStream() const
+
+//====================================================================================================================
+
+UInt_t AliFlowEventSimpleMakerOnTheFly_mod::GetSeed() const
+{
+   // Seed of this generator (resolved from TUUID if 0 was given to the constructor).
+
+   return fRandom->GetSeed();
+
+} // end of UInt_t AliFlowEventSimpleMakerOnTheFly_mod::GetSeed() const
+
+//====================================================================================================================
+
 void AliFlowEventSimpleMakerOnTheFly_mod::Init()
 {
    // Book all objects in this method.
 
-   // a) Define the pt spectra;
-   // b) Define the phi distribution.
-   // c) Define the eta distribution.
+   // TF1::GetRandom() draws from gRandom, so in that (validation) mode seed it from this generator:
+   if(fUseTF1Sampling && gRandom){gRandom->SetSeed(fRandom->GetSeed());}
+
+   // a) Take the precomputed tables from fTablesFile, if given, and skip the rest;
+   // b) Define the pt spectra (and, if requested, fold in the efficiency);
+   // c) Define the phi distribution.
+   // d) Define the eta distribution.
+
+   fNEfficiencyBins = 13;
+   fEfficiencyBins = &fgEfficiencyBins[fCClass][0][0];
+   if(!fTelemetryFile.IsNull() && !fTelemetry->IsShared()){fTelemetry->Attach(fTelemetryFile.Data());}
+
+   // a) Take the precomputed tables:
+   if(!fTablesFile.IsNull() || fSharedTables)
+   {
+      if(fUseTF1Sampling)
+      {
+         cout<<"WARNING: TF1 sampling does not use the precomputed tables."<<endl;
+      } else if(this->InitFromTables())
+      {
+         this->SelectKernels();
+         return;
+      } else
+      {
+         cout<<"WARNING: computing the tables from the formulas instead."<<endl;
+      }
+   }
 
-   // a) Define the pt spectra:
+   // b) Define the pt spectra:
 
    // Centrality Class - Dependent RAA
    if(fCClass==0) {
@@ -105,7 +201,31 @@ void AliFlowEventSimpleMakerOnTheFly_mod::Init()
 
    fPtSpectra->SetParNames("Scaling Constant","D mass","Q-Factor","Q-Temperature");
 
-   // b) Define the phi distribution:
+   // Tabulate the inverse CDF once for this centrality class, so that no TFormula is evaluated per track:
+   if(!fUseTF1Sampling)
+   {
+      fPtSampler = new AliFlowPtSampler();
+      fPtSampler->Build(fPtSpectra,fPtMin,fPtMax);
+   }
+
+   // Fold the efficiency into the spectrum, so that rejected tracks are never generated (the grid intervals split at
+   // the efficiency steps, see AliFlowPtSampler::BuildFolded()):
+   if(!fUseTF1Sampling && !fUniformEfficiency && fFoldEfficiency)
+   {
+      Int_t nPoints = fPtSampler->GetNPoints();
+      Double_t dStep = (fPtMax-fPtMin)/nPoints;
+      Double_t *pdf = new Double_t[nPoints+1];
+      for(Int_t k=0;k<=nPoints;k++)
+      {
+         pdf[k] = fPtSpectra->Eval(fPtMin+k*dStep);
+      }
+      fPtSamplerFolded = new AliFlowPtSampler();
+      fPtSamplerFolded->BuildFolded(fPtMin,fPtMax,nPoints,pdf,fNEfficiencyBins,fEfficiencyBins);
+      delete [] pdf;
+      fMeanEfficiency = fPtSamplerFolded->GetIntegral()/fPtSampler->GetIntegral(); // probability that a track survives AcceptPt()
+   }
+
+   // c) Define the phi distribution:
    Double_t dPhiMin = 0.; 
    Double_t dPhiMax = TMath::TwoPi();
    fPhiDistribution = new TF1("fPhiDistribution","1+2.*[1]*TMath::Cos(x-[0])+2.*[2]*TMath::Cos(2.*(x-[0]))",dPhiMin,dPhiMax);
@@ -118,185 +238,488 @@ void AliFlowEventSimpleMakerOnTheFly_mod::Init()
    fPhiDistribution->SetParName(2,"Elliptic Flow (v2)");
    fPhiDistribution->SetParameter(2,fV2);
 
-   // c) Define the eta distribution:
+   // Per-track v1 changes would force the TF1 to re-integrate for every particle, so sample analytically instead:
+   if(!fUseTF1Sampling)
+   {
+      fPhiSampler = new AliFlowPhiSampler(fV2);
+   }
+
+   // d) Define the eta distribution:
    fEtaDistribution = new TF1("fEtaDistribution","1+[0]*x^2",fEtaMin,fEtaMax); // % dip around 0
 
-   fEtaDistribution->SetParameter(0,0.056); //10-30
+   Double_t dEtaCoefficient = 0.056; //10-30
    if(fCClass==1) {
-      fEtaDistribution->SetParameter(0,0.061); //30-50
+      dEtaCoefficient = 0.061; //30-50
    } else if(fCClass==2) {
-      fEtaDistribution->SetParameter(0,0.074); //60-80
+      dEtaCoefficient = 0.074; //60-80
    }
+   fEtaDistribution->SetParameter(0,dEtaCoefficient);
+   fEtaCoefficient = dEtaCoefficient;
+
+   // The CDF is a cubic with a known inverse, so no TF1 machinery is needed per track:
+   if(!fUseTF1Sampling)
+   {
+      fEtaSampler = new AliFlowEtaSampler(dEtaCoefficient,fEtaMin,fEtaMax);
+   }
+
+   this->SelectKernels();
 
 } // end of void AliFlowEventSimpleMakerOnTheFly_mod::Init()
 
+//====================================================================================================================
+
+void AliFlowEventSimpleMakerOnTheFly_mod::SelectKernels()
+{
+   // Pick the kernels specialized for this configuration, so that the track loops do not test it per track.
+
+   if(fUseTF1Sampling)
+   {
+      fGenerateTracks = &AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTF1;
+   } else if(fPtSamplerFolded)
+   {
+      fGenerateTracks = &AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTables<kEfficiencyFolded>;
+   } else if(fUniformEfficiency)
+   {
+      fGenerateTracks = &AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTables<kEfficiencyUniform>;
+   } else
+   {
+      fGenerateTracks = &AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTables<kEfficiencyReject>;
+   }
+
+   // The built-in efficiency bins are known at compile time, those of a tables file are not:
+   fAcceptPtArray = &AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArray;
+   if(fEfficiencyBins == &fgEfficiencyBins[0][0][0]){fAcceptPtArray = &AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArrayClass<0>;}
+   if(fEfficiencyBins == &fgEfficiencyBins[1][0][0]){fAcceptPtArray = &AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArrayClass<1>;}
+   if(fEfficiencyBins == &fgEfficiencyBins[2][0][0]){fAcceptPtArray = &AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArrayClass<2>;}
+
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::SelectKernels()
+
+//====================================================================================================================
+
+Bool_t AliFlowEventSimpleMakerOnTheFly_mod::InitFromTables()
+{
+   // Attach the samplers to the tables of the current centrality class in fSharedTables or fTablesFile. Nothing is
+   // copied, JIT-compiled or integrated, and all generators on a node that map the same file share one copy of it.
+
+   const AliFlowOnTheFlyTables *pTables = fSharedTables;
+   if(!pTables)
+   {
+      if(!fTables){fTables = new AliFlowOnTheFlyTables();}
+      if(!fTables->IsOpen() && !fTables->Open(fTablesFile.Data())){return kFALSE;}
+      pTables = fTables;
+   }
+   if(fCClass < 0 || fCClass >= pTables->GetNClasses())
+   {
+      cout<<"WARNING: no tables for centrality class "<<fCClass<<"."<<endl;
+      return kFALSE;
+   }
+
+   AliFlowPtSampler *pPtSampler = new AliFlowPtSampler();
+   pTables->AttachPtSampler(fCClass,kFALSE,pPtSampler);
+   if(TMath::Abs(pPtSampler->GetPtMin()-fPtMin) > 1.e-9 || TMath::Abs(pPtSampler->GetPtMax()-fPtMax) > 1.e-9)
+   {
+      cout<<"WARNING: the tables are for pt in ["<<pPtSampler->GetPtMin()<<","<<pPtSampler->GetPtMax()<<"]."<<endl;
+      delete pPtSampler;
+      return kFALSE;
+   }
+   fPtSampler = pPtSampler;
+   fNEfficiencyBins = pTables->GetNEfficiencyBins(fCClass);
+   fEfficiencyBins = pTables->GetEfficiencyBins(fCClass);
+
+   if(!fUniformEfficiency && fFoldEfficiency && pTables->HasFolded(fCClass))
+   {
+      fPtSamplerFolded = new AliFlowPtSampler();
+      pTables->AttachPtSampler(fCClass,kTRUE,fPtSamplerFolded);
+      fMeanEfficiency = fPtSamplerFolded->GetIntegral()/fPtSampler->GetIntegral();
+   } else if(!fUniformEfficiency && fFoldEfficiency)
+   {
+      cout<<"WARNING: the tables have no pt table folded with the efficiency for centrality class "<<fCClass<<", tracks are generated and rejected instead."<<endl;
+   }
+
+   fPhiSampler = new AliFlowPhiSampler(fV2);
+   fEtaCoefficient = pTables->GetEtaCoefficient(fCClass);
+   fEtaSampler = new AliFlowEtaSampler(fEtaCoefficient,fEtaMin,fEtaMax);
+
+   return kTRUE;
+
+} // end of Bool_t AliFlowEventSimpleMakerOnTheFly_mod::InitFromTables()
+
+
+//====================================================================================================================
+
+// Efficiency vs pT per centrality class: {upper pT edge, efficiency below that edge}. Tracks above the last edge are always accepted.
+const Double_t AliFlowEventSimpleMakerOnTheFly_mod::fgEfficiencyBins[3][13][2] = {{ //10-30
+   {2, 0},
+   {3, 0.000767664},
+   {4, 0.00463984},
+   {5, 0.0153918},
+   {6, 0.0321692},
+   {7, 0.0528523},
+   {8, 0.0582403},
+   {10, 0.123859},
+   {12, 0.145762},
+   {16, 0.16983},
+   {24, 0.221823},
+   {36, 0.574282},
+   {50, 0.553414}
+},{ //30-50
+   {2, 0},
+   {3, 0.00219054},
+   {4, 0.012685},
+   {5, 0.0190254},
+   {6, 0.0351793},
+   {7, 0.0726777},
+   {8, 0.0877877},
+   {10, 0.142911},
+   {12, 0.167198},
+   {16, 0.199494},
+   {24, 0.250309},
+   {36, 0.664265},
+   {50, 1}
+},{ //60-80
+   {1, 0},
+   {2, 0.00134291},
+   {3, 0.0119252},
+   {4, 0.0249153},
+   {5, 0.0467732},
+   {6, 0.0523987},
+   {7, 0.110127},
+   {8, 0.152198},
+   {10, 0.188413},
+   {12, 0.302068},
+   {16, 0.558807},
+   {24, 0.653803},
+   {50, 1},
+   }
+};
+
+//====================================================================================================================
+
+Int_t AliFlowEventSimpleMakerOnTheFly_mod::FindEfficiencyBin(Double_t dPt) const
+{
+   // Index of the first efficiency bin whose upper edge is above dPt, or -1 if dPt is above all edges.
+
+   for ( Int_t i = 0; i < fNEfficiencyBins; i++ ) {
+      if(dPt < fEfficiencyBins[2*i]) {
+         return i;
+      }
+   }
+   return -1;
+
+} // end of Int_t AliFlowEventSimpleMakerOnTheFly_mod::FindEfficiencyBin(Double_t dPt) const
+
+//====================================================================================================================
+
+Double_t AliFlowEventSimpleMakerOnTheFly_mod::GetEfficiency(Double_t dPt) const
+{
+   // Detector efficiency at dPt for the current centrality class.
+
+   Int_t iBin = this->FindEfficiencyBin(dPt);
+   return (iBin < 0 ? 1. : fEfficiencyBins[2*iBin+1]);
+
+} // end of Double_t AliFlowEventSimpleMakerOnTheFly_mod::GetEfficiency(Double_t dPt) const
 
 //====================================================================================================================
 
 Bool_t AliFlowEventSimpleMakerOnTheFly_mod::AcceptPt(AliFlowTrackSimple *pTrack)
 {
    // For the case of non-uniform efficiency determine in this method if particle is accepted or rejected for a given pT.
-   
-   Double_t efficiencyBins[3][13][2] = {{ //10-30
-      {2, 0},
-      {3, 0.000767664},
-      {4, 0.00463984},
-      {5, 0.0153918},
-      {6, 0.0321692},
-      {7, 0.0528523},
-      {8, 0.0582403},
-      {10, 0.123859},
-      {12, 0.145762},
-      {16, 0.16983},
-      {24, 0.221823},
-      {36, 0.574282},
-      {50, 0.553414}
-   },{ //30-50
-      {2, 0},
-      {3, 0.00219054},
-      {4, 0.012685},
-      {5, 0.0190254},
-      {6, 0.0351793},
-      {7, 0.0726777},
-      {8, 0.0877877},
-      {10, 0.142911},
-      {12, 0.167198},
-      {16, 0.199494},
-      {24, 0.250309},
-      {36, 0.664265},
-      {50, 1}
-   },{ //60-80
-      {1, 0},
-      {2, 0.00134291},
-      {3, 0.0119252},
-      {4, 0.0249153},
-      {5, 0.0467732},
-      {6, 0.0523987},
-      {7, 0.110127},
-      {8, 0.152198},
-      {10, 0.188413},
-      {12, 0.302068},
-      {16, 0.558807},
-      {24, 0.653803},
-      {50, 1},
+
+   Int_t iBin = this->FindEfficiencyBin(pTrack->Pt());
+   if(iBin < 0) {return kTRUE;} // above the last edge
+
+   return !(fRandom->Uniform(0,1) > fEfficiencyBins[2*iBin+1]); // no mercy!
+ 
+} // end of Bool_t AliFlowEventSimpleMakerOnTheFly_mod::AcceptPt(AliFlowTrackSimple *pTrack);
+
+//====================================================================================================================
+
+ALIFLOW_SIMD_CLONES
+void AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArray(Int_t n, const Double_t *pt, const Double_t *u, UChar_t *accept, Double_t *efficiency, Int_t nBins, const Double_t *bins)
+{
+   // AcceptPt() for n tracks with uniform numbers u: the bin lookup becomes one pass of selects over all tracks
+   // per edge, last edge first, so that the first edge above pt wins. efficiency is scratch space for n values.
+
+   for(Int_t i=0;i<n;i++){efficiency[i] = 1.;}
+   for(Int_t b=nBins-1;b>=0;b--)
+   {
+      Double_t dEdge = bins[2*b];
+      Double_t dBinEfficiency = bins[2*b+1];
+      for(Int_t i=0;i<n;i++)
+      {
+         efficiency[i] = (pt[i] < dEdge ? dBinEfficiency : efficiency[i]);
       }
-   };
+   }
+   for(Int_t i=0;i<n;i++){accept[i] = !(u[i] > efficiency[i]);}
+
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArray(...)
 
-   Bool_t bAccept = kTRUE;
+//====================================================================================================================
 
-   for ( Int_t i = 0; i < 13; i++ ) {
-      if(pTrack->Pt() < efficiencyBins[fCClass][i][0]) {
-         if(gRandom->Uniform(0,1) > efficiencyBins[fCClass][i][1]) {
-            bAccept = kFALSE; // no mercy!
-         }
-         break; //very important break statement, otherwise lose ALL low energy tracks
+template<Int_t kCClass>
+ALIFLOW_SIMD_CLONES
+void AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArrayClass(Int_t n, const Double_t *pt, const Double_t *u, UChar_t *accept, Double_t *efficiency, Int_t /*nBins*/, const Double_t * /*bins*/)
+{
+   // AcceptPtArray() for the built-in bins of centrality class kCClass: edges and efficiencies are constants here,
+   // so the passes over the edges unroll and the selects compare against immediates.
+
+   const Int_t nBins = sizeof(fgEfficiencyBins[kCClass])/sizeof(fgEfficiencyBins[kCClass][0]);
+   for(Int_t i=0;i<n;i++){efficiency[i] = 1.;}
+   for(Int_t b=nBins-1;b>=0;b--)
+   {
+      for(Int_t i=0;i<n;i++)
+      {
+         efficiency[i] = (pt[i] < fgEfficiencyBins[kCClass][b][0] ? fgEfficiencyBins[kCClass][b][1] : efficiency[i]);
       }
    }
+   for(Int_t i=0;i<n;i++){accept[i] = !(u[i] > efficiency[i]);}
 
-   return bAccept;
- 
-} // end of Bool_t AliFlowEventSimpleMakerOnTheFly_mod::AcceptPt(AliFlowTrackSimple *pTrack);
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::AcceptPtArrayClass(...)
+
+//====================================================================================================================
+
+ALIFLOW_SIMD_CLONES
+void AliFlowEventSimpleMakerOnTheFly_mod::ChargeArray(Int_t n, const Double_t *u, const Double_t *eta, Double_t dV1, Int_t *charge, Double_t *v1)
+{
+   // Random charge (as Integer(2) in the scalar code) and the resulting eta- and charge-dependent v1.
+
+   for(Int_t i=0;i<n;i++)
+   {
+      charge[i] = (u[i] >= 0.5 ? 1 : -1);
+      v1[i] = eta[i]*charge[i]*dV1;
+   }
+
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::ChargeArray(Int_t n, const Double_t *u, const Double_t *eta, Double_t dV1, Int_t *charge, Double_t *v1)
+
+//====================================================================================================================
+
+Int_t AliFlowEventSimpleMakerOnTheFly_mod::AddSelection(AliFlowTrackSimpleCuts const *cuts)
+{
+   // One more cut set, evaluated with the RP and POI cuts. One generated sample can so feed several selections, see
+   // AliFlowAnalysisWithMCEventPlane_mod::SetSelectionBits().
+
+   return fCutSets->Add(cuts);
+
+} // end of Int_t AliFlowEventSimpleMakerOnTheFly_mod::AddSelection(AliFlowTrackSimpleCuts const *cuts)
 
 //====================================================================================================================
 
 AliFlowEventSimple* AliFlowEventSimpleMakerOnTheFly_mod::CreateEventOnTheFly(AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI)
 {
-   // Method to create event 'on the fly'.
+   // Create the next event of this generator's stream.
+
+   return this->CreateEventOnTheFly(cutsRP,cutsPOI,fEventIndex++);
+
+} // end of AliFlowEventSimple* AliFlowEventSimpleMakerOnTheFly_mod::CreateEventOnTheFly(AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI)
+
+//====================================================================================================================
+
+AliFlowEventSimple* AliFlowEventSimpleMakerOnTheFly_mod::CreateEventOnTheFly(AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, Long64_t iEvent)
+{
+   // Method to create event number iEvent 'on the fly'. The event depends only on (seed, stream, iEvent),
+   // so any event can be regenerated on its own, in any order and on any worker.
+
+   fBatch->Clear();
+   this->GenerateEvent(iEvent,cutsRP,cutsPOI,fBatch,NULL);
+
+   return fBatch->CreateFlowEventSimple(0);
+    
+} // end of CreateEventOnTheFly()
+
+//====================================================================================================================
+
+void AliFlowEventSimpleMakerOnTheFly_mod::CreateEventsBatch(Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *outBatch)
+{
+   // Create the next n events of this generator's stream into outBatch, which is cleared first.
+   // All tracks of the n events are stored contiguously, so reusing one batch avoids any per-event or per-track allocation.
+
+   outBatch->Clear();
+   outBatch->Reserve(n,n*fMaxMult);
+   for(Int_t i=0;i<n;i++)
+   {
+      this->GenerateEvent(fEventIndex++,cutsRP,cutsPOI,outBatch,NULL);
+   }
+
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::CreateEventsBatch(Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *outBatch)
+
+//====================================================================================================================
+
+void AliFlowEventSimpleMakerOnTheFly_mod::CreateEventsStreamed(Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventSink *sink)
+{
+   // Create the next n events of this generator's stream and feed them track by track into sink. The tracks go
+   // from the generator's scratch columns straight into the sink: no AliFlowEventSimple or batch is ever filled.
+
+   for(Int_t i=0;i<n;i++)
+   {
+      this->GenerateEvent(fEventIndex++,cutsRP,cutsPOI,NULL,sink);
+   }
+
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::CreateEventsStreamed(Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventSink *sink)
+
+//====================================================================================================================
+
+void AliFlowEventSimpleMakerOnTheFly_mod::GenerateEvent(Long64_t iEvent, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *batch, AliFlowEventSink *sink)
+{
+   // Generate event number iEvent and append it to batch, or, if batch is NULL, stream it into sink.
 
    // a) Determine the multiplicity of an event;
    // b) Determine the reaction plane of an event;
    // c) If v2 fluctuates uniformly event-by-event, sample its value from [fMinV2,fMaxV2];
    // d) Create event 'on the fly';
-   // e) Cosmetics for the printout on the screen.
+   // e) Publish the counters (without a stats file, print them every fgProgressCycle events).
+
+   fRandom->SetEvent(iEvent);
 
    // a) Determine the multiplicity of an event:
-   //Int_t iMult = (Int_t)gRandom->Uniform(fMinMult,fMaxMult);
+   //Int_t iMult = (Int_t)fRandom->Uniform(fMinMult,fMaxMult);
    Int_t iMult = fMinMult;
 
 
    // b) Determine the reaction plane of an event:
-   Double_t dReactionPlane = gRandom->Uniform(0.,TMath::TwoPi());
-   fPhiDistribution->SetParameter(0,dReactionPlane);
+   Double_t dReactionPlane = fRandom->Uniform(0.,TMath::TwoPi());
+   if(fPhiDistribution){fPhiDistribution->SetParameter(0,dReactionPlane);} // not booked when the tables come from a file
 
    // d) Create event 'on the fly':
-   AliFlowEventSimple *pEvent = new AliFlowEventSimple(iMult);
-   pEvent->SetReferenceMultiplicity(iMult);
-   pEvent->SetMCReactionPlaneAngle(dReactionPlane);
-
    Int_t nRPs = 0; // number of particles tagged RP in this event
    Int_t nPOIs = 0; // number of particles tagged POI in this event
 
-   for(Int_t p=0;p<iMult;p++)
+   // With the efficiency folded into the spectrum each track survives with probability fMeanEfficiency,
+   // so draw the number of accepted tracks directly and sample their pt from spectrum x efficiency:
+   Bool_t bFolded = (fPtSamplerFolded != NULL);
+   Int_t iGenerate = (bFolded ? fRandom->Binomial(iMult,fMeanEfficiency) : iMult);
+
+   // Sample pt, eta, charge and phi of all tracks into the scratch columns:
+   if((Int_t)fPt.size() <= iGenerate)
+   {
+      fU.resize(iGenerate+1);
+      fPt.resize(iGenerate+1);
+      fEta.resize(iGenerate+1);
+      fPhi.resize(iGenerate+1);
+      fTrackV1.resize(iGenerate+1);
+      fCharge.resize(iGenerate+1);
+      fAccept.resize(iGenerate+1);
+      fEfficiency.resize(iGenerate+1);
+      fSelection.resize(iGenerate+1);
+   }
+   Int_t nTracks = (this->*fGenerateTracks)(iGenerate,dReactionPlane);
+
+   // Checking the RP, POI and further cuts of all tracks in one pass:
+   fCutSets->Update(0,cutsRP); // compiled again only for other cuts
+   fCutSets->Update(1,cutsPOI);
+   Int_t nPass[AliFlowTrackCutSets::fgMaxCutSets] = {0};
+   fCutSets->Evaluate(nTracks,&fPt[0],&fEta[0],&fPhi[0],&fCharge[0],&fSelection[0],nPass);
+   nRPs = nPass[0];
+   nPOIs = nPass[1];
+
+   // introducing limited angular resolution
+   // set error on event plane angle after-the-fact for use in reconstruction
+   Double_t dReactionPlaneWithError = 0.;
+   if(fCClass==2) {
+      dReactionPlaneWithError = fRandom->Gaus(dReactionPlane, 0.942);
+   } else {
+      dReactionPlaneWithError = fRandom->Gaus(dReactionPlane, 0.628);
+   }
+
+   // Hand the tracks over, either stored in the batch or streamed straight from the scratch columns into the sink:
+   if(batch)
+   {
+      batch->BeginEvent(iEvent,iMult,dReactionPlane);
+      for(Int_t p=0;p<nTracks;p++){batch->AddTrack(fPt[p],fEta[p],fPhi[p],fCharge[p],fSelection[p]);}
+      batch->EndEvent(dReactionPlaneWithError,nRPs,nPOIs);
+   } else
    {
-      AliFlowTrackSimple *pTrack = new AliFlowTrackSimple();
+      sink->BeginEvent(dReactionPlaneWithError,iMult,nRPs,nPOIs,iEvent);
+      for(Int_t p=0;p<nTracks;p++){sink->FillTrack(fPt[p],fEta[p],fPhi[p],fCharge[p],fSelection[p]);}
+      AliFlowEventView view;
+      view.Set(nTracks,&fPt[0],&fEta[0],&fPhi[0],&fCharge[0],&fSelection[0],dReactionPlaneWithError,nRPs,nPOIs,iMult,iEvent);
+      sink->EndEvent(view);
+   }
+
+
+   // e) Publish the counters (read them with monitorOnTheFly.C):
+   fTelemetry->CountEvent(iMult,iMult-nTracks,nRPs,nPOIs);
+   if(!fTelemetry->IsShared())
+   {
+      Long64_t nEvents = fTelemetry->Get(AliFlowOnTheFlyTelemetry::kEvents);
+      if(nEvents % fgProgressCycle == 0){cout<<"  .... "<<nEvents<<" events processed ...."<<endl;}
+   }
 
+} // end of void AliFlowEventSimpleMakerOnTheFly_mod::GenerateEvent(Long64_t iEvent, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *batch, AliFlowEventSink *sink)
+
+//====================================================================================================================
+
+Int_t AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTF1(Int_t iGenerate, Double_t dReactionPlane)
+{
+   // Sample the tracks one by one from the TF1s (reference implementation); returns the number of tracks kept.
+
+   AliFlowTrackSimple *pTrack = fTrack;
+   Int_t nTracks = 0;
+   for(Int_t p=0;p<iGenerate;p++)
+   {
       pTrack->SetPt(fPtSpectra->GetRandom()); 
 
       // Check pT efficiency:
       if(!fUniformEfficiency && !this->AcceptPt(pTrack)) {
-         delete pTrack; // very important, otherwise mem leak
          continue;
       }
 
-
       // Eta-dependent and charge-dependent v1:
+      Double_t dEta = fEtaDistribution->GetRandom();
+      Int_t iCharge = (fRandom->Integer(2)>0.5 ? 1 : -1);
+      //Double_t currentV1 = fV1*(1-1/(0.5+pTrack->Pt())); // legacy code from pt-dependent v1
+      fPhiDistribution->SetParameter(1,dEta*iCharge*fV1);
 
-      pTrack->SetEta(fEtaDistribution->GetRandom());
-      pTrack->SetCharge((gRandom->Integer(2)>0.5 ? 1 : -1));
+      fPt[nTracks] = pTrack->Pt();
+      fEta[nTracks] = dEta;
+      fCharge[nTracks] = iCharge;
+      fPhi[nTracks] = fPhiDistribution->GetRandom();
+      nTracks++;
+   }
 
-      //Double_t currentV1 = fV1*(1-1/(0.5+pTrack->Pt())); // legacy code from pt-dependent v1
-      fPhiDistribution->SetParameter(1,pTrack->Eta()*pTrack->Charge()*fV1);
-      pTrack->SetPhi(fPhiDistribution->GetRandom());
+   return nTracks;
 
-      // Checking the RP cuts:     
-      if(cutsRP->PassesCuts(pTrack))
-      {
-         pTrack->TagRP(kTRUE); 
-         nRPs++; 
-      }
-      // Checking the POI cuts:    
-      if(cutsPOI->PassesCuts(pTrack))
-      {
-         pTrack->TagPOI(kTRUE); 
-         nPOIs++;
-      }
-      
-      pEvent->AddTrack(pTrack);
-   } // end of for(Int_t p=0;p<iMult;p++)
-   pEvent->SetNumberOfRPs(nRPs);
-   pEvent->SetNumberOfPOIs(nPOIs);
+} // end of Int_t AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTF1(Int_t iGenerate, Double_t dReactionPlane)
 
-   // introducing limited angular resolution
-   // set error on event plane angle after-the-fact for use in reconstruction
-   Double_t dReactionPlaneWithError;
-   if(fCClass==2) {
-      Double_t dReactionPlaneWithError = gRandom->Gaus(dReactionPlane, 0.942);
-   } else {
-      Double_t dReactionPlaneWithError = gRandom->Gaus(dReactionPlane, 0.628);
-   }
-   pEvent->SetMCReactionPlaneAngle(dReactionPlaneWithError);
+//====================================================================================================================
+
+template<Int_t kEfficiencyMode>
+Int_t AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTables(Int_t iGenerate, Double_t dReactionPlane)
+{
+   // Sample all tracks at once, one column after the other, with the array kernels; returns the number of tracks kept.
 
+   // a) pt from the inverse-CDF table:
+   Int_t n = iGenerate;
+   fRandom->RndmArray(n,&fU[0]);
+   (kEfficiencyMode == kEfficiencyFolded ? fPtSamplerFolded : fPtSampler)->SampleArray(n,&fU[0],&fPt[0]);
 
-   // e) Cosmetics for the printout on the screen:
-   Int_t cycle = 100;
-   if((++fCount % cycle) == 0) 
+   // b) Efficiency test, unless uniform or already folded into the spectrum:
+   if(kEfficiencyMode == kEfficiencyReject)
    {
-      if(TMath::Abs(dReactionPlane)>1.e-44) 
-      {
-         cout<<" MC Reaction Plane Angle = "<<dReactionPlane<<endl;
-      } else 
+      fRandom->RndmArray(n,&fU[0]);
+      fAcceptPtArray(n,&fPt[0],&fU[0],&fAccept[0],&fEfficiency[0],fNEfficiencyBins,fEfficiencyBins);
+      Int_t nKept = 0;
+      for(Int_t p=0;p<n;p++)
       {
-         cout<<" MC Reaction Plane Angle is unknown :'( "<< endl;
-      }     
-      cout<<" # of simulated tracks  = "<<iMult<<endl;
-      cout<<" # of RP tagged tracks  = "<<nRPs<<endl;
-      cout<<" # of POI tagged tracks = "<<nPOIs<<endl;  
-      cout <<"  .... "<<fCount<< " events processed ...."<<endl;
-   } // end of if((++fCount % cycle) == 0) 
-
-   return pEvent;
-    
-} // end of CreateEventOnTheFly()
+         fPt[nKept] = fPt[p];
+         nKept += fAccept[p];
+      }
+      n = nKept;
+   }
+
+   // c) eta:
+   fRandom->RndmArray(n,&fU[0]);
+   fEtaSampler->SampleArray(n,&fU[0],&fEta[0]);
+
+   // d) Charge, and with it the eta- and charge-dependent v1:
+   fRandom->RndmArray(n,&fU[0]);
+   ChargeArray(n,&fU[0],&fEta[0],fV1,&fCharge[0],&fTrackV1[0]);
+
+   // e) phi:
+   fPhiSampler->SampleArray(n,&fTrackV1[0],dReactionPlane,fRandom,&fPhi[0]);
+
+   return n;
+
+} // end of Int_t AliFlowEventSimpleMakerOnTheFly_mod::GenerateTracksTables(Int_t iGenerate, Double_t dReactionPlane)
  
 //====================================================================================================================
 
@@ -15,22 +15,46 @@
 #ifndef ALIFLOWEVENTSIMPLEMAKERONTHEFLY_MOD_H
 #define ALIFLOWEVENTSIMPLEMAKERONTHEFLY_MOD_H
 
+#include <vector>
+
+#include "Rtypes.h"
+#include "TString.h"
+
 class TF1;
-class TRandom3;
 class TH3F;
 
+class AliFlowPhiloxRandom;
+class AliFlowPtSampler;
+class AliFlowPhiSampler;
+class AliFlowEtaSampler;
+class AliFlowOnTheFlyTables;
+class AliFlowOnTheFlyTelemetry;
+class AliFlowTrackCutSets;
+
+class AliFlowEventBatch;
+class AliFlowEventSink;
 class AliFlowEventSimple;
 class AliFlowTrackSimple;
 class AliFlowTrackSimpleCuts;
         
 class AliFlowEventSimpleMakerOnTheFly_mod{
    public:
-      AliFlowEventSimpleMakerOnTheFly_mod(UInt_t uiSeed = 0); // constructor
+      AliFlowEventSimpleMakerOnTheFly_mod(UInt_t uiSeed = 0, UInt_t uiStream = 0); // constructor
       virtual ~AliFlowEventSimpleMakerOnTheFly_mod(); // destructor
       virtual void Init();   
       Bool_t AcceptPt(AliFlowTrackSimple *pTrack);  
+      Double_t GetEfficiency(Double_t dPt) const;
       AliFlowEventSimple* CreateEventOnTheFly(AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI); 
+      AliFlowEventSimple* CreateEventOnTheFly(AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, Long64_t iEvent); 
+      void CreateEventsBatch(Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *outBatch);
+      void CreateEventsStreamed(Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventSink *sink);
       // Setters and getters:
+      void SetEventIndex(Long64_t iEvent) {this->fEventIndex = iEvent;}
+      Long64_t GetEventIndex() const {return this->fEventIndex;} 
+      void SetStream(UInt_t uiStream);
+      UInt_t GetStream() const;
+      UInt_t GetSeed() const;
+      AliFlowPhiloxRandom* GetRandom() const {return this->fRandom;}
       void SetCClass(Int_t dCClass) {this->fCClass = dCClass;}
       Int_t GetCClass() const {return this->fCClass;} 
       void SetMinMult(Int_t iMinMult) {this->fMinMult = iMinMult;}
@@ -45,11 +69,50 @@ class AliFlowEventSimpleMakerOnTheFly_mod{
       void SetPtRange(Double_t minPt, Double_t maxPt) {this->fPtMin = minPt;this->fPtMax = maxPt;};
       void SetUniformEfficiency(Bool_t ue) {this->fUniformEfficiency = ue;}
       Bool_t GetUniformEfficiency() const {return this->fUniformEfficiency;} 
+      void SetUseTF1Sampling(Bool_t uts) {this->fUseTF1Sampling = uts;}
+      Bool_t GetUseTF1Sampling() const {return this->fUseTF1Sampling;} 
+      void SetFoldEfficiency(Bool_t fe) {this->fFoldEfficiency = fe;}
+      Bool_t GetFoldEfficiency() const {return this->fFoldEfficiency;} 
+      Double_t GetMeanEfficiency() const {return this->fMeanEfficiency;} 
+      void SetTablesFile(const char *fileName) {this->fTablesFile = fileName;}
+      const char* GetTablesFile() const {return this->fTablesFile.Data();} 
+      // Tables already mapped by the caller (e.g. once for a whole scan), used instead of fTablesFile; they must outlive this generator:
+      void SetTables(const AliFlowOnTheFlyTables *tables) {this->fSharedTables = tables;}
+      void SetTelemetryFile(const char *fileName) {this->fTelemetryFile = fileName;}
+      const char* GetTelemetryFile() const {return this->fTelemetryFile.Data();} 
+      AliFlowOnTheFlyTelemetry* GetTelemetry() const {return this->fTelemetry;} 
+      // What Init() built, e.g. to store it with AliFlowOnTheFlyTables::Write():
+      const AliFlowPtSampler* GetPtSampler() const {return this->fPtSampler;}
+      const AliFlowPtSampler* GetPtSamplerFolded() const {return this->fPtSamplerFolded;}
+      Int_t GetNEfficiencyBins() const {return this->fNEfficiencyBins;}
+      const Double_t* GetEfficiencyBins() const {return this->fEfficiencyBins;}
+      Double_t GetEtaCoefficient() const {return this->fEtaCoefficient;}
+      // Further selections, evaluated in the same pass as the RP and POI cuts; returns the bit that tags the tracks
+      // passing them in the selection word (bits 0 and 1 are kRP and kPOI), or -1 if no bit is left. An analysis
+      // given the bit with AliFlowAnalysisWithMCEventPlane_mod::SetSelectionBits() analyses that selection, e.g. one
+      // analysis per selection, each Make() of the same batch:
+      Int_t AddSelection(AliFlowTrackSimpleCuts const *cuts);
 
    private:
       AliFlowEventSimpleMakerOnTheFly_mod(const AliFlowEventSimpleMakerOnTheFly_mod& anAnalysis); // copy constructor
       AliFlowEventSimpleMakerOnTheFly_mod& operator=(const AliFlowEventSimpleMakerOnTheFly_mod& anAnalysis); // assignment operator
-      Int_t fCount; // count number of events 
+      Bool_t InitFromTables();
+      Int_t FindEfficiencyBin(Double_t dPt) const;
+      void GenerateEvent(Long64_t iEvent, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *batch, AliFlowEventSink *sink);
+      // Kernels specialized on the configuration at compile time, one of each picked by SelectKernels() in Init():
+      enum EEfficiencyMode {kEfficiencyUniform, kEfficiencyFolded, kEfficiencyReject}; // how the pt efficiency is applied
+      typedef Int_t (AliFlowEventSimpleMakerOnTheFly_mod::*GenerateTracksFn)(Int_t iGenerate, Double_t dReactionPlane);
+      typedef void (*AcceptPtArrayFn)(Int_t n, const Double_t *pt, const Double_t *u, UChar_t *accept, Double_t *efficiency, Int_t nBins, const Double_t *bins);
+      void SelectKernels();
+      Int_t GenerateTracksTF1(Int_t iGenerate, Double_t dReactionPlane);
+      template<Int_t kEfficiencyMode> Int_t GenerateTracksTables(Int_t iGenerate, Double_t dReactionPlane);
+      static void AcceptPtArray(Int_t n, const Double_t *pt, const Double_t *u, UChar_t *accept, Double_t *efficiency, Int_t nBins, const Double_t *bins);
+      template<Int_t kCClass> static void AcceptPtArrayClass(Int_t n, const Double_t *pt, const Double_t *u, UChar_t *accept, Double_t *efficiency, Int_t nBins, const Double_t *bins);
+      static void ChargeArray(Int_t n, const Double_t *u, const Double_t *eta, Double_t dV1, Int_t *charge, Double_t *v1);
+      static const Double_t fgEfficiencyBins[3][13][2]; // efficiency vs pT per centrality class: {upper pT edge, efficiency}
+      static const Long64_t fgProgressCycle = 10000; // events between two lines of progress when the counters are not published
+      Long64_t fEventIndex; // index of the next event created by CreateEventOnTheFly(cutsRP,cutsPOI)
+      AliFlowPhiloxRandom *fRandom; //! counter-based random number generator owned by this generator
       Int_t fCClass;
       Int_t fMinMult; // uniformly sampled multiplicity is >= iMinMult
       Int_t fMaxMult; // uniformly sampled multiplicity is < iMaxMult
@@ -64,6 +127,36 @@ class AliFlowEventSimpleMakerOnTheFly_mod{
       Double_t fPtMax; // maximum Pt
       Double_t fPi; // pi
       Bool_t fUniformEfficiency; // detector has uniform efficiency vs pT, or perhaps not...
+      Bool_t fUseTF1Sampling; // sample directly from the TF1s (exact but slow) instead of the precomputed tables
+      AliFlowPtSampler *fPtSampler; //! inverse-CDF table of fPtSpectra for the current centrality class
+      AliFlowPhiSampler *fPhiSampler; //! analytic sampler of the azimuthal distribution
+      AliFlowEtaSampler *fEtaSampler; //! closed-form sampler of the rapidity distribution
+      Bool_t fFoldEfficiency; // for non-uniform efficiency: sample from spectrum x efficiency instead of generate-then-reject
+      AliFlowPtSampler *fPtSamplerFolded; //! inverse-CDF table of fPtSpectra x efficiency for the current centrality class
+      Double_t fMeanEfficiency; // spectrum-averaged efficiency, i.e. acceptance probability of a single track
+      Double_t fEtaCoefficient; // a in the 1+a*eta^2 rapidity shape of the current centrality class
+      Int_t fNEfficiencyBins; // number of efficiency bins of the current centrality class
+      const Double_t *fEfficiencyBins; //! [2*fNEfficiencyBins] {upper pT edge, efficiency} pairs, from fgEfficiencyBins or fTables
+      TString fTablesFile; // file with the precomputed tables (empty: compute them from the formulas in Init())
+      AliFlowOnTheFlyTables *fTables; //! mapping of fTablesFile
+      const AliFlowOnTheFlyTables *fSharedTables; //! tables mapped by the caller (not owned)
+      TString fTelemetryFile; // stats file the counters are published to (empty: kept privately)
+      AliFlowOnTheFlyTelemetry *fTelemetry; //! events, tracks, rejected tracks, RPs and POIs created so far
+      AliFlowEventBatch *fBatch; //! one-event batch behind CreateEventOnTheFly()
+      AliFlowTrackSimple *fTrack; //! scratch track of GenerateTracksTF1()
+      AliFlowTrackCutSets *fCutSets; //! RP cuts (set 0), POI cuts (set 1) and the cuts of AddSelection()
+      GenerateTracksFn fGenerateTracks; //! GenerateTracksTF1() or GenerateTracksTables<> for the efficiency mode
+      AcceptPtArrayFn fAcceptPtArray; //! AcceptPtArrayClass<> for the built-in bins of fCClass, else AcceptPtArray()
+      // Tracks of the event being generated, column by column (scratch, reused from event to event):
+      std::vector<Double_t> fU; //! uniform random numbers
+      std::vector<Double_t> fPt; //! transverse momentum
+      std::vector<Double_t> fEta; //! pseudorapidity
+      std::vector<Double_t> fPhi; //! azimuthal angle
+      std::vector<Double_t> fTrackV1; //! directed flow of each track
+      std::vector<Int_t> fCharge; //! charge
+      std::vector<UChar_t> fAccept; //! efficiency test result
+      std::vector<Double_t> fEfficiency; //! efficiency at the pt of each track
+      std::vector<UInt_t> fSelection; //! RP and POI tags
 
    ClassDef(AliFlowEventSimpleMakerOnTheFly_mod,1) // macro for rootcint
 };
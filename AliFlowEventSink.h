@@ -0,0 +1,34 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Receiver of events streamed      *
+ * track by track straight out of   *
+ * the flow event maker 'on the     *
+ * fly'.                            *
+ ************************************/
+
+#ifndef ALIFLOWEVENTSINK_H
+#define ALIFLOWEVENTSINK_H
+
+#include "Rtypes.h"
+
+class AliFlowEventView;
+
+class AliFlowEventSink{
+   public:
+      virtual ~AliFlowEventSink() {} // destructor
+      // Start of an event, iEventIndex in its random stream; the RP and POI tags of all its tracks are already known:
+      virtual void BeginEvent(Double_t dMCReactionPlaneAngle, Int_t iReferenceMultiplicity, Int_t nRPs, Int_t nPOIs, Long64_t iEventIndex) = 0;
+      // Every track of the event that survived the efficiency, uiSelection = kRP | kPOI of AliFlowEventBatch (and the
+      // bits of further selections):
+      virtual void FillTrack(Double_t dPt, Double_t dEta, Double_t dPhi, Int_t iCharge, UInt_t uiSelection) = 0;
+      // End of the event. anEvent shows all its tracks at once, for consumers that need pairs of them; its columns
+      // are scratch memory of the generator and only valid during this call:
+      virtual void EndEvent(const AliFlowEventView &anEvent) = 0;
+};
+
+#endif
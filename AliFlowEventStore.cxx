@@ -0,0 +1,336 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Compressed columnar file of      *
+ * events created 'on the fly', and *
+ * their replay under new cuts.     *
+ ************************************/
+
+#include "Riostream.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TMath.h"
+#include "AliFlowTrackSimpleCuts.h"
+#include "AliFlowEventBatch.h"
+#include "AliFlowEventView.h"
+#include "AliFlowEventSink.h"
+#include "AliFlowTrackCutSets.h"
+#include "AliFlowEventStore.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowEventStoreWriter)
+ClassImp(AliFlowEventStoreReader)
+
+//====================================================================================================================
+
+AliFlowEventStoreWriter::AliFlowEventStoreWriter():
+   fFile(NULL),
+   fTree(NULL),
+   fBranchPt(NULL),
+   fBranchEta(NULL),
+   fBranchPhi(NULL),
+   fBranchCharge(NULL),
+   fEventIndex(0),
+   fMultiplicity(0),
+   fReactionPlane(0.),
+   fReactionPlaneWithError(0.),
+   fNTracks(0)
+{
+   // Constructor.
+
+} // end of AliFlowEventStoreWriter::AliFlowEventStoreWriter()
+
+//====================================================================================================================
+
+AliFlowEventStoreWriter::~AliFlowEventStoreWriter()
+{
+   // Destructor.
+
+   this->Close();
+
+} // end of AliFlowEventStoreWriter::~AliFlowEventStoreWriter()
+
+//====================================================================================================================
+
+Bool_t AliFlowEventStoreWriter::Open(const char *fileName, Int_t iCompression)
+{
+   // Create fileName and book the tree. iCompression is a ROOT compression setting (100*algorithm+level).
+
+   this->Close();
+   fFile = new TFile(fileName,"RECREATE","events created 'on the fly'",iCompression);
+   if(fFile->IsZombie())
+   {
+      cout<<"WARNING: cannot create the event store "<<fileName<<"."<<endl;
+      delete fFile;
+      fFile = NULL;
+      return kFALSE;
+   }
+
+   fTree = new TTree("events","events created 'on the fly'");
+   fTree->SetDirectory(fFile);
+   fTree->SetAutoFlush(fgEventsPerCluster);
+   fTree->Branch("eventIndex",&fEventIndex,"eventIndex/L");
+   fTree->Branch("multiplicity",&fMultiplicity,"multiplicity/I");
+   fTree->Branch("reactionPlane",&fReactionPlane,"reactionPlane/D");
+   fTree->Branch("reactionPlaneWithError",&fReactionPlaneWithError,"reactionPlaneWithError/D");
+   fTree->Branch("nTracks",&fNTracks,"nTracks/I");
+   // The addresses of the track columns are set per event, see Fill():
+   fBranchPt = fTree->Branch("pt",(void*)NULL,"pt[nTracks]/D");
+   fBranchEta = fTree->Branch("eta",(void*)NULL,"eta[nTracks]/D");
+   fBranchPhi = fTree->Branch("phi",(void*)NULL,"phi[nTracks]/D");
+   fBranchCharge = fTree->Branch("charge",(void*)NULL,"charge[nTracks]/B");
+
+   return kTRUE;
+
+} // end of Bool_t AliFlowEventStoreWriter::Open(const char *fileName, Int_t iCompression)
+
+//====================================================================================================================
+
+void AliFlowEventStoreWriter::Fill(const AliFlowEventBatch &batch)
+{
+   // Store every event of the batch. The pt, eta and phi branches read straight from the columns of the batch.
+
+   if(!fTree){return;}
+   for(Int_t e=0;e<batch.GetNumberOfEvents();e++)
+   {
+      Int_t iOffset = batch.GetOffset(e);
+      fEventIndex = batch.GetEventIndex(e);
+      fMultiplicity = batch.GetReferenceMultiplicity(e);
+      fReactionPlane = batch.GetReactionPlane(e);
+      fReactionPlaneWithError = batch.GetMCReactionPlaneAngle(e);
+      fNTracks = batch.GetNumberOfTracks(e);
+      if((Int_t)fCharge.size() <= fNTracks){fCharge.resize(fNTracks+1);}
+      for(Int_t t=0;t<fNTracks;t++){fCharge[t] = (Char_t)batch.GetCharge()[iOffset+t];}
+
+      fBranchPt->SetAddress(fNTracks > 0 ? (void*)(batch.GetPt()+iOffset) : (void*)&fCharge[0]);
+      fBranchEta->SetAddress(fNTracks > 0 ? (void*)(batch.GetEta()+iOffset) : (void*)&fCharge[0]);
+      fBranchPhi->SetAddress(fNTracks > 0 ? (void*)(batch.GetPhi()+iOffset) : (void*)&fCharge[0]);
+      fBranchCharge->SetAddress(&fCharge[0]);
+      fTree->Fill();
+   }
+
+} // end of void AliFlowEventStoreWriter::Fill(const AliFlowEventBatch &batch)
+
+//====================================================================================================================
+
+Bool_t AliFlowEventStoreWriter::Close()
+{
+   // Flush the tree and close the file.
+
+   if(!fFile){return kFALSE;}
+   fFile->cd();
+   fTree->Write();
+   fFile->Close();
+   delete fFile; // deletes fTree
+   fFile = NULL;
+   fTree = NULL;
+   return kTRUE;
+
+} // end of Bool_t AliFlowEventStoreWriter::Close()
+
+//====================================================================================================================
+
+Long64_t AliFlowEventStoreWriter::GetEntries() const
+{
+   // Number of events stored so far.
+
+   return (fTree ? fTree->GetEntries() : 0);
+
+} // end of Long64_t AliFlowEventStoreWriter::GetEntries() const
+
+//====================================================================================================================
+
+AliFlowEventStoreReader::AliFlowEventStoreReader():
+   fFile(NULL),
+   fTree(NULL),
+   fBranchNTracks(NULL),
+   fCutSets(NULL),
+   fEventIndex(0),
+   fMultiplicity(0),
+   fReactionPlane(0.),
+   fReactionPlaneWithError(0.),
+   fNTracks(0),
+   fNRPs(0),
+   fNPOIs(0)
+{
+   // Constructor.
+
+   fCutSets = new AliFlowTrackCutSets(2);
+
+} // end of AliFlowEventStoreReader::AliFlowEventStoreReader()
+
+//====================================================================================================================
+
+AliFlowEventStoreReader::~AliFlowEventStoreReader()
+{
+   // Destructor.
+
+   this->Close();
+   if(fCutSets){delete fCutSets;}
+
+} // end of AliFlowEventStoreReader::~AliFlowEventStoreReader()
+
+//====================================================================================================================
+
+Bool_t AliFlowEventStoreReader::Open(const char *fileName)
+{
+   // Open fileName and attach the branches.
+
+   this->Close();
+   fFile = TFile::Open(fileName,"READ");
+   fTree = (fFile && !fFile->IsZombie() ? dynamic_cast<TTree*>(fFile->Get("events")) : NULL);
+   if(!fTree)
+   {
+      cout<<"WARNING: "<<fileName<<" is not an event store."<<endl;
+      this->Close();
+      return kFALSE;
+   }
+
+   fTree->SetBranchAddress("eventIndex",&fEventIndex);
+   fTree->SetBranchAddress("multiplicity",&fMultiplicity);
+   fTree->SetBranchAddress("reactionPlane",&fReactionPlane);
+   fTree->SetBranchAddress("reactionPlaneWithError",&fReactionPlaneWithError);
+   fTree->SetBranchAddress("nTracks",&fNTracks,&fBranchNTracks);
+   // The TTreeCache fetches the baskets of all branches of a whole chunk in few large reads:
+   fTree->SetCacheSize(32*1024*1024);
+   fTree->AddBranchToCache("*",kTRUE);
+   fTree->StopCacheLearningPhase();
+
+   return kTRUE;
+
+} // end of Bool_t AliFlowEventStoreReader::Open(const char *fileName)
+
+//====================================================================================================================
+
+void AliFlowEventStoreReader::Close()
+{
+   // Close the file.
+
+   if(fFile){delete fFile;} // deletes fTree
+   fFile = NULL;
+   fTree = NULL;
+   fBranchNTracks = NULL;
+
+} // end of void AliFlowEventStoreReader::Close()
+
+//====================================================================================================================
+
+Long64_t AliFlowEventStoreReader::GetEntries() const
+{
+   // Number of stored events.
+
+   return (fTree ? fTree->GetEntries() : 0);
+
+} // end of Long64_t AliFlowEventStoreReader::GetEntries() const
+
+//====================================================================================================================
+
+void AliFlowEventStoreReader::PrepareRange(Long64_t first, Long64_t last)
+{
+   // Let the cache prefetch exactly the clusters of [first,last).
+
+   fTree->SetCacheEntryRange(first,last);
+
+} // end of void AliFlowEventStoreReader::PrepareRange(Long64_t first, Long64_t last)
+
+//====================================================================================================================
+
+Bool_t AliFlowEventStoreReader::ReadEvent(Long64_t entry, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI)
+{
+   // Read one event into the scratch columns and tag its tracks with cutsRP and cutsPOI.
+
+   // a) Size the track buffers for this event, then read it;
+   // b) Apply the cuts.
+
+   // a) Size the track buffers, then read:
+   if(fBranchNTracks->GetEntry(entry) <= 0){return kFALSE;}
+   if((Int_t)fPt.size() <= fNTracks)
+   {
+      fPt.resize(fNTracks+1);
+      fEta.resize(fNTracks+1);
+      fPhi.resize(fNTracks+1);
+      fChargeStored.resize(fNTracks+1);
+      fCharge.resize(fNTracks+1);
+      fSelection.resize(fNTracks+1);
+      fTree->SetBranchAddress("pt",&fPt[0]);
+      fTree->SetBranchAddress("eta",&fEta[0]);
+      fTree->SetBranchAddress("phi",&fPhi[0]);
+      fTree->SetBranchAddress("charge",&fChargeStored[0]);
+   }
+   if(fTree->GetEntry(entry) <= 0){return kFALSE;}
+
+   // b) Apply the cuts:
+   for(Int_t t=0;t<fNTracks;t++){fCharge[t] = fChargeStored[t];}
+   fCutSets->Update(0,cutsRP); // compiled again only for other cuts
+   fCutSets->Update(1,cutsPOI);
+   Int_t nPass[2] = {0};
+   fCutSets->Evaluate(fNTracks,&fPt[0],&fEta[0],&fPhi[0],&fCharge[0],&fSelection[0],nPass);
+   fNRPs = nPass[0];
+   fNPOIs = nPass[1];
+
+   return kTRUE;
+
+} // end of Bool_t AliFlowEventStoreReader::ReadEvent(Long64_t entry, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI)
+
+//====================================================================================================================
+
+Int_t AliFlowEventStoreReader::ReadEvents(Long64_t first, Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *batch)
+{
+   // Append events [first,first+n) to batch, tagged with the new cuts.
+
+   if(!fTree){return 0;}
+   Long64_t last = TMath::Min(first+n,fTree->GetEntries());
+   this->PrepareRange(first,last);
+   Int_t nRead = 0;
+   for(Long64_t entry=first;entry<last;entry++)
+   {
+      if(!this->ReadEvent(entry,cutsRP,cutsPOI)){break;}
+      batch->BeginEvent(fEventIndex,fMultiplicity,fReactionPlane);
+      for(Int_t t=0;t<fNTracks;t++){batch->AddTrack(fPt[t],fEta[t],fPhi[t],fCharge[t],fSelection[t]);}
+      batch->EndEvent(fReactionPlaneWithError,fNRPs,fNPOIs);
+      nRead++;
+   }
+   return nRead;
+
+} // end of Int_t AliFlowEventStoreReader::ReadEvents(Long64_t first, Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *batch)
+
+//====================================================================================================================
+
+Int_t AliFlowEventStoreReader::ReplayEvents(Long64_t first, Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventSink *sink)
+{
+   // Stream events [first,first+n) into sink, tagged with the new cuts, as the generator does.
+
+   if(!fTree){return 0;}
+   Long64_t last = TMath::Min(first+n,fTree->GetEntries());
+   this->PrepareRange(first,last);
+   AliFlowEventView view;
+   Int_t nRead = 0;
+   for(Long64_t entry=first;entry<last;entry++)
+   {
+      if(!this->ReadEvent(entry,cutsRP,cutsPOI)){break;}
+      sink->BeginEvent(fReactionPlaneWithError,fMultiplicity,fNRPs,fNPOIs,fEventIndex);
+      for(Int_t t=0;t<fNTracks;t++){sink->FillTrack(fPt[t],fEta[t],fPhi[t],fCharge[t],fSelection[t]);}
+      view.Set(fNTracks,&fPt[0],&fEta[0],&fPhi[0],&fCharge[0],&fSelection[0],fReactionPlaneWithError,fNRPs,fNPOIs,fMultiplicity,fEventIndex);
+      sink->EndEvent(view);
+      nRead++;
+   }
+   return nRead;
+
+} // end of Int_t AliFlowEventStoreReader::ReplayEvents(Long64_t first, Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventSink *sink)
+
+//====================================================================================================================
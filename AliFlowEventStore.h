@@ -0,0 +1,102 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Compressed columnar file of      *
+ * events created 'on the fly', and *
+ * their replay under new cuts.     *
+ ************************************/
+
+#ifndef ALIFLOWEVENTSTORE_H
+#define ALIFLOWEVENTSTORE_H
+
+#include <vector>
+
+#include "Rtypes.h"
+
+class TFile;
+class TTree;
+class TBranch;
+
+class AliFlowEventBatch;
+class AliFlowEventSink;
+class AliFlowTrackCutSets;
+class AliFlowTrackSimpleCuts;
+
+// One TTree entry per event; every track quantity is its own branch (a column), compressed basket by basket, and
+// the baskets of fgEventsPerCluster events form a cluster that can be read and unzipped on its own.
+class AliFlowEventStoreWriter{
+   public:
+      static const Int_t fgEventsPerCluster = 1000; // events per independently readable chunk
+
+      AliFlowEventStoreWriter(); // constructor
+      virtual ~AliFlowEventStoreWriter(); // destructor
+      Bool_t Open(const char *fileName, Int_t iCompression = 404); // default: LZ4 level 4, fast to decompress
+      void Fill(const AliFlowEventBatch &batch); // store all events of batch, including the tracks cut away by the RP and POI cuts
+      Bool_t Close(); // write the remaining baskets and close the file
+      Long64_t GetEntries() const;
+
+   private:
+      AliFlowEventStoreWriter(const AliFlowEventStoreWriter& aWriter); // copy constructor
+      AliFlowEventStoreWriter& operator=(const AliFlowEventStoreWriter& aWriter); // assignment operator
+      TFile *fFile; // output file
+      TTree *fTree; // one entry per event
+      TBranch *fBranchPt; // pt[nTracks]
+      TBranch *fBranchEta; // eta[nTracks]
+      TBranch *fBranchPhi; // phi[nTracks]
+      TBranch *fBranchCharge; // charge[nTracks]
+      Long64_t fEventIndex; // index of the event in its random stream
+      Int_t fMultiplicity; // reference multiplicity
+      Double_t fReactionPlane; // true reaction plane
+      Double_t fReactionPlaneWithError; // reaction plane with limited angular resolution
+      Int_t fNTracks; // number of tracks
+      std::vector<Char_t> fCharge; //! charges of one event, narrowed to one byte
+
+   ClassDef(AliFlowEventStoreWriter,0) // writer of the columnar event store
+};
+
+//====================================================================================================================
+
+class AliFlowEventStoreReader{
+   public:
+      AliFlowEventStoreReader(); // constructor
+      virtual ~AliFlowEventStoreReader(); // destructor
+      Bool_t Open(const char *fileName); // each thread needs its own reader
+      void Close();
+      Long64_t GetEntries() const;
+      // Events [first,first+n) (or up to the end of the store) tagged with new RP and POI cuts, appended to batch
+      // or streamed into sink; returns the number of events read:
+      Int_t ReadEvents(Long64_t first, Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventBatch *batch);
+      Int_t ReplayEvents(Long64_t first, Int_t n, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI, AliFlowEventSink *sink);
+
+   private:
+      AliFlowEventStoreReader(const AliFlowEventStoreReader& aReader); // copy constructor
+      AliFlowEventStoreReader& operator=(const AliFlowEventStoreReader& aReader); // assignment operator
+      Bool_t ReadEvent(Long64_t entry, AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI);
+      void PrepareRange(Long64_t first, Long64_t last);
+      TFile *fFile; // input file
+      TTree *fTree; // one entry per event
+      TBranch *fBranchNTracks; // read first, to size the track buffers
+      AliFlowTrackCutSets *fCutSets; // compiled RP (set 0) and POI (set 1) cuts
+      // The event read last:
+      Long64_t fEventIndex; // index of the event in its random stream
+      Int_t fMultiplicity; // reference multiplicity
+      Double_t fReactionPlane; // true reaction plane
+      Double_t fReactionPlaneWithError; // reaction plane with limited angular resolution
+      Int_t fNTracks; // number of tracks
+      Int_t fNRPs; // number of tracks passing the RP cuts
+      Int_t fNPOIs; // number of tracks passing the POI cuts
+      std::vector<Double_t> fPt; //! transverse momentum
+      std::vector<Double_t> fEta; //! pseudorapidity
+      std::vector<Double_t> fPhi; //! azimuthal angle
+      std::vector<Char_t> fChargeStored; //! charge as stored
+      std::vector<Int_t> fCharge; //! charge
+      std::vector<UInt_t> fSelection; //! kRP | kPOI under the new cuts
+
+   ClassDef(AliFlowEventStoreReader,0) // reader of the columnar event store
+};
+
+#endif
@@ -0,0 +1,226 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Columnar (structure of arrays)   *
+ * view of one flow event and the   *
+ * arena that backs its columns.    *
+ ************************************/
+
+#include <cstdlib>
+
+#include "AliFlowEventSimple.h"
+#include "AliFlowTrackSimple.h"
+#include "AliFlowEventBatch.h"
+#include "AliFlowEventView.h"
+
+ClassImp(AliFlowTrackArena)
+ClassImp(AliFlowEventView)
+
+//====================================================================================================================
+
+AliFlowTrackArena::AliFlowTrackArena(Long64_t lBlockSize):
+   fBlock(NULL),
+   fSize(lBlockSize),
+   fUsed(0),
+   fOverflowSize(0)
+{
+   // Constructor.
+
+   fBlock = static_cast<char*>(std::malloc(fSize));
+
+} // end of AliFlowTrackArena::AliFlowTrackArena(Long64_t lBlockSize)
+
+//====================================================================================================================
+
+AliFlowTrackArena::~AliFlowTrackArena()
+{
+   // Destructor.
+
+   this->Reset();
+   std::free(fBlock);
+
+} // end of AliFlowTrackArena::~AliFlowTrackArena()
+
+//====================================================================================================================
+
+void* AliFlowTrackArena::AllocateBytes(Long64_t lBytes)
+{
+   // Hand out lBytes from the main block, rounded up to whole cache lines.
+
+   const Long64_t kAlign = 64;
+   lBytes = (lBytes+kAlign-1)/kAlign*kAlign;
+   // malloc aligns only to 16 bytes, so align the address rather than the offset:
+   Long64_t lPadding = (kAlign-(Long64_t)((size_t)(fBlock+fUsed) % kAlign)) % kAlign;
+   if(fUsed+lPadding+lBytes <= fSize)
+   {
+      void *pMemory = fBlock+fUsed+lPadding;
+      fUsed += lPadding+lBytes;
+      return pMemory;
+   }
+   // Main block is full: serve from a separate block until the next Reset() grows the main block.
+   char *pOverflow = static_cast<char*>(std::malloc(lBytes+kAlign));
+   fOverflow.push_back(pOverflow);
+   fOverflowSize += lBytes+kAlign;
+   return pOverflow+(kAlign-(size_t)pOverflow % kAlign) % kAlign;
+
+} // end of void* AliFlowTrackArena::AllocateBytes(Long64_t lBytes)
+
+//====================================================================================================================
+
+void AliFlowTrackArena::Reset()
+{
+   // Release all allocations. If the main block overflowed, it is enlarged so that the same load fits next time.
+
+   if(!fOverflow.empty())
+   {
+      for(UInt_t b=0;b<fOverflow.size();b++){std::free(fOverflow[b]);}
+      fOverflow.clear();
+      fSize += fOverflowSize;
+      fOverflowSize = 0;
+      std::free(fBlock);
+      fBlock = static_cast<char*>(std::malloc(fSize));
+   }
+   fUsed = 0;
+
+} // end of void AliFlowTrackArena::Reset()
+
+//====================================================================================================================
+
+AliFlowEventView::AliFlowEventView():
+   fNumberOfTracks(0),
+   fPt(NULL),
+   fEta(NULL),
+   fPhi(NULL),
+   fCharge(NULL),
+   fSelection(NULL),
+   fMCReactionPlaneAngle(0.),
+   fNumberOfRPs(0),
+   fNumberOfPOIs(0),
+   fReferenceMultiplicity(0),
+   fEventIndex(-1)
+{
+   // Constructor.
+
+} // end of AliFlowEventView::AliFlowEventView()
+
+//====================================================================================================================
+
+void AliFlowEventView::Set(const AliFlowEventBatch &batch, Int_t i)
+{
+   // Point the view at event i of the batch; the columns stay owned by the batch.
+
+   Int_t iOffset = batch.GetOffset(i);
+   fNumberOfTracks = batch.GetNumberOfTracks(i);
+   fPt = batch.GetPt()+iOffset;
+   fEta = batch.GetEta()+iOffset;
+   fPhi = batch.GetPhi()+iOffset;
+   fCharge = batch.GetCharge()+iOffset;
+   fSelection = batch.GetSelection()+iOffset;
+   fMCReactionPlaneAngle = batch.GetMCReactionPlaneAngle(i);
+   fNumberOfRPs = batch.GetNumberOfRPs(i);
+   fNumberOfPOIs = batch.GetNumberOfPOIs(i);
+   fReferenceMultiplicity = batch.GetReferenceMultiplicity(i);
+   fEventIndex = batch.GetEventIndex(i);
+
+} // end of void AliFlowEventView::Set(const AliFlowEventBatch &batch, Int_t i)
+
+//====================================================================================================================
+
+void AliFlowEventView::Set(AliFlowEventSimple *anEvent, AliFlowTrackArena *arena)
+{
+   // Copy the tracks of anEvent into columns allocated from the arena (compatibility with AliFlowEventSimple).
+
+   Int_t iNumberOfTracks = anEvent->NumberOfTracks();
+   Double_t *pt = arena->Allocate<Double_t>(iNumberOfTracks);
+   Double_t *eta = arena->Allocate<Double_t>(iNumberOfTracks);
+   Double_t *phi = arena->Allocate<Double_t>(iNumberOfTracks);
+   Int_t *charge = arena->Allocate<Int_t>(iNumberOfTracks);
+   UInt_t *selection = arena->Allocate<UInt_t>(iNumberOfTracks);
+   Int_t nTracks = 0;
+   Int_t nPOIs = 0;
+   for(Int_t i=0;i<iNumberOfTracks;i++)
+   {
+      AliFlowTrackSimple *pTrack = anEvent->GetTrack(i);
+      if(!pTrack){continue;}
+      pt[nTracks] = pTrack->Pt();
+      eta[nTracks] = pTrack->Eta();
+      phi[nTracks] = pTrack->Phi();
+      charge[nTracks] = pTrack->Charge();
+      selection[nTracks] = (pTrack->InRPSelection() ? AliFlowEventBatch::kRP : 0) | (pTrack->InPOISelection() ? AliFlowEventBatch::kPOI : 0);
+      if(pTrack->InPOISelection()){nPOIs++;}
+      nTracks++;
+   }
+   fNumberOfTracks = nTracks;
+   fPt = pt;
+   fEta = eta;
+   fPhi = phi;
+   fCharge = charge;
+   fSelection = selection;
+   fMCReactionPlaneAngle = anEvent->GetMCReactionPlaneAngle();
+   fNumberOfRPs = anEvent->GetEventNSelTracksRP();
+   fNumberOfPOIs = nPOIs;
+   fReferenceMultiplicity = anEvent->GetReferenceMultiplicity();
+   fEventIndex = -1;
+
+} // end of void AliFlowEventView::Set(AliFlowEventSimple *anEvent, AliFlowTrackArena *arena)
+
+//====================================================================================================================
+
+void AliFlowEventView::Select(const AliFlowEventView &anEvent, Int_t iRPBit, Int_t iPOIBit, AliFlowTrackArena *arena)
+{
+   // View the tracks of anEvent with bit iRPBit of their selection word as RPs and those with bit iPOIBit as POIs.
+   // The kinematic columns are shared with anEvent.
+
+   *this = anEvent;
+   UInt_t *selection = arena->Allocate<UInt_t>(fNumberOfTracks);
+   Int_t nRPs = 0;
+   Int_t nPOIs = 0;
+   for(Int_t i=0;i<fNumberOfTracks;i++)
+   {
+      UInt_t uiRP = (anEvent.fSelection[i]>>iRPBit) & 1u;
+      UInt_t uiPOI = (anEvent.fSelection[i]>>iPOIBit) & 1u;
+      selection[i] = uiRP*AliFlowEventBatch::kRP | uiPOI*AliFlowEventBatch::kPOI;
+      nRPs += uiRP;
+      nPOIs += uiPOI;
+   }
+   fSelection = selection;
+   fNumberOfRPs = nRPs;
+   fNumberOfPOIs = nPOIs;
+
+} // end of void AliFlowEventView::Select(const AliFlowEventView &anEvent, Int_t iRPBit, Int_t iPOIBit, AliFlowTrackArena *arena)
+
+//====================================================================================================================
+
+void AliFlowEventView::Set(Int_t nTracks, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge, const UInt_t *selection,
+                           Double_t dMCReactionPlaneAngle, Int_t nRPs, Int_t nPOIs, Int_t iReferenceMultiplicity, Long64_t iEventIndex)
+{
+   // Point the view at columns owned by someone else, e.g. the scratch columns of a generator.
+
+   fNumberOfTracks = nTracks;
+   fPt = pt;
+   fEta = eta;
+   fPhi = phi;
+   fCharge = charge;
+   fSelection = selection;
+   fMCReactionPlaneAngle = dMCReactionPlaneAngle;
+   fNumberOfRPs = nRPs;
+   fNumberOfPOIs = nPOIs;
+   fReferenceMultiplicity = iReferenceMultiplicity;
+   fEventIndex = iEventIndex;
+
+} // end of void AliFlowEventView::Set(Int_t nTracks, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge, const UInt_t *selection, Double_t dMCReactionPlaneAngle, Int_t nRPs, Int_t nPOIs, Int_t iReferenceMultiplicity, Long64_t iEventIndex)
+
+//====================================================================================================================
@@ -0,0 +1,99 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Columnar (structure of arrays)   *
+ * view of one flow event and the   *
+ * arena that backs its columns.    *
+ ************************************/
+
+#ifndef ALIFLOWEVENTVIEW_H
+#define ALIFLOWEVENTVIEW_H
+
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "AliFlowEventBatch.h"
+
+class AliFlowEventSimple;
+
+//====================================================================================================================
+
+class AliFlowTrackArena{
+   public:
+      AliFlowTrackArena(Long64_t lBlockSize = 65536); // constructor
+      virtual ~AliFlowTrackArena(); // destructor
+      // Uninitialized room for n objects of type T, aligned to a cache line; valid until the next Reset().
+      template<typename T> T* Allocate(Int_t n) {return static_cast<T*>(this->AllocateBytes((Long64_t)n*sizeof(T)));}
+      void Reset(); // release everything at once, e.g. between events
+      Long64_t GetCapacity() const {return this->fSize;}
+
+   private:
+      AliFlowTrackArena(const AliFlowTrackArena& anArena); // copy constructor
+      AliFlowTrackArena& operator=(const AliFlowTrackArena& anArena); // assignment operator
+      void* AllocateBytes(Long64_t lBytes);
+      char *fBlock; // main block
+      Long64_t fSize; // size of the main block
+      Long64_t fUsed; // bytes handed out from the main block
+      std::vector<char*> fOverflow; // blocks allocated after the main block ran full, merged into it by Reset()
+      Long64_t fOverflowSize; // total size of the overflow blocks
+
+   ClassDef(AliFlowTrackArena,0) // bump allocator for per-event track columns
+};
+
+//====================================================================================================================
+
+class AliFlowEventView{
+   public:
+      AliFlowEventView(); // constructor
+      virtual ~AliFlowEventView() {} // destructor
+      void Set(const AliFlowEventBatch &batch, Int_t i); // event i of a batch, no copy
+      void Set(AliFlowEventSimple *anEvent, AliFlowTrackArena *arena); // copy of an AliFlowEventSimple into the arena
+      void Set(Int_t nTracks, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge, const UInt_t *selection,
+               Double_t dMCReactionPlaneAngle, Int_t nRPs, Int_t nPOIs, Int_t iReferenceMultiplicity, Long64_t iEventIndex); // columns owned elsewhere, no copy
+      // anEvent with bit iRPBit of the selection word as RP and bit iPOIBit as POI, e.g. a cut set added with
+      // AliFlowEventSimpleMakerOnTheFly_mod::AddSelection(); only the new selection column is allocated from the arena:
+      void Select(const AliFlowEventView &anEvent, Int_t iRPBit, Int_t iPOIBit, AliFlowTrackArena *arena);
+
+      // Event:
+      Int_t NumberOfTracks() const {return this->fNumberOfTracks;}
+      Double_t GetMCReactionPlaneAngle() const {return this->fMCReactionPlaneAngle;}
+      Int_t GetEventNSelTracksRP() const {return this->fNumberOfRPs;}
+      Int_t GetNumberOfPOIs() const {return this->fNumberOfPOIs;}
+      Int_t GetReferenceMultiplicity() const {return this->fReferenceMultiplicity;}
+      Long64_t GetEventIndex() const {return this->fEventIndex;} // -1 if not known (an AliFlowEventSimple)
+      // Tracks:
+      Double_t Pt(Int_t i) const {return this->fPt[i];}
+      Double_t Eta(Int_t i) const {return this->fEta[i];}
+      Double_t Phi(Int_t i) const {return this->fPhi[i];}
+      Int_t Charge(Int_t i) const {return this->fCharge[i];}
+      Bool_t InRPSelection(Int_t i) const {return (this->fSelection[i] & AliFlowEventBatch::kRP) != 0;}
+      Bool_t InPOISelection(Int_t i) const {return (this->fSelection[i] & AliFlowEventBatch::kPOI) != 0;}
+      // Columns:
+      const Double_t* GetPt() const {return this->fPt;}
+      const Double_t* GetEta() const {return this->fEta;}
+      const Double_t* GetPhi() const {return this->fPhi;}
+      const Int_t* GetCharge() const {return this->fCharge;}
+      const UInt_t* GetSelection() const {return this->fSelection;} // AliFlowEventBatch::kRP | kPOI
+
+   private:
+      Int_t fNumberOfTracks; // number of tracks
+      const Double_t *fPt; // [fNumberOfTracks] transverse momentum
+      const Double_t *fEta; // [fNumberOfTracks] pseudorapidity
+      const Double_t *fPhi; // [fNumberOfTracks] azimuthal angle
+      const Int_t *fCharge; // [fNumberOfTracks] charge
+      const UInt_t *fSelection; // [fNumberOfTracks] selection bitmask
+      Double_t fMCReactionPlaneAngle; // MC reaction plane
+      Int_t fNumberOfRPs; // number of RP tagged tracks
+      Int_t fNumberOfPOIs; // number of POI tagged tracks
+      Int_t fReferenceMultiplicity; // reference multiplicity
+      Long64_t fEventIndex; // index of the event in its random stream (-1: not known)
+
+   ClassDef(AliFlowEventView,0) // columnar view of one flow event
+};
+
+#endif
@@ -0,0 +1,336 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+
+/************************************
+ * Run parameters of the analysis   *
+ * 'on the fly', read at runtime    *
+ * from a TEnv file.                *
+ ************************************/
+
+#include "Riostream.h"
+#include "TEnv.h"
+#include "TMath.h"
+#include "TObjArray.h"
+#include "TObjString.h"
+#include "AliFlowTrackSimpleCuts.h"
+#include "AliFlowEventSimpleMakerOnTheFly_mod.h"
+#include "AliFlowAnalysisWithMCEventPlane_mod.h"
+#include "AliFlowOnTheFlyConfig.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowOnTheFlyConfig)
+
+namespace {
+// The defaults, as the globals of config.h, kept apart from any config.h a macro includes itself:
+#include "config.h"
+}
+
+const char *AliFlowOnTheFlyConfig::fgKeys[] = {
+   "cClass","iNevts","iNThreads","iEventsPerChunk","iEventsPerBlock","iMinMult","iMaxMult","dV1","dV2","bSameSeed",
+   "minPt","maxPt","ptBins","minEta","maxEta","etaBins","ptSubHists","ptCutOffs","nHarmonics",
+   "nSubsamples","bBootstrap",
+   "uniformEfficiency","bFoldEfficiency","bUseTF1Sampling","bStreamEvents","sTablesFile","sTelemetryFile",
+   "ptMinRP","ptMaxRP","etaMinRP","etaMaxRP","phiMinRP","phiMaxRP","bUseChargeRP","chargeRP",
+   "ptMinPOI","ptMaxPOI","etaMinPOI","etaMaxPOI","phiMinPOI","phiMaxPOI","bUseChargePOI","chargePOI",
+   NULL};
+
+//====================================================================================================================
+
+AliFlowOnTheFlyConfig::AliFlowOnTheFlyConfig():
+   fLabel("default"),
+   fCClass(cClass),
+   fNEvents(iNevts),
+   fNThreads(iNThreads),
+   fEventsPerChunk(iEventsPerChunk),
+   fEventsPerBlock(iEventsPerBlock),
+   fMinMult(iMinMult),
+   fMaxMult(iMaxMult),
+   fV1(dV1),
+   fV2(dV2),
+   fSameSeed(bSameSeed),
+   fPtMin(minPt),
+   fPtMax(maxPt),
+   fNBinsPt(ptBins),
+   fEtaMin(minEta),
+   fEtaMax(maxEta),
+   fNBinsEta(etaBins),
+   fPtSubHists(ptSubHists),
+   fPtCutOffs(""),
+   fNHarmonics(nHarmonics),
+   fNSubsamples(nSubsamples),
+   fBootstrap(bBootstrap),
+   fUniformEfficiency(uniformEfficiency),
+   fFoldEfficiency(bFoldEfficiency),
+   fUseTF1Sampling(bUseTF1Sampling),
+   fStreamEvents(bStreamEvents),
+   fTablesFile(sTablesFile),
+   fTelemetryFile(sTelemetryFile),
+   fPtMinRP(ptMinRP),
+   fPtMaxRP(ptMaxRP),
+   fEtaMinRP(etaMinRP),
+   fEtaMaxRP(etaMaxRP),
+   fPhiMinRP(phiMinRP),
+   fPhiMaxRP(phiMaxRP),
+   fUseChargeRP(bUseChargeRP),
+   fChargeRP(chargeRP),
+   fPtMinPOI(ptMinPOI),
+   fPtMaxPOI(ptMaxPOI),
+   fEtaMinPOI(etaMinPOI),
+   fEtaMaxPOI(etaMaxPOI),
+   fPhiMinPOI(phiMinPOI),
+   fPhiMaxPOI(phiMaxPOI),
+   fUseChargePOI(bUseChargePOI),
+   fChargePOI(chargePOI)
+{
+   // Constructor.
+
+   for(Int_t k=0;k<nPtCutOffs;k++){fPtCutOffs += TString::Format(k ? " %g" : "%g",ptCutOffs[k]);}
+
+} // end of AliFlowOnTheFlyConfig::AliFlowOnTheFlyConfig()
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyConfig::ReadFile(const char *fileName)
+{
+   // Take the parameters found in fileName (TEnv format, "key: value" per line).
+
+   TEnv env("");
+   if(env.ReadFile(fileName,kEnvLocal) != 0)
+   {
+      cout<<"WARNING: cannot read the configuration "<<fileName<<"."<<endl;
+      return kFALSE;
+   }
+   this->Apply(env);
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyConfig::ReadFile(const char *fileName)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyConfig::SetValue(const char *key, const char *value)
+{
+   // Set one parameter from its text form, as it would appear in a file.
+
+   if(!IsKey(key))
+   {
+      cout<<"WARNING: "<<key<<" is not a parameter of the analysis 'on the fly'."<<endl;
+      return kFALSE;
+   }
+   TEnv env("");
+   env.SetValue(key,value);
+   this->Apply(env);
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyConfig::SetValue(const char *key, const char *value)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyConfig::IsKey(const char *key)
+{
+   // Is key the name of a parameter?
+
+   for(Int_t k=0;fgKeys[k];k++)
+   {
+      if(TString(key) == fgKeys[k]){return kTRUE;}
+   }
+   return kFALSE;
+
+} // end of Bool_t AliFlowOnTheFlyConfig::IsKey(const char *key)
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyConfig::Apply(const TEnv &env)
+{
+   // Take the parameters defined in env; all others keep their value, except for the RP and POI cuts that still
+   // equal the pt or eta range they follow.
+
+   const Double_t dPtMin = fPtMin;
+   const Double_t dPtMax = fPtMax;
+   const Double_t dEtaMin = fEtaMin;
+   const Double_t dEtaMax = fEtaMax;
+   fCClass = env.GetValue("cClass",fCClass);
+   fNEvents = env.GetValue("iNevts",fNEvents);
+   fNThreads = env.GetValue("iNThreads",fNThreads);
+   fEventsPerChunk = env.GetValue("iEventsPerChunk",fEventsPerChunk);
+   fEventsPerBlock = env.GetValue("iEventsPerBlock",fEventsPerBlock);
+   fMinMult = env.GetValue("iMinMult",fMinMult);
+   fMaxMult = env.GetValue("iMaxMult",fMaxMult);
+   fV1 = env.GetValue("dV1",fV1);
+   fV2 = env.GetValue("dV2",fV2);
+   fSameSeed = (env.GetValue("bSameSeed",(Int_t)fSameSeed) != 0);
+   fPtMin = env.GetValue("minPt",fPtMin);
+   fPtMax = env.GetValue("maxPt",fPtMax);
+   fNBinsPt = env.GetValue("ptBins",fNBinsPt);
+   fEtaMin = env.GetValue("minEta",fEtaMin);
+   fEtaMax = env.GetValue("maxEta",fEtaMax);
+   fNBinsEta = env.GetValue("etaBins",fNBinsEta);
+   fPtSubHists = (env.GetValue("ptSubHists",(Int_t)fPtSubHists) != 0);
+   TString sPtCutOffs = env.GetValue("ptCutOffs",fPtCutOffs.Data());
+   if(IsNumberList(sPtCutOffs))
+   {
+      fPtCutOffs = sPtCutOffs;
+   } else
+   {
+      cout<<"WARNING: ptCutOffs \""<<sPtCutOffs.Data()<<"\" is not a list of numbers, ptCutOffs not changed."<<endl;
+   }
+   fNHarmonics = env.GetValue("nHarmonics",fNHarmonics);
+   fNSubsamples = env.GetValue("nSubsamples",fNSubsamples);
+   fBootstrap = (env.GetValue("bBootstrap",(Int_t)fBootstrap) != 0);
+   fUniformEfficiency = (env.GetValue("uniformEfficiency",(Int_t)fUniformEfficiency) != 0);
+   fFoldEfficiency = (env.GetValue("bFoldEfficiency",(Int_t)fFoldEfficiency) != 0);
+   fUseTF1Sampling = (env.GetValue("bUseTF1Sampling",(Int_t)fUseTF1Sampling) != 0);
+   fStreamEvents = (env.GetValue("bStreamEvents",(Int_t)fStreamEvents) != 0);
+   fTablesFile = env.GetValue("sTablesFile",fTablesFile.Data());
+   fTelemetryFile = env.GetValue("sTelemetryFile",fTelemetryFile.Data());
+   fPtMinRP = env.GetValue("ptMinRP",(fPtMinRP == dPtMin ? fPtMin : fPtMinRP));
+   fPtMaxRP = env.GetValue("ptMaxRP",(fPtMaxRP == dPtMax ? fPtMax : fPtMaxRP));
+   fEtaMinRP = env.GetValue("etaMinRP",(fEtaMinRP == dEtaMin ? fEtaMin : fEtaMinRP));
+   fEtaMaxRP = env.GetValue("etaMaxRP",(fEtaMaxRP == dEtaMax ? fEtaMax : fEtaMaxRP));
+   fPhiMinRP = env.GetValue("phiMinRP",fPhiMinRP);
+   fPhiMaxRP = env.GetValue("phiMaxRP",fPhiMaxRP);
+   fUseChargeRP = (env.GetValue("bUseChargeRP",(Int_t)fUseChargeRP) != 0);
+   fChargeRP = env.GetValue("chargeRP",fChargeRP);
+   fPtMinPOI = env.GetValue("ptMinPOI",(fPtMinPOI == dPtMin ? fPtMin : fPtMinPOI));
+   fPtMaxPOI = env.GetValue("ptMaxPOI",(fPtMaxPOI == dPtMax ? fPtMax : fPtMaxPOI));
+   fEtaMinPOI = env.GetValue("etaMinPOI",(fEtaMinPOI == dEtaMin ? fEtaMin : fEtaMinPOI));
+   fEtaMaxPOI = env.GetValue("etaMaxPOI",(fEtaMaxPOI == dEtaMax ? fEtaMax : fEtaMaxPOI));
+   fPhiMinPOI = env.GetValue("phiMinPOI",fPhiMinPOI);
+   fPhiMaxPOI = env.GetValue("phiMaxPOI",fPhiMaxPOI);
+   fUseChargePOI = (env.GetValue("bUseChargePOI",(Int_t)fUseChargePOI) != 0);
+   fChargePOI = env.GetValue("chargePOI",fChargePOI);
+
+} // end of void AliFlowOnTheFlyConfig::Apply(const TEnv &env)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyConfig::IsNumberList(const TString &values)
+{
+   // Are all blank-separated values numbers (which Atof() would otherwise silently read as 0)?
+
+   TObjArray *tokens = values.Tokenize(" \t");
+   Bool_t bNumbers = kTRUE;
+   for(Int_t k=0;k<tokens->GetEntries();k++)
+   {
+      if(!static_cast<TObjString*>(tokens->At(k))->GetString().IsFloat()){bNumbers = kFALSE;}
+   }
+   delete tokens;
+   return bNumbers;
+
+} // end of Bool_t AliFlowOnTheFlyConfig::IsNumberList(const TString &values)
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyConfig::Print() const
+{
+   // One line with the physics parameters of this configuration.
+
+   cout<<" "<<fLabel.Data()<<": cClass "<<fCClass<<", "<<fNEvents<<" events, M in ["<<fMinMult<<","<<fMaxMult<<"), v1 = "<<fV1
+       <<", v2 = "<<fV2<<", pt in ["<<fPtMin<<","<<fPtMax<<"], eta in ["<<fEtaMin<<","<<fEtaMax<<"]"<<endl;
+
+} // end of void AliFlowOnTheFlyConfig::Print() const
+
+//====================================================================================================================
+
+AliFlowEventSimpleMakerOnTheFly_mod* AliFlowOnTheFlyConfig::CreateGenerator(UInt_t uiSeed, const AliFlowOnTheFlyTables *tables) const
+{
+   // A generator set up as in the run macros.
+
+   AliFlowEventSimpleMakerOnTheFly_mod *eventMakerOnTheFly = new AliFlowEventSimpleMakerOnTheFly_mod(uiSeed);
+   eventMakerOnTheFly->SetCClass(fCClass);
+   eventMakerOnTheFly->SetMinMult(fMinMult);
+   eventMakerOnTheFly->SetMaxMult(fMaxMult);
+   eventMakerOnTheFly->SetV1(fV1);
+   eventMakerOnTheFly->SetV2(fV2);
+   eventMakerOnTheFly->SetEtaRange(fEtaMin,fEtaMax);
+   eventMakerOnTheFly->SetPtRange(fPtMin,fPtMax);
+   eventMakerOnTheFly->SetUniformEfficiency(fUniformEfficiency);
+   eventMakerOnTheFly->SetUseTF1Sampling(fUseTF1Sampling);
+   eventMakerOnTheFly->SetFoldEfficiency(fFoldEfficiency);
+   eventMakerOnTheFly->SetTablesFile(fTablesFile.Data());
+   eventMakerOnTheFly->SetTables(tables);
+   eventMakerOnTheFly->SetTelemetryFile(fTelemetryFile.Data());
+   eventMakerOnTheFly->Init();
+   return eventMakerOnTheFly;
+
+} // end of AliFlowEventSimpleMakerOnTheFly_mod* AliFlowOnTheFlyConfig::CreateGenerator(UInt_t uiSeed, const AliFlowOnTheFlyTables *tables) const
+
+//====================================================================================================================
+
+AliFlowAnalysisWithMCEventPlane_mod* AliFlowOnTheFlyConfig::CreateAnalysis() const
+{
+   // An analysis set up as in the run macros.
+
+   AliFlowAnalysisWithMCEventPlane_mod *mcep = new AliFlowAnalysisWithMCEventPlane_mod();
+   mcep->SetPtRange(fPtMin,fPtMax);
+   mcep->SetNbinsPt(fNBinsPt);
+   mcep->SetEtaRange(fEtaMin,fEtaMax);
+   mcep->SetNbinsEta(fNBinsEta);
+   mcep->SetHarmonic(1);
+   Int_t nPtCutOffs = 0;
+   Double_t dPtCutOffs[AliFlowAnalysisWithMCEventPlane_mod::fgMaxPtSlices] = {0.};
+   if(fPtSubHists)
+   {
+      TObjArray *tokens = fPtCutOffs.Tokenize(" \t");
+      for(Int_t k=0;k<tokens->GetEntries() && nPtCutOffs<AliFlowAnalysisWithMCEventPlane_mod::fgMaxPtSlices;k++)
+      {
+         dPtCutOffs[nPtCutOffs++] = static_cast<TObjString*>(tokens->At(k))->GetString().Atof();
+      }
+      delete tokens;
+   }
+   mcep->SetPtSlices(nPtCutOffs,dPtCutOffs); // warns about too many cut-offs
+   mcep->SetNHarmonics(fNHarmonics);
+   mcep->SetNSubsamples(fNSubsamples,fBootstrap);
+   mcep->Init();
+   return mcep;
+
+} // end of AliFlowAnalysisWithMCEventPlane_mod* AliFlowOnTheFlyConfig::CreateAnalysis() const
+
+//====================================================================================================================
+
+AliFlowTrackSimpleCuts* AliFlowOnTheFlyConfig::CreateCutsRP() const
+{
+   // Simple cuts for RPs.
+
+   AliFlowTrackSimpleCuts *cutsRP = new AliFlowTrackSimpleCuts();
+   cutsRP->SetPtMax(fPtMaxRP);
+   cutsRP->SetPtMin(fPtMinRP);
+   cutsRP->SetEtaMax(fEtaMaxRP);
+   cutsRP->SetEtaMin(fEtaMinRP);
+   cutsRP->SetPhiMax(fPhiMaxRP*TMath::Pi()/180.);
+   cutsRP->SetPhiMin(fPhiMinRP*TMath::Pi()/180.);
+   if(fUseChargeRP){cutsRP->SetCharge(fChargeRP);}
+   return cutsRP;
+
+} // end of AliFlowTrackSimpleCuts* AliFlowOnTheFlyConfig::CreateCutsRP() const
+
+//====================================================================================================================
+
+AliFlowTrackSimpleCuts* AliFlowOnTheFlyConfig::CreateCutsPOI() const
+{
+   // Simple cuts for POIs.
+
+   AliFlowTrackSimpleCuts *cutsPOI = new AliFlowTrackSimpleCuts();
+   cutsPOI->SetPtMax(fPtMaxPOI);
+   cutsPOI->SetPtMin(fPtMinPOI);
+   cutsPOI->SetEtaMax(fEtaMaxPOI);
+   cutsPOI->SetEtaMin(fEtaMinPOI);
+   cutsPOI->SetPhiMax(fPhiMaxPOI*TMath::Pi()/180.);
+   cutsPOI->SetPhiMin(fPhiMinPOI*TMath::Pi()/180.);
+   if(fUseChargePOI){cutsPOI->SetCharge(fChargePOI);}
+   return cutsPOI;
+
+} // end of AliFlowTrackSimpleCuts* AliFlowOnTheFlyConfig::CreateCutsPOI() const
@@ -0,0 +1,115 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Run parameters of the analysis   *
+ * 'on the fly', read at runtime    *
+ * from a TEnv file.                *
+ ************************************/
+
+#ifndef ALIFLOWONTHEFLYCONFIG_H
+#define ALIFLOWONTHEFLYCONFIG_H
+
+#include "Rtypes.h"
+#include "TString.h"
+
+class TEnv;
+
+class AliFlowOnTheFlyTables;
+class AliFlowEventSimpleMakerOnTheFly_mod;
+class AliFlowAnalysisWithMCEventPlane_mod;
+class AliFlowTrackSimpleCuts;
+
+// The parameters keep the names of the globals in config.h, and their defaults are the values found there, taken from
+// config.h itself when AliFlowOnTheFlyConfig.cxx is compiled. A file sets any of them, e.g.
+//    cClass: 0
+//    dV1: 0.05
+//    ptMaxRP: 10.
+//    ptCutOffs: 1 2 3 5 8 (arrays as blank-separated values)
+// Parameters that are not given keep their current value. As in config.h (ptMinRP = minPt, ...), the pt and eta cuts
+// of the RPs and POIs follow minPt, maxPt, minEta and maxEta, unless they were given a value of their own.
+class AliFlowOnTheFlyConfig{
+   public:
+      AliFlowOnTheFlyConfig(); // constructor, with the defaults of config.h
+      virtual ~AliFlowOnTheFlyConfig() {} // destructor
+      Bool_t ReadFile(const char *fileName); // take the parameters found in fileName
+      Bool_t SetValue(const char *key, const char *value); // set one parameter from its text form
+      static Bool_t IsKey(const char *key); // is key the name of a parameter?
+      void Print() const;
+      void SetLabel(const char *label) {this->fLabel = label;}
+      const char* GetLabel() const {return this->fLabel.Data();}
+      Int_t GetCClass() const {return this->fCClass;}
+      Int_t GetNEvents() const {return this->fNEvents;}
+      Int_t GetNThreads() const {return this->fNThreads;}
+      Int_t GetEventsPerChunk() const {return this->fEventsPerChunk;}
+      Int_t GetEventsPerBlock() const {return this->fEventsPerBlock;}
+      Bool_t GetSameSeed() const {return this->fSameSeed;}
+      Double_t GetPtMin() const {return this->fPtMin;}
+      Double_t GetPtMax() const {return this->fPtMax;}
+      const char* GetPtCutOffs() const {return this->fPtCutOffs.Data();}
+      Bool_t GetUseTF1Sampling() const {return this->fUseTF1Sampling;}
+      Bool_t GetStreamEvents() const {return this->fStreamEvents;}
+      const char* GetTablesFile() const {return this->fTablesFile.Data();}
+      const char* GetTelemetryFile() const {return this->fTelemetryFile.Data();}
+      // Configured and initialized objects, owned by the caller (tables, if given, are used instead of sTablesFile):
+      AliFlowEventSimpleMakerOnTheFly_mod* CreateGenerator(UInt_t uiSeed, const AliFlowOnTheFlyTables *tables = NULL) const;
+      AliFlowAnalysisWithMCEventPlane_mod* CreateAnalysis() const;
+      AliFlowTrackSimpleCuts* CreateCutsRP() const;
+      AliFlowTrackSimpleCuts* CreateCutsPOI() const;
+
+   private:
+      void Apply(const TEnv &env); // take the parameters defined in env
+      static Bool_t IsNumberList(const TString &values); // blank-separated numbers only?
+      static const char *fgKeys[]; // names of all parameters, NULL-terminated
+      TString fLabel; // name of this configuration, e.g. of its output directory
+      Int_t fCClass; // centrality class: 0 = 10-30%, 1 = 30-50%, 2 = 60-80%
+      Int_t fNEvents; // number of events
+      Int_t fNThreads; // threads, 0: one per core
+      Int_t fEventsPerChunk; // events per unit of work
+      Int_t fEventsPerBlock; // deterministic mode: events per block, 0: off
+      Int_t fMinMult; // multiplicity is >= fMinMult
+      Int_t fMaxMult; // multiplicity is < fMaxMult
+      Double_t fV1; // harmonic v1
+      Double_t fV2; // harmonic v2
+      Bool_t fSameSeed; // fixed seed (kTRUE) or one unique in space and time (kFALSE)
+      Double_t fPtMin; // minimum pt
+      Double_t fPtMax; // maximum pt
+      Int_t fNBinsPt; // pt bins of the result histograms
+      Double_t fEtaMin; // minimum eta
+      Double_t fEtaMax; // maximum eta
+      Int_t fNBinsEta; // eta bins of the result histograms
+      Bool_t fPtSubHists; // v1(eta) profiles per pt slice
+      TString fPtCutOffs; // blank-separated pt values between the slices
+      Int_t fNHarmonics; // harmonics 1, ..., n measured in one pass
+      Int_t fNSubsamples; // subsamples (or replicas) for the errors of v1, 0 for none
+      Bool_t fBootstrap; // bootstrap replicas instead of subsamples
+      Bool_t fUniformEfficiency; // uniform pt efficiency
+      Bool_t fFoldEfficiency; // sample pt from spectrum x efficiency
+      Bool_t fUseTF1Sampling; // sample from the TF1s instead of the tables
+      Bool_t fStreamEvents; // stream the tracks straight into the analysis
+      TString fTablesFile; // precomputed tables (empty: computed in Init())
+      TString fTelemetryFile; // stats file of the live counters (empty: none)
+      Double_t fPtMinRP; // minimum pt of the RPs
+      Double_t fPtMaxRP; // maximum pt of the RPs
+      Double_t fEtaMinRP; // minimum eta of the RPs
+      Double_t fEtaMaxRP; // maximum eta of the RPs
+      Double_t fPhiMinRP; // minimum phi of the RPs, in degrees
+      Double_t fPhiMaxRP; // maximum phi of the RPs, in degrees
+      Bool_t fUseChargeRP; // cut on the charge of the RPs
+      Int_t fChargeRP; // charge of the RPs
+      Double_t fPtMinPOI; // minimum pt of the POIs
+      Double_t fPtMaxPOI; // maximum pt of the POIs
+      Double_t fEtaMinPOI; // minimum eta of the POIs
+      Double_t fEtaMaxPOI; // maximum eta of the POIs
+      Double_t fPhiMinPOI; // minimum phi of the POIs, in degrees
+      Double_t fPhiMaxPOI; // maximum phi of the POIs, in degrees
+      Bool_t fUseChargePOI; // cut on the charge of the POIs
+      Int_t fChargePOI; // charge of the POIs
+
+   ClassDef(AliFlowOnTheFlyConfig,0) // runtime configuration of the analysis 'on the fly'
+};
+
+#endif
@@ -0,0 +1,392 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Multi-threaded driver: creates   *
+ * and analyses events 'on the fly' *
+ * in chunks, with work stealing,   *
+ * or in fixed blocks with results  *
+ * independent of the threads.      *
+ ************************************/
+
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "Riostream.h"
+#include "TROOT.h"
+#include "TMath.h"
+#include "AliFlowEventSimpleMakerOnTheFly_mod.h"
+#include "AliFlowAnalysisWithMCEventPlane_mod.h"
+#include "AliFlowEventBatch.h"
+#include "AliFlowEventView.h"
+#include "AliFlowEventStore.h"
+#include "AliFlowBlockMerger.h"
+#include "AliFlowOnTheFlyRunner.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowOnTheFlyRunner)
+
+//====================================================================================================================
+
+struct AliFlowOnTheFlyRunner::Worker{
+   // Everything one thread touches while running; only fQueue is shared (with thieves), under fMutex.
+   Worker(): fGenerator(NULL), fReader(NULL), fAnalysis(NULL), fBatch(NULL), fNEvents(0), fNStolen(0) {}
+   ~Worker()
+   {
+      if(fGenerator){delete fGenerator;}
+      if(fReader){delete fReader;}
+      if(fAnalysis){delete fAnalysis;}
+      if(fBatch){delete fBatch;}
+   }
+   AliFlowEventSimpleMakerOnTheFly_mod *fGenerator; // generator of this thread (NULL when replaying)
+   AliFlowEventStoreReader *fReader; // reader of the event store of this thread (NULL when generating)
+   AliFlowAnalysisWithMCEventPlane_mod *fAnalysis; // analysis of this thread (NULL in the deterministic mode)
+   AliFlowEventBatch *fBatch; // events of the current chunk
+   std::mutex fMutex; // protects fQueue
+   std::deque<std::pair<Long64_t,Long64_t> > fQueue; // chunks [first,last) still to do: owner takes the front, thieves the back
+   Long64_t fNEvents; // events analysed
+   Long64_t fNStolen; // chunks taken from other workers
+};
+
+//====================================================================================================================
+
+struct AliFlowOnTheFlyRunner::BlockTree{
+   // The analyses of the blocks, merged as a binary tree over the block indices: the node of level L at index i (a
+   // multiple of 2^L) holds the blocks [i,i+2^L) and is merged from its children (L-1,i) and (L-1,i+2^(L-1)), always the
+   // right one into the left one, by the thread that completes the second of them. This is the tree of AliFlowBlockMerger,
+   // walked on the threads, with the same merges. The right node of a merge is reset and takes a later block, so only
+   // as many analyses are booked as blocks are in flight or wait for their siblings at a time.
+   BlockTree(Long64_t nBlocks): fAnalyses(nBlocks,(AliFlowAnalysisWithMCEventPlane_mod*)NULL), fLevels(nBlocks,-1) {}
+   ~BlockTree()
+   {
+      for(UInt_t b=0;b<fAnalyses.size();b++){if(fAnalyses[b]){delete fAnalyses[b];}}
+      for(UInt_t s=0;s<fSpares.size();s++){AliFlowBlockMerger::DeleteNode(fSpares[s]);}
+   }
+   std::mutex fMutex; // protects fAnalyses, fLevels and fSpares, and serializes the creation of analyses (global ROOT state)
+   std::vector<AliFlowAnalysisWithMCEventPlane_mod*> fAnalyses; // analysis of the complete node at the index of its first block
+   std::vector<Int_t> fLevels; // level of the complete node at that index waiting for its sibling, -1 if none
+   std::vector<AliFlowAnalysisWithMCEventPlane_mod*> fSpares; // nodes merged away, reset, for the next blocks
+};
+
+//====================================================================================================================
+
+AliFlowOnTheFlyRunner::AliFlowOnTheFlyRunner(Int_t nThreads):
+   fNThreads(nThreads),
+   fEventsPerChunk(64),
+   fEventsPerBlock(0),
+   fStreamEvents(kTRUE),
+   fReplayFile(""),
+   fCutsRP(NULL),
+   fCutsPOI(NULL),
+   fBlockTree(NULL)
+{
+   // Constructor.
+
+   if(fNThreads <= 0){fNThreads = (Int_t)std::thread::hardware_concurrency();}
+   if(fNThreads <= 0){fNThreads = 1;}
+
+} // end of AliFlowOnTheFlyRunner::AliFlowOnTheFlyRunner(Int_t nThreads)
+
+//====================================================================================================================
+
+AliFlowOnTheFlyRunner::~AliFlowOnTheFlyRunner()
+{
+   // Destructor.
+
+   this->Clear();
+
+} // end of AliFlowOnTheFlyRunner::~AliFlowOnTheFlyRunner()
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyRunner::Clear()
+{
+   // Delete the workers of the previous Run().
+
+   for(UInt_t w=0;w<fWorkers.size();w++){delete fWorkers[w];}
+   fWorkers.clear();
+   if(fBlockTree){delete fBlockTree;}
+   fBlockTree = NULL;
+
+} // end of void AliFlowOnTheFlyRunner::Clear()
+
+//====================================================================================================================
+
+AliFlowAnalysisWithMCEventPlane_mod* AliFlowOnTheFlyRunner::Run(Long64_t nEvents)
+{
+   // Create (or replay) and analyse nEvents events on fNThreads threads (on one, for this Run() only, with TF1 sampling).
+
+   // a) Create the generator (or event store reader) and analysis of every worker (serially: Init() touches global ROOT state);
+   // b) Deal out the chunks in contiguous ranges, one range per worker (in the deterministic mode, every chunk is a block);
+   // c) Run the workers; a worker that runs out of chunks steals from the back of the others' queues;
+   // d) Merge the analyses of all workers pairwise into the first one (in the deterministic mode, the blocks are merged already).
+
+   Bool_t bReplay = !fReplayFile.IsNull();
+   if((!fGeneratorFactory && !bReplay) || !fAnalysisFactory || !fCutsRP || !fCutsPOI)
+   {
+      cout<<"WARNING: AliFlowOnTheFlyRunner needs a generator factory or replay file, an analysis factory and cuts, nothing done."<<endl;
+      return NULL;
+   }
+   ROOT::EnableThreadSafety();
+
+   // a) Create the generator and analysis of every worker (fWorkers holds one per thread of this Run()):
+   this->Clear();
+   Int_t nThreads = fNThreads;
+   for(Int_t w=0;w<nThreads;w++)
+   {
+      Worker *pWorker = new Worker();
+      if(fEventsPerBlock <= 0){pWorker->fAnalysis = fAnalysisFactory();} // else one per block, reused once merged away
+      pWorker->fBatch = new AliFlowEventBatch();
+      fWorkers.push_back(pWorker);
+      if(bReplay)
+      {
+         // Every thread reads and unzips its own chunks through its own file handle:
+         pWorker->fReader = new AliFlowEventStoreReader();
+         if(!pWorker->fReader->Open(fReplayFile.Data())){return NULL;}
+         if(nEvents <= 0 || nEvents > pWorker->fReader->GetEntries()){nEvents = pWorker->fReader->GetEntries();}
+         continue;
+      }
+      pWorker->fGenerator = fGeneratorFactory();
+      if(w == 0 && pWorker->fGenerator->GetUseTF1Sampling() && nThreads > 1)
+      {
+         // TF1::GetRandom() draws from the global gRandom, which threads cannot share:
+         cout<<"WARNING: TF1 sampling is not thread safe, running on 1 thread."<<endl;
+         nThreads = 1;
+      }
+      if(pWorker->fGenerator->GetSeed() != fWorkers[0]->fGenerator->GetSeed())
+      {
+         cout<<"WARNING: the generators of the workers have different seeds, the result depends on the scheduling."<<endl;
+      }
+   }
+
+   // b) Deal out the chunks:
+   Long64_t nPerChunk = (fEventsPerBlock > 0 ? fEventsPerBlock : fEventsPerChunk);
+   Long64_t nChunks = (nEvents+nPerChunk-1)/nPerChunk;
+   Long64_t nPerWorker = (nChunks+nThreads-1)/nThreads;
+   if(fEventsPerBlock > 0){fBlockTree = new BlockTree(TMath::Max(nChunks,(Long64_t)1));}
+   for(Long64_t c=0;c<nChunks;c++)
+   {
+      Long64_t first = c*nPerChunk;
+      Long64_t last = TMath::Min(first+nPerChunk,nEvents);
+      fWorkers[c/nPerWorker]->fQueue.push_back(std::make_pair(first,last));
+   }
+
+   // c) Run the workers:
+   std::vector<std::thread> threads;
+   for(Int_t w=1;w<nThreads;w++){threads.push_back(std::thread(&AliFlowOnTheFlyRunner::Work,this,w));}
+   this->Work(0);
+   for(UInt_t t=0;t<threads.size();t++){threads[t].join();}
+
+   // d) Merge:
+   if(fBlockTree)
+   {
+      if(!fBlockTree->fAnalyses[0]){fBlockTree->fAnalyses[0] = fAnalysisFactory();} // no events: the empty histograms
+      return fBlockTree->fAnalyses[0];
+   }
+   std::vector<AliFlowAnalysisWithMCEventPlane_mod*> analyses;
+   for(Int_t w=0;w<nThreads;w++){analyses.push_back(fWorkers[w]->fAnalysis);}
+
+   return MergeTree(analyses,kTRUE);
+
+} // end of AliFlowAnalysisWithMCEventPlane_mod* AliFlowOnTheFlyRunner::Run(Long64_t nEvents)
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyRunner::Work(Int_t iThread)
+{
+   // Event loop of one thread. Events are keyed by their global index, so the events do not depend on which
+   // thread ends up creating which chunk; in the deterministic mode, neither does the order of the sums.
+
+   Worker *pWorker = fWorkers[iThread];
+   AliFlowEventView view;
+   Long64_t first = 0;
+   Long64_t last = 0;
+   while(this->NextChunk(iThread,first,last))
+   {
+      Int_t nEvents = (Int_t)(last-first);
+      AliFlowAnalysisWithMCEventPlane_mod *pAnalysis = pWorker->fAnalysis;
+      if(fBlockTree)
+      {
+         std::lock_guard<std::mutex> lock(fBlockTree->fMutex);
+         if(fBlockTree->fSpares.empty())
+         {
+            pAnalysis = fAnalysisFactory();
+         } else
+         {
+            pAnalysis = fBlockTree->fSpares.back();
+            fBlockTree->fSpares.pop_back();
+         }
+      }
+      if(pWorker->fReader && fStreamEvents)
+      {
+         nEvents = pWorker->fReader->ReplayEvents(first,nEvents,fCutsRP,fCutsPOI,pAnalysis->GetSink());
+      } else if(pWorker->fReader)
+      {
+         pWorker->fBatch->Clear();
+         nEvents = pWorker->fReader->ReadEvents(first,nEvents,fCutsRP,fCutsPOI,pWorker->fBatch);
+      } else if(fStreamEvents)
+      {
+         pWorker->fGenerator->SetEventIndex(first);
+         pWorker->fGenerator->CreateEventsStreamed(nEvents,fCutsRP,fCutsPOI,pAnalysis->GetSink());
+      } else
+      {
+         pWorker->fGenerator->SetEventIndex(first);
+         pWorker->fGenerator->CreateEventsBatch(nEvents,fCutsRP,fCutsPOI,pWorker->fBatch);
+      }
+      pWorker->fNEvents += nEvents; // those read from the event store, which can be fewer than asked for
+      for(Int_t e=0;e<nEvents && !fStreamEvents;e++)
+      {
+         view.Set(*pWorker->fBatch,e);
+         pAnalysis->Make(view);
+      }
+      if(fBlockTree)
+      {
+         pAnalysis->FlushAccumulators(); // the nodes are merged flushed, see AliFlowBlockMerger::MergeNodes()
+         this->FinishBlock(first/fEventsPerBlock,pAnalysis);
+      }
+   }
+
+} // end of void AliFlowOnTheFlyRunner::Work(Int_t iThread)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyRunner::NextChunk(Int_t iThread, Long64_t &first, Long64_t &last)
+{
+   // Take the next chunk of thread iThread, or steal the last chunk of another thread. No chunks are added
+   // while running, so once all queues are seen empty there is nothing left to do.
+
+   const Int_t nThreads = (Int_t)fWorkers.size();
+   Worker *pOwn = fWorkers[iThread];
+   {
+      std::lock_guard<std::mutex> lock(pOwn->fMutex);
+      if(!pOwn->fQueue.empty())
+      {
+         first = pOwn->fQueue.front().first;
+         last = pOwn->fQueue.front().second;
+         pOwn->fQueue.pop_front();
+         return kTRUE;
+      }
+   }
+   for(Int_t v=1;v<nThreads;v++)
+   {
+      Worker *pVictim = fWorkers[(iThread+v) % nThreads];
+      std::lock_guard<std::mutex> lock(pVictim->fMutex);
+      if(!pVictim->fQueue.empty())
+      {
+         first = pVictim->fQueue.back().first;
+         last = pVictim->fQueue.back().second;
+         pVictim->fQueue.pop_back();
+         pOwn->fNStolen++;
+         return kTRUE;
+      }
+   }
+   return kFALSE;
+
+} // end of Bool_t AliFlowOnTheFlyRunner::NextChunk(Int_t iThread, Long64_t &first, Long64_t &last)
+
+//====================================================================================================================
+
+AliFlowAnalysisWithMCEventPlane_mod* AliFlowOnTheFlyRunner::MergeTree(const std::vector<AliFlowAnalysisWithMCEventPlane_mod*> &analyses, Bool_t bParallel)
+{
+   // Merge analysis i+stride into analysis i for stride = 1, 2, 4, ...: every analysis takes part in log2(n) merges
+   // at most, so the total cost is (n-1) merges of the bins but the time only log2(n) of them on parallel threads.
+   // The order of the additions is fixed by n alone, not by the scheduling.
+
+   if(analyses.empty()){return NULL;}
+   for(UInt_t stride=1;stride<analyses.size();stride*=2)
+   {
+      std::vector<std::thread> threads;
+      for(UInt_t i=0;i+stride<analyses.size();i+=2*stride)
+      {
+         if(bParallel)
+         {
+            threads.push_back(std::thread([&analyses,i,stride](){analyses[i]->Merge(*analyses[i+stride]);}));
+         } else
+         {
+            analyses[i]->Merge(*analyses[i+stride]);
+         }
+      }
+      for(UInt_t t=0;t<threads.size();t++){threads[t].join();}
+   }
+   return analyses[0];
+
+} // end of AliFlowAnalysisWithMCEventPlane_mod* AliFlowOnTheFlyRunner::MergeTree(const std::vector<AliFlowAnalysisWithMCEventPlane_mod*> &analyses, Bool_t bParallel)
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyRunner::FinishBlock(Long64_t iBlock, AliFlowAnalysisWithMCEventPlane_mod *analysis)
+{
+   // Deterministic mode: hand the analysis of block iBlock to the tree, merging it up for as long as the sibling node
+   // is complete; a node whose sibling is not is left for the sibling's thread. The root ends up at index 0.
+
+   Long64_t nBlocks = (Long64_t)fBlockTree->fAnalyses.size();
+   Long64_t i = iBlock; // index of the node of analysis, i.e. of its first block
+   for(Int_t level=0;((Long64_t)1<<level)<nBlocks;level++)
+   {
+      Long64_t width = (Long64_t)1<<level;
+      Bool_t bLeft = ((i/width)%2 == 0);
+      Long64_t iSibling = (bLeft ? i+width : i-width);
+      if(iSibling >= nBlocks){continue;} // no right sibling: the node goes up as it is
+      AliFlowAnalysisWithMCEventPlane_mod *pSibling = NULL;
+      {
+         std::lock_guard<std::mutex> lock(fBlockTree->fMutex);
+         if(fBlockTree->fLevels[iSibling] != level)
+         {
+            fBlockTree->fAnalyses[i] = analysis;
+            fBlockTree->fLevels[i] = level;
+            return;
+         }
+         pSibling = fBlockTree->fAnalyses[iSibling];
+         fBlockTree->fAnalyses[iSibling] = NULL;
+         fBlockTree->fLevels[iSibling] = -1;
+      }
+      AliFlowAnalysisWithMCEventPlane_mod *pLeft = (bLeft ? analysis : pSibling);
+      AliFlowAnalysisWithMCEventPlane_mod *pRight = (bLeft ? pSibling : analysis);
+      AliFlowBlockMerger::MergeNodes(pLeft,pRight);
+      pRight->ResetHistograms(); // as new, for a later block
+      {
+         std::lock_guard<std::mutex> lock(fBlockTree->fMutex);
+         fBlockTree->fSpares.push_back(pRight);
+      }
+      analysis = pLeft;
+      i = TMath::Min(i,iSibling);
+   }
+   fBlockTree->fAnalyses[0] = analysis; // the root: all blocks are merged
+
+} // end of void AliFlowOnTheFlyRunner::FinishBlock(Long64_t iBlock, AliFlowAnalysisWithMCEventPlane_mod *analysis)
+
+//====================================================================================================================
+
+Long64_t AliFlowOnTheFlyRunner::GetNumberOfEvents(Int_t iThread) const
+{
+   // Events analysed by thread iThread in the last Run().
+
+   return (iThread < (Int_t)fWorkers.size() ? fWorkers[iThread]->fNEvents : 0);
+
+} // end of Long64_t AliFlowOnTheFlyRunner::GetNumberOfEvents(Int_t iThread) const
+
+//====================================================================================================================
+
+Long64_t AliFlowOnTheFlyRunner::GetNumberOfStolenChunks(Int_t iThread) const
+{
+   // Chunks thread iThread took from other threads in the last Run().
+
+   return (iThread < (Int_t)fWorkers.size() ? fWorkers[iThread]->fNStolen : 0);
+
+} // end of Long64_t AliFlowOnTheFlyRunner::GetNumberOfStolenChunks(Int_t iThread) const
+
+//====================================================================================================================
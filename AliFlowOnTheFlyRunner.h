@@ -0,0 +1,85 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Multi-threaded driver: creates   *
+ * and analyses events 'on the fly' *
+ * in chunks, with work stealing,   *
+ * or in fixed blocks with results  *
+ * independent of the threads.      *
+ ************************************/
+
+#ifndef ALIFLOWONTHEFLYRUNNER_H
+#define ALIFLOWONTHEFLYRUNNER_H
+
+#include <vector>
+#include <functional>
+
+#include "Rtypes.h"
+#include "TString.h"
+
+class AliFlowEventSimpleMakerOnTheFly_mod;
+class AliFlowAnalysisWithMCEventPlane_mod;
+class AliFlowTrackSimpleCuts;
+
+class AliFlowOnTheFlyRunner{
+   public:
+      // Create one configured and initialized generator (all with the same seed) or analysis:
+      typedef std::function<AliFlowEventSimpleMakerOnTheFly_mod*()> GeneratorFactory;
+      typedef std::function<AliFlowAnalysisWithMCEventPlane_mod*()> AnalysisFactory;
+
+      AliFlowOnTheFlyRunner(Int_t nThreads = 0); // constructor, 0 threads = one per core
+      virtual ~AliFlowOnTheFlyRunner(); // destructor
+      void SetGeneratorFactory(GeneratorFactory gf) {this->fGeneratorFactory = gf;}
+      void SetAnalysisFactory(AnalysisFactory af) {this->fAnalysisFactory = af;}
+      void SetCuts(AliFlowTrackSimpleCuts const *cutsRP, AliFlowTrackSimpleCuts const *cutsPOI) {this->fCutsRP = cutsRP; this->fCutsPOI = cutsPOI;}
+      void SetEventsPerChunk(Int_t n) {this->fEventsPerChunk = n;}
+      void SetStreamEvents(Bool_t se) {this->fStreamEvents = se;} // stream the tracks straight into the analysis
+      Bool_t GetStreamEvents() const {return this->fStreamEvents;}
+      // Analyse the events of an AliFlowEventStoreWriter file under the cuts of SetCuts() instead of generating them:
+      void SetReplayFile(const char *fileName) {this->fReplayFile = fileName;}
+      const char* GetReplayFile() const {return this->fReplayFile.Data();}
+      Int_t GetEventsPerChunk() const {return this->fEventsPerChunk;}
+      // Deterministic mode for n > 0: every block of n events is the unit of work and is analysed into its own analysis; the blocks are merged
+      // in a tree fixed by their number alone, so the result is bit-identical on any number of threads (0, the default: off):
+      void SetEventsPerBlock(Int_t n) {this->fEventsPerBlock = n;}
+      Int_t GetEventsPerBlock() const {return this->fEventsPerBlock;}
+      Int_t GetNumberOfThreads() const {return this->fNThreads;}
+      // Create (or replay) and analyse events [0,nEvents); nEvents <= 0 replays all stored events. Returns the analysis of the first worker with the histograms of
+      // all others merged into it (owned by the runner); Finish() is left to the caller.
+      AliFlowAnalysisWithMCEventPlane_mod* Run(Long64_t nEvents);
+      Long64_t GetNumberOfEvents(Int_t iThread) const; // events analysed by thread iThread in the last Run()
+      Long64_t GetNumberOfStolenChunks(Int_t iThread) const; // chunks thread iThread took from other threads
+      // Merge the analyses, booked alike, pairwise in a tree of depth log2(n) into the first one, which is returned;
+      // the pairs of one level are merged on parallel threads if bParallel, their histograms one pair at a time under the ROOT
+      // mutex (see AliFlowAnalysisWithMCEventPlane_mod::Merge()) and their flat accumulators in parallel (also used by AliFlowOnTheFlyScan):
+      static AliFlowAnalysisWithMCEventPlane_mod* MergeTree(const std::vector<AliFlowAnalysisWithMCEventPlane_mod*> &analyses, Bool_t bParallel);
+
+   private:
+      AliFlowOnTheFlyRunner(const AliFlowOnTheFlyRunner& aRunner); // copy constructor
+      AliFlowOnTheFlyRunner& operator=(const AliFlowOnTheFlyRunner& aRunner); // assignment operator
+      struct Worker; // generator, analysis and chunk queue of one thread
+      struct BlockTree; // deterministic mode: analyses of the blocks, merged as they complete
+      void Clear();
+      void Work(Int_t iThread);
+      Bool_t NextChunk(Int_t iThread, Long64_t &first, Long64_t &last);
+      void FinishBlock(Long64_t iBlock, AliFlowAnalysisWithMCEventPlane_mod *analysis);
+      Int_t fNThreads; // number of worker threads
+      Int_t fEventsPerChunk; // events per unit of work
+      Int_t fEventsPerBlock; // events per block in the deterministic mode (0: off)
+      Bool_t fStreamEvents; // stream the events into the analysis instead of storing them in fBatch first
+      TString fReplayFile; // event store to replay (empty: generate the events)
+      GeneratorFactory fGeneratorFactory; // creates the generator of each worker
+      AnalysisFactory fAnalysisFactory; // creates the analysis of each worker
+      AliFlowTrackSimpleCuts const *fCutsRP; // RP cuts, shared read-only by all workers
+      AliFlowTrackSimpleCuts const *fCutsPOI; // POI cuts, shared read-only by all workers
+      std::vector<Worker*> fWorkers; // one per thread
+      BlockTree *fBlockTree; // deterministic mode only (NULL otherwise)
+
+   ClassDef(AliFlowOnTheFlyRunner,0) // multi-threaded driver for the analysis 'on the fly'
+};
+
+#endif
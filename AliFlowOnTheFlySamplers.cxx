@@ -0,0 +1,383 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Fast samplers used by the flow   *
+ * event maker 'on the fly'.        *
+ ************************************/
+
+#include "TMath.h"
+#include "TF1.h"
+#include "AliFlowSIMD.h"
+#include "AliFlowOnTheFlySamplers.h"
+
+ClassImp(AliFlowPtSampler)
+ClassImp(AliFlowPhiSampler)
+ClassImp(AliFlowEtaSampler)
+
+//====================================================================================================================
+
+AliFlowPtSampler::AliFlowPtSampler():
+   fNPoints(0),
+   fPtMin(0.),
+   fPtMax(0.),
+   fStep(0.),
+   fIntegral(0.),
+   fCDF(NULL),
+   fGuide(NULL),
+   fOwner(kTRUE)
+{
+   // Constructor.
+
+} // end of AliFlowPtSampler::AliFlowPtSampler()
+
+//====================================================================================================================
+
+AliFlowPtSampler::~AliFlowPtSampler()
+{
+   // Destructor.
+
+   this->Clear();
+
+} // end of AliFlowPtSampler::~AliFlowPtSampler()
+
+//====================================================================================================================
+
+void AliFlowPtSampler::Clear()
+{
+   // Release the tables.
+
+   if(fOwner && fCDF){delete [] fCDF;}
+   if(fOwner && fGuide){delete [] fGuide;}
+   fCDF = NULL;
+   fGuide = NULL;
+   fOwner = kTRUE;
+   fNPoints = 0;
+   fIntegral = 0.;
+
+} // end of void AliFlowPtSampler::Clear()
+
+//====================================================================================================================
+
+void AliFlowPtSampler::Build(TF1 *spectrum, Double_t ptMin, Double_t ptMax, Int_t nPoints)
+{
+   // Tabulate the spectrum on a uniform grid of nPoints intervals in [ptMin,ptMax] and build the inverse CDF.
+
+   Double_t *pdf = new Double_t[nPoints+1];
+   Double_t dStep = (ptMax-ptMin)/nPoints;
+   for(Int_t k=0;k<=nPoints;k++)
+   {
+      pdf[k] = spectrum->Eval(ptMin+k*dStep);
+   }
+   this->Build(ptMin,ptMax,nPoints,pdf);
+   delete [] pdf;
+
+} // end of void AliFlowPtSampler::Build(TF1 *spectrum, Double_t ptMin, Double_t ptMax, Int_t nPoints)
+
+//====================================================================================================================
+
+void AliFlowPtSampler::Build(Double_t ptMin, Double_t ptMax, Int_t nPoints, const Double_t *pdf)
+{
+   // Build the normalized CDF (trapezoidal rule) and its guide table from nPoints+1 pdf values on a uniform grid.
+   // Non-finite or negative pdf values (e.g. log(0) of the R_AA term at pt = 0) are treated as zero.
+
+   this->Clear();
+   fNPoints = nPoints;
+   fPtMin = ptMin;
+   fPtMax = ptMax;
+   fStep = (ptMax-ptMin)/nPoints;
+   Double_t *cdf = new Double_t[nPoints+1];
+
+   cdf[0] = 0.;
+   Double_t dPrevious = (TMath::Finite(pdf[0]) && pdf[0] > 0. ? pdf[0] : 0.);
+   for(Int_t k=1;k<=nPoints;k++)
+   {
+      Double_t dCurrent = (TMath::Finite(pdf[k]) && pdf[k] > 0. ? pdf[k] : 0.);
+      cdf[k] = cdf[k-1] + 0.5*(dPrevious+dCurrent)*fStep;
+      dPrevious = dCurrent;
+   }
+   this->Normalize(cdf);
+
+} // end of void AliFlowPtSampler::Build(Double_t ptMin, Double_t ptMax, Int_t nPoints, const Double_t *pdf)
+
+//====================================================================================================================
+
+void AliFlowPtSampler::BuildFolded(Double_t ptMin, Double_t ptMax, Int_t nPoints, const Double_t *pdf, Int_t nBins, const Double_t *bins)
+{
+   // Build the CDF of pdf (given as for Build()) times the step efficiency of bins. Every grid interval is split at the
+   // bin edges inside it and each part integrated (trapezoidal rule, pdf interpolated linearly) with its own efficiency,
+   // so the steps cost no accuracy: the CDF at the grid points is that of the exact folded density, up to the same
+   // trapezoidal error as Build(). Only inside an interval that contains an edge does Sample() still spread the tracks
+   // uniformly, i.e. a track can move by less than one grid step (none if the edges are grid points, as for the
+   // built-in efficiencies on the default grid).
+
+   this->Clear();
+   fNPoints = nPoints;
+   fPtMin = ptMin;
+   fPtMax = ptMax;
+   fStep = (ptMax-ptMin)/nPoints;
+   Double_t *cdf = new Double_t[nPoints+1];
+
+   cdf[0] = 0.;
+   Int_t b = 0; // first bin whose upper edge is above the lower end of the interval
+   Double_t dPrevious = (TMath::Finite(pdf[0]) && pdf[0] > 0. ? pdf[0] : 0.);
+   for(Int_t k=1;k<=nPoints;k++)
+   {
+      Double_t dCurrent = (TMath::Finite(pdf[k]) && pdf[k] > 0. ? pdf[k] : 0.);
+      Double_t dLow = ptMin+(k-1)*fStep;
+      Double_t dHigh = (k == nPoints ? ptMax : ptMin+k*fStep);
+      Double_t dIntegral = 0.;
+      while(b < nBins && bins[2*b] <= dLow){b++;}
+      for(Double_t x=dLow;x<dHigh;)
+      {
+         Double_t dEdge = (b < nBins && bins[2*b] < dHigh ? bins[2*b] : dHigh);
+         Double_t dEfficiency = (b < nBins ? bins[2*b+1] : 1.);
+         Double_t dPdfLow = dPrevious+(dCurrent-dPrevious)*(x-dLow)/fStep;
+         Double_t dPdfHigh = dPrevious+(dCurrent-dPrevious)*(dEdge-dLow)/fStep;
+         dIntegral += 0.5*(dPdfLow+dPdfHigh)*(dEdge-x)*dEfficiency;
+         x = dEdge;
+         if(dEdge < dHigh){b++;}
+      }
+      cdf[k] = cdf[k-1] + dIntegral;
+      dPrevious = dCurrent;
+   }
+   this->Normalize(cdf);
+
+} // end of void AliFlowPtSampler::BuildFolded(Double_t ptMin, Double_t ptMax, Int_t nPoints, const Double_t *pdf, Int_t nBins, const Double_t *bins)
+
+//====================================================================================================================
+
+void AliFlowPtSampler::Normalize(Double_t *cdf)
+{
+   // Normalize the cumulative integrals cdf[0..fNPoints] of Build() and build the guide table; takes over cdf.
+
+   const Int_t nPoints = fNPoints;
+   Int_t *guide = new Int_t[nPoints+1];
+   fIntegral = cdf[nPoints];
+   if(fIntegral <= 0.)
+   {
+      // Degenerate spectrum, fall back to a flat distribution:
+      for(Int_t k=0;k<=nPoints;k++){cdf[k] = (Double_t)k/nPoints;}
+   } else
+   {
+      for(Int_t k=0;k<=nPoints;k++){cdf[k] /= fIntegral;}
+   }
+   cdf[nPoints] = 1.;
+
+   // Guide table, so that Sample() needs on average O(1) steps:
+   Int_t k = 0;
+   for(Int_t j=0;j<=nPoints;j++)
+   {
+      Double_t u = (Double_t)j/nPoints;
+      while(k < nPoints-1 && cdf[k+1] < u){k++;}
+      guide[j] = k;
+   }
+   fCDF = cdf;
+   fGuide = guide;
+
+} // end of void AliFlowPtSampler::Normalize(Double_t *cdf)
+
+//====================================================================================================================
+
+void AliFlowPtSampler::Attach(Double_t ptMin, Double_t ptMax, Int_t nPoints, Double_t dIntegral, const Double_t *cdf, const Int_t *guide)
+{
+   // Sample from tables made by Build() elsewhere, without copying them.
+
+   this->Clear();
+   fNPoints = nPoints;
+   fPtMin = ptMin;
+   fPtMax = ptMax;
+   fStep = (ptMax-ptMin)/nPoints;
+   fIntegral = dIntegral;
+   fCDF = cdf;
+   fGuide = guide;
+   fOwner = kFALSE;
+
+} // end of void AliFlowPtSampler::Attach(Double_t ptMin, Double_t ptMax, Int_t nPoints, Double_t dIntegral, const Double_t *cdf, const Int_t *guide)
+
+//====================================================================================================================
+
+ALIFLOW_SIMD_CLONES
+void AliFlowPtSampler::SampleArray(Int_t n, const Double_t *u, Double_t *pt) const
+{
+   // Vectorizable version of Sample(): guide table lookup followed by two branch-free steps, which is enough
+   // for almost all u. The few samples that need more steps are redone with Sample() afterwards (u is still
+   // needed then, so pt must not alias u).
+
+   const Double_t *cdf = fCDF;
+   const Int_t *guide = fGuide;
+   const Int_t nLast = fNPoints-1;
+   Int_t nSlow = 0;
+   for(Int_t i=0;i<n;i++)
+   {
+      Double_t dU = u[i];
+      Int_t k = guide[(Int_t)(dU*fNPoints)];
+      k += (k < nLast && cdf[k+1] < dU);
+      k += (k < nLast && cdf[k+1] < dU);
+      nSlow += (k < nLast && cdf[k+1] < dU);
+      Double_t dCDF = cdf[k+1]-cdf[k];
+      Double_t t = (dCDF > 0. ? (dU-cdf[k])/dCDF : 0.);
+      pt[i] = fPtMin + (k+t)*fStep;
+   }
+   if(nSlow == 0){return;}
+   for(Int_t i=0;i<n;i++)
+   {
+      Int_t k = guide[(Int_t)(u[i]*fNPoints)];
+      if(k+2 < nLast && cdf[k+3] < u[i]){pt[i] = this->Sample(u[i]);}
+   }
+
+} // end of void AliFlowPtSampler::SampleArray(Int_t n, const Double_t *u, Double_t *pt) const
+
+//====================================================================================================================
+
+AliFlowPhiSampler::AliFlowPhiSampler(Double_t dV2):
+   fV2(dV2),
+   fTwoPi(TMath::TwoPi())
+{
+   // Constructor.
+
+} // end of AliFlowPhiSampler::AliFlowPhiSampler(Double_t dV2)
+
+//====================================================================================================================
+
+ALIFLOW_SIMD_CLONES
+void AliFlowPhiSampler::Propose(Int_t n, const Double_t *u, const Double_t *v1, Double_t v2, Double_t *phi, UChar_t *accept)
+{
+   // One accept-reject round for n tracks: u holds 2n uniform numbers (first n for the angles, then n for the test).
+
+   const Double_t dTwoPi = TMath::TwoPi();
+   const Double_t dAbsV2 = TMath::Abs(v2);
+   for(Int_t i=0;i<n;i++)
+   {
+      Double_t dPhi = dTwoPi*u[i];
+      Double_t dCos = CosTwoPi(u[i]);
+      Double_t dEnvelope = 1.+2.*TMath::Abs(v1[i])+2.*dAbsV2;
+      phi[i] = dPhi;
+      accept[i] = (dEnvelope*u[n+i] <= 1.+2.*v1[i]*dCos+2.*v2*(2.*dCos*dCos-1.));
+   }
+
+} // end of void AliFlowPhiSampler::Propose(Int_t n, const Double_t *u, const Double_t *v1, Double_t v2, Double_t *phi, UChar_t *accept)
+
+//====================================================================================================================
+
+void AliFlowPhiSampler::SampleArray(Int_t n, const Double_t *v1, Double_t psi, TRandom *random, Double_t *phi)
+{
+   // Accept-reject for all n tracks at once; the rejected ones are compacted and retried in the next round.
+
+   if((Int_t)fPending.size() < n)
+   {
+      fU.resize(2*n);
+      fCandidate.resize(n);
+      fAccept.resize(n);
+      fPendingV1.resize(n);
+      fPending.resize(n);
+   }
+   for(Int_t i=0;i<n;i++)
+   {
+      fPending[i] = i;
+      fPendingV1[i] = v1[i];
+   }
+   Int_t nPending = n;
+   while(nPending > 0)
+   {
+      random->RndmArray(2*nPending,&fU[0]);
+      Propose(nPending,&fU[0],&fPendingV1[0],fV2,&fCandidate[0],&fAccept[0]);
+      Int_t nLeft = 0;
+      for(Int_t j=0;j<nPending;j++)
+      {
+         if(fAccept[j])
+         {
+            Double_t dPhi = fCandidate[j]+psi;
+            if(dPhi >= fTwoPi){dPhi -= fTwoPi;}
+            phi[fPending[j]] = dPhi;
+         } else
+         {
+            fPending[nLeft] = fPending[j];
+            fPendingV1[nLeft] = fPendingV1[j];
+            nLeft++;
+         }
+      }
+      nPending = nLeft;
+   }
+
+} // end of void AliFlowPhiSampler::SampleArray(Int_t n, const Double_t *v1, Double_t psi, TRandom *random, Double_t *phi)
+
+//====================================================================================================================
+
+AliFlowEtaSampler::AliFlowEtaSampler(Double_t dCoefficient, Double_t etaMin, Double_t etaMax):
+   fCoefficient(0.),
+   fEtaMin(0.),
+   fEtaMax(0.),
+   fShape(0),
+   fSqrtA(0.),
+   fScale(0.),
+   fCMin(0.),
+   fCRange(0.),
+   fTwoPiOver3(TMath::TwoPi()/3.),
+   fNNewtonSteps(0)
+{
+   // Constructor.
+
+   this->Set(dCoefficient,etaMin,etaMax);
+
+} // end of AliFlowEtaSampler::AliFlowEtaSampler(Double_t dCoefficient, Double_t etaMin, Double_t etaMax)
+
+//====================================================================================================================
+
+void AliFlowEtaSampler::Set(Double_t dCoefficient, Double_t etaMin, Double_t etaMax)
+{
+   // Precompute everything needed by Sample(). For a < 0 the density must stay positive, i.e. |a|*eta^2 < 1 in range.
+
+   fCoefficient = dCoefficient;
+   fEtaMin = etaMin;
+   fEtaMax = etaMax;
+   fShape = 0;
+   if(TMath::Abs(dCoefficient) > 1.e-12){fShape = (dCoefficient > 0. ? 1 : -1);}
+   fSqrtA = TMath::Sqrt(TMath::Abs(dCoefficient));
+   fScale = (fShape != 0 ? 2./fSqrtA : 0.);
+   fCMin = etaMin+dCoefficient*etaMin*etaMin*etaMin/3.;
+   fCRange = etaMax+dCoefficient*etaMax*etaMax*etaMax/3.-fCMin;
+   for(Int_t k=0;k<=fgNTable;k++){fTable[k] = this->Sample((Double_t)k/fgNTable);}
+
+   // As many Newton steps as the middle of the worst interval of fTable needs, and one more to spare:
+   fNNewtonSteps = 0;
+   for(Int_t k=0;k<fgNTable && fShape!=0;k++)
+   {
+      Double_t dU = (k+0.5)/fgNTable;
+      Double_t dEta = this->Sample(dU);
+      while(fNNewtonSteps < fgMaxNewtonSteps && TMath::Abs(this->Refine(dU,fNNewtonSteps)-dEta) > 1.e-14*TMath::Max(1.,TMath::Abs(dEta))){fNNewtonSteps++;}
+   }
+   fNNewtonSteps = TMath::Min(fNNewtonSteps+1,fgMaxNewtonSteps);
+
+} // end of void AliFlowEtaSampler::Set(Double_t dCoefficient, Double_t etaMin, Double_t etaMax)
+
+//====================================================================================================================
+
+ALIFLOW_SIMD_CLONES
+void AliFlowEtaSampler::SampleArray(Int_t n, const Double_t *u, Double_t *eta) const
+{
+   // Sample() without a libm call per element, so that the loop vectorizes: linear interpolation in fTable, then the
+   // same number of Newton steps for all elements, which converge quadratically from there.
+
+   if(fShape == 0)
+   {
+      for(Int_t i=0;i<n;i++){eta[i] = fCMin+u[i]*fCRange;}
+      return;
+   }
+   for(Int_t i=0;i<n;i++){eta[i] = this->Refine(u[i],fNNewtonSteps);}
+
+} // end of void AliFlowEtaSampler::SampleArray(Int_t n, const Double_t *u, Double_t *eta) const
+
+//====================================================================================================================
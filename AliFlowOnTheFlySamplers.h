@@ -0,0 +1,184 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Fast samplers used by the flow   *
+ * event maker 'on the fly'.        *
+ ************************************/
+
+#ifndef ALIFLOWONTHEFLYSAMPLERS_H
+#define ALIFLOWONTHEFLYSAMPLERS_H
+
+#include <vector>
+
+#include "TMath.h"
+#include "TRandom.h"
+
+class TF1;
+
+class AliFlowPtSampler{
+   public:
+      AliFlowPtSampler(); // constructor
+      virtual ~AliFlowPtSampler(); // destructor
+      void Build(TF1 *spectrum, Double_t ptMin, Double_t ptMax, Int_t nPoints = 10000);
+      void Build(Double_t ptMin, Double_t ptMax, Int_t nPoints, const Double_t *pdf);
+      // The same for pdf times a step efficiency, bins = {upper edge, efficiency below it} x nBins (1 above the last):
+      void BuildFolded(Double_t ptMin, Double_t ptMax, Int_t nPoints, const Double_t *pdf, Int_t nBins, const Double_t *bins);
+      // Use tables built elsewhere (e.g. by Build() in another process); they must outlive this sampler:
+      void Attach(Double_t ptMin, Double_t ptMax, Int_t nPoints, Double_t dIntegral, const Double_t *cdf, const Int_t *guide);
+      Bool_t IsBuilt() const {return this->fCDF != NULL;}
+      // Inverse CDF for a uniform number u in [0,1]: guide table lookup plus linear interpolation.
+      Double_t Sample(Double_t u) const
+      {
+         Int_t k = fGuide[(Int_t)(u*fNPoints)];
+         while(k < fNPoints-1 && fCDF[k+1] < u){k++;}
+         Double_t dCDF = fCDF[k+1]-fCDF[k];
+         Double_t t = (dCDF > 0. ? (u-fCDF[k])/dCDF : 0.);
+         return fPtMin + (k+t)*fStep;
+      }
+      void SampleArray(Int_t n, const Double_t *u, Double_t *pt) const; // n samples at once, pt must not alias u
+      Double_t GetIntegral() const {return this->fIntegral;}
+      Int_t GetNPoints() const {return this->fNPoints;}
+      Double_t GetPtMin() const {return this->fPtMin;}
+      Double_t GetPtMax() const {return this->fPtMax;}
+      const Double_t* GetCDF() const {return this->fCDF;}
+      const Int_t* GetGuide() const {return this->fGuide;}
+
+   private:
+      AliFlowPtSampler(const AliFlowPtSampler& aSampler); // copy constructor
+      AliFlowPtSampler& operator=(const AliFlowPtSampler& aSampler); // assignment operator
+      void Clear();
+      void Normalize(Double_t *cdf); // normalizes the cumulative integrals cdf[0..fNPoints] and builds the guide table
+      Int_t fNPoints; // number of grid intervals in [fPtMin,fPtMax]
+      Double_t fPtMin; // lower edge of the grid
+      Double_t fPtMax; // upper edge of the grid
+      Double_t fStep; // grid spacing
+      Double_t fIntegral; // integral of the (unnormalized) spectrum over the grid
+      const Double_t *fCDF; // [fNPoints+1] normalized cumulative distribution at the grid points
+      const Int_t *fGuide; // [fNPoints+1] guide table: first grid interval k with fCDF[k+1] >= j/fNPoints
+      Bool_t fOwner; // the tables were built here (kTRUE) or are borrowed, e.g. from a mapped file (kFALSE)
+
+   ClassDef(AliFlowPtSampler,0) // inverse-CDF table sampler for pt spectra
+};
+
+//====================================================================================================================
+
+class AliFlowPhiSampler{
+   public:
+      AliFlowPhiSampler(Double_t dV2 = 0.); // constructor
+      virtual ~AliFlowPhiSampler() {} // destructor
+      void SetV2(Double_t dV2) {this->fV2 = dV2;}
+      Double_t GetV2() const {return this->fV2;}
+      // Sample phi from 1+2v1cos(phi-psi)+2v2cos(2(phi-psi)): accept-reject at psi = 0 under the constant
+      // envelope 1+2|v1|+2|v2| (acceptance >= 1/(1+2|v1|+2|v2|)), then rotate by the reaction plane.
+      // The density must be non-negative, i.e. |v1|+|v2| <= 1/2.
+      Double_t Sample(Double_t v1, Double_t psi, TRandom *random) const
+      {
+         Double_t dEnvelope = 1.+2.*TMath::Abs(v1)+2.*TMath::Abs(fV2);
+         Double_t dPhi = 0.;
+         Double_t dCos = 0.;
+         do
+         {
+            dPhi = fTwoPi*random->Rndm();
+            dCos = TMath::Cos(dPhi);
+         } while(dEnvelope*random->Rndm() > 1.+2.*v1*dCos+2.*fV2*(2.*dCos*dCos-1.));
+         dPhi += psi;
+         if(dPhi >= fTwoPi){dPhi -= fTwoPi;}
+         return dPhi;
+      }
+      // Same distribution for n tracks with directed flow v1[i]: every round draws candidates for all tracks
+      // still pending and tests them together. Consumes the random numbers in a different order than Sample().
+      void SampleArray(Int_t n, const Double_t *v1, Double_t psi, TRandom *random, Double_t *phi);
+
+   private:
+      static void Propose(Int_t n, const Double_t *u, const Double_t *v1, Double_t v2, Double_t *phi, UChar_t *accept);
+      // cos(2pi u) for u in [0,1) as a polynomial, i.e. without a libm call that would keep Propose() from vectorizing:
+      // cos(2pi u) = -cos(2pi z) for z = |u-1/2|, folded to z <= 1/4 and summed as a Taylor series to y^22 (< 1e-19).
+      static Double_t CosTwoPi(Double_t u)
+      {
+         Double_t z = TMath::Abs(u-0.5);
+         Bool_t bFold = (z > 0.25);
+         Double_t y = 6.283185307179586476925286766559*(bFold ? 0.5-z : z);
+         Double_t y2 = y*y;
+         Double_t dCos = 1.;
+         for(Int_t k=11;k>=1;k--){dCos = 1.-dCos*y2/((2*k-1)*(2*k));}
+         return (bFold ? dCos : -dCos);
+      }
+      Double_t fV2; // elliptic flow
+      Double_t fTwoPi; // 2pi
+      std::vector<Double_t> fU; //! scratch: uniform numbers of one round
+      std::vector<Double_t> fCandidate; //! scratch: proposed angles of one round
+      std::vector<UChar_t> fAccept; //! scratch: acceptance flags of one round
+      std::vector<Double_t> fPendingV1; //! scratch: v1 of the tracks still pending
+      std::vector<Int_t> fPending; //! scratch: indices of the tracks still pending
+
+   ClassDef(AliFlowPhiSampler,0) // accept-reject sampler for the Fourier-like azimuthal distribution
+};
+
+//====================================================================================================================
+
+class AliFlowEtaSampler{
+   public:
+      AliFlowEtaSampler(Double_t dCoefficient = 0., Double_t etaMin = -1., Double_t etaMax = 1.); // constructor
+      virtual ~AliFlowEtaSampler() {} // destructor
+      void Set(Double_t dCoefficient, Double_t etaMin, Double_t etaMax);
+      Double_t GetCoefficient() const {return this->fCoefficient;}
+      // Invert the CDF of 1+a*eta^2 for a uniform number u in [0,1]:
+      // eta + a*eta^3/3 = c is a depressed cubic with a single root in [etaMin,etaMax].
+      Double_t Sample(Double_t u) const
+      {
+         Double_t c = fCMin+u*fCRange;
+         if(fShape > 0)
+         {
+            return fScale*TMath::SinH(TMath::ASinH(1.5*c*fSqrtA)/3.); // a > 0
+         } else if(fShape < 0)
+         {
+            return fScale*TMath::Cos(TMath::ACos(-1.5*c*fSqrtA)/3.-fTwoPiOver3); // a < 0, branch with 1+a*eta^2 > 0
+         }
+         return c; // a = 0
+      }
+      void SampleArray(Int_t n, const Double_t *u, Double_t *eta) const; // n samples at once, eta may alias u (within 1e-12 of Sample())
+      // Fill n samples into a caller-provided buffer:
+      void SampleArray(Int_t n, Double_t *array, TRandom *random) const
+      {
+         random->RndmArray(n,array);
+         this->SampleArray(n,array,array);
+      }
+
+   private:
+      static const Int_t fgNTable = 256; // intervals of fTable
+      static const Int_t fgMaxNewtonSteps = 30; // bound on fNNewtonSteps
+      // Linear interpolation in fTable, refined by nSteps Newton steps on eta+a*eta^3/3 = c (for a != 0):
+      Double_t Refine(Double_t u, Int_t nSteps) const
+      {
+         Double_t c = fCMin+u*fCRange;
+         Double_t t = u*fgNTable;
+         Int_t k = (Int_t)t;
+         k = (k < fgNTable ? k : fgNTable-1);
+         Double_t x = fTable[k]+(t-k)*(fTable[k+1]-fTable[k]);
+         for(Int_t s=0;s<nSteps;s++)
+         {
+            Double_t x2 = x*x;
+            x -= (x+fCoefficient/3.*x2*x-c)/(1.+fCoefficient*x2);
+         }
+         return x;
+      }
+      Double_t fCoefficient; // a in 1+a*eta^2
+      Double_t fEtaMin; // minimum eta
+      Double_t fEtaMax; // maximum eta
+      Int_t fShape; // sign of a (0 if |a| is negligible)
+      Double_t fSqrtA; // sqrt(|a|)
+      Double_t fScale; // 2/sqrt(|a|)
+      Double_t fCMin; // eta+a*eta^3/3 at fEtaMin
+      Double_t fCRange; // eta+a*eta^3/3 at fEtaMax minus the value at fEtaMin
+      Double_t fTwoPiOver3; // 2pi/3
+      Double_t fTable[fgNTable+1]; // Sample() at u = k/fgNTable, where the Newton steps of SampleArray() start
+      Int_t fNNewtonSteps; // Newton steps of SampleArray(): more where 1+a*eta^2 gets small in range
+
+   ClassDef(AliFlowEtaSampler,0) // closed-form sampler for the 1+a*eta^2 pseudorapidity shape
+};
+
+#endif
@@ -0,0 +1,446 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+
+/************************************
+ * Scan over a grid of run          *
+ * parameters: all configurations   *
+ * run as jobs on one thread pool.  *
+ ************************************/
+
+#include <cstdio>
+#include <thread>
+
+#include "Riostream.h"
+#include "TROOT.h"
+#include "TEnv.h"
+#include "TFile.h"
+#include "TDirectoryFile.h"
+#include "TList.h"
+#include "TObjArray.h"
+#include "TObjString.h"
+#include "TMath.h"
+#include "AliFlowPhiloxRandom.h"
+#include "AliFlowOnTheFlyTables.h"
+#include "AliFlowOnTheFlyTelemetry.h"
+#include "AliFlowEventSimpleMakerOnTheFly_mod.h"
+#include "AliFlowAnalysisWithMCEventPlane_mod.h"
+#include "AliFlowTrackSimpleCuts.h"
+#include "AliFlowEventBatch.h"
+#include "AliFlowEventView.h"
+#include "AliFlowOnTheFlyRunner.h"
+#include "AliFlowBlockMerger.h"
+#include "AliFlowOnTheFlyScan.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowOnTheFlyScan)
+
+//====================================================================================================================
+
+struct AliFlowOnTheFlyScan::Job{
+   // One configuration. Each thread books its generator and analysis the first time it takes a chunk of this job,
+   // and everything is released as soon as the last chunk is done, so only the jobs in flight take memory. In the
+   // deterministic mode (iEventsPerBlock > 0) every chunk is a block, analysed into its own analysis and merged in the
+   // tree of fMerger, as in AliFlowOnTheFlyRunner (which hands out the analyses merged away again).
+   Job(const AliFlowOnTheFlyConfig &config, Int_t nThreads):
+      fConfig(config), fCutsRP(config.CreateCutsRP()), fCutsPOI(config.CreateCutsPOI()),
+      fGenerators(nThreads,(AliFlowEventSimpleMakerOnTheFly_mod*)NULL), fAnalyses(nThreads,(AliFlowAnalysisWithMCEventPlane_mod*)NULL),
+      fMerger(NULL), fNChunks(0), fNDone(0) {}
+   ~Job()
+   {
+      this->Release();
+      delete fCutsRP;
+      delete fCutsPOI;
+   }
+   void Release()
+   {
+      for(UInt_t t=0;t<fGenerators.size();t++)
+      {
+         if(fGenerators[t]){delete fGenerators[t];}
+         if(fAnalyses[t]){delete fAnalyses[t];}
+         fGenerators[t] = NULL;
+         fAnalyses[t] = NULL;
+      }
+      if(fMerger){delete fMerger;}
+      fMerger = NULL;
+   }
+   AliFlowOnTheFlyConfig fConfig; // parameters of this job
+   AliFlowTrackSimpleCuts *fCutsRP; // RP cuts, shared read-only by all threads
+   AliFlowTrackSimpleCuts *fCutsPOI; // POI cuts, shared read-only by all threads
+   std::vector<AliFlowEventSimpleMakerOnTheFly_mod*> fGenerators; // per thread, NULL until used
+   std::vector<AliFlowAnalysisWithMCEventPlane_mod*> fAnalyses; // per thread, NULL until used
+   AliFlowBlockMerger *fMerger; // tree of the blocks (deterministic mode only)
+   std::mutex fMergerMutex; // serializes fMerger
+   Long64_t fNChunks; // chunks of this job
+   std::atomic<Long64_t> fNDone; // chunks done
+};
+
+//====================================================================================================================
+
+AliFlowOnTheFlyScan::AliFlowOnTheFlyScan():
+   fSeed(44),
+   fTables(NULL),
+   fOwnTablesFile(""),
+   fNThreads(1),
+   fNextChunk(0),
+   fOutputFile(NULL)
+{
+   // Constructor.
+
+} // end of AliFlowOnTheFlyScan::AliFlowOnTheFlyScan()
+
+//====================================================================================================================
+
+AliFlowOnTheFlyScan::~AliFlowOnTheFlyScan()
+{
+   // Destructor.
+
+   this->Clear();
+
+} // end of AliFlowOnTheFlyScan::~AliFlowOnTheFlyScan()
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyScan::Clear()
+{
+   // Release everything of the last Run(); the generators go before the tables they are attached to.
+
+   for(UInt_t j=0;j<fJobs.size();j++){delete fJobs[j];}
+   fJobs.clear();
+   for(UInt_t t=0;t<fBatches.size();t++){delete fBatches[t];}
+   fBatches.clear();
+   fChunks.clear();
+   if(fTables){delete fTables;}
+   fTables = NULL;
+   if(!fOwnTablesFile.IsNull()){std::remove(fOwnTablesFile.Data());}
+   fOwnTablesFile = "";
+
+} // end of void AliFlowOnTheFlyScan::Clear()
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyScan::ReadFile(const char *fileName)
+{
+   // Base configuration and grid from fileName.
+
+   if(!fBase.ReadFile(fileName)){return kFALSE;}
+   TEnv env("");
+   env.ReadFile(fileName,kEnvLocal);
+   TObjArray *keys = TString(env.GetValue("Scan.Keys","")).Tokenize(" \t");
+   Bool_t bOK = kTRUE;
+   for(Int_t k=0;k<keys->GetEntries();k++)
+   {
+      TString key = static_cast<TObjString*>(keys->At(k))->GetString();
+      bOK = this->AddAxis(key.Data(),env.GetValue(("Scan."+key).Data(),"")) && bOK;
+   }
+   delete keys;
+   return bOK;
+
+} // end of Bool_t AliFlowOnTheFlyScan::ReadFile(const char *fileName)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyScan::AddAxis(const char *key, const char *values)
+{
+   // Scan key over the blank-separated values.
+
+   if(!AliFlowOnTheFlyConfig::IsKey(key))
+   {
+      cout<<"WARNING: "<<key<<" is not a parameter of the analysis 'on the fly', not scanned."<<endl;
+      return kFALSE;
+   }
+   std::vector<TString> axis;
+   TObjArray *tokens = TString(values).Tokenize(" \t");
+   for(Int_t v=0;v<tokens->GetEntries();v++){axis.push_back(static_cast<TObjString*>(tokens->At(v))->GetString());}
+   delete tokens;
+   if(axis.empty())
+   {
+      cout<<"WARNING: no values given for "<<key<<", not scanned."<<endl;
+      return kFALSE;
+   }
+   fKeys.push_back(key);
+   fValues.push_back(axis);
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyScan::AddAxis(const char *key, const char *values)
+
+//====================================================================================================================
+
+Int_t AliFlowOnTheFlyScan::GetNConfigs() const
+{
+   // Points of the grid.
+
+   Int_t nConfigs = 1;
+   for(UInt_t a=0;a<fValues.size();a++){nConfigs *= (Int_t)fValues[a].size();}
+   return nConfigs;
+
+} // end of Int_t AliFlowOnTheFlyScan::GetNConfigs() const
+
+//====================================================================================================================
+
+AliFlowOnTheFlyConfig AliFlowOnTheFlyScan::GetConfig(Int_t i) const
+{
+   // Point i of the grid; the last axis runs fastest.
+
+   AliFlowOnTheFlyConfig config = fBase;
+   TString label = "";
+   Int_t iRest = i;
+   for(Int_t a=(Int_t)fKeys.size()-1;a>=0;a--)
+   {
+      Int_t nValues = (Int_t)fValues[a].size();
+      const TString &value = fValues[a][iRest % nValues];
+      iRest /= nValues;
+      config.SetValue(fKeys[a].Data(),value.Data());
+      label = fKeys[a]+"_"+value+(label.IsNull() ? "" : "_")+label;
+   }
+   if(!label.IsNull()){config.SetLabel(label.Data());}
+   return config;
+
+} // end of AliFlowOnTheFlyConfig AliFlowOnTheFlyScan::GetConfig(Int_t i) const
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyScan::PrepareTables(const char *outputFileName)
+{
+   // Map the sampling tables once for all generators: those of sTablesFile, or else tables of all centrality classes
+   // computed here for the pt range of the base configuration. A configuration with another pt range computes its own.
+
+   if(fBase.GetUseTF1Sampling()){return kTRUE;}
+   TString tablesFile = fBase.GetTablesFile();
+   if(tablesFile.IsNull())
+   {
+      const Int_t nClasses = 3;
+      AliFlowEventSimpleMakerOnTheFly_mod *eventMakers[nClasses] = {NULL};
+      AliFlowOnTheFlyTables::ClassTables tables[nClasses];
+      for(Int_t c=0;c<nClasses;c++)
+      {
+         AliFlowOnTheFlyConfig config = fBase;
+         config.SetValue("cClass",TString::Format("%d",c).Data());
+         config.SetValue("uniformEfficiency","0"); // also book the table of spectrum x efficiency
+         config.SetValue("bFoldEfficiency","1");
+         config.SetValue("sTelemetryFile","");
+         eventMakers[c] = config.CreateGenerator(fSeed);
+         tables[c].fPtSampler = eventMakers[c]->GetPtSampler();
+         tables[c].fPtSamplerFolded = eventMakers[c]->GetPtSamplerFolded();
+         tables[c].fNEfficiencyBins = eventMakers[c]->GetNEfficiencyBins();
+         tables[c].fEfficiencyBins = eventMakers[c]->GetEfficiencyBins();
+         tables[c].fEtaCoefficient = eventMakers[c]->GetEtaCoefficient();
+      }
+      tablesFile = TString(outputFileName)+".tables";
+      Bool_t bWritten = AliFlowOnTheFlyTables::Write(tablesFile.Data(),nClasses,tables);
+      for(Int_t c=0;c<nClasses;c++){delete eventMakers[c];}
+      if(!bWritten){return kFALSE;}
+      fOwnTablesFile = tablesFile;
+   }
+   fTables = new AliFlowOnTheFlyTables();
+   return fTables->Open(tablesFile.Data());
+
+} // end of Bool_t AliFlowOnTheFlyScan::PrepareTables(const char *outputFileName)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyScan::Run(const char *outputFileName)
+{
+   // Run all configurations and write the results of each into its own directory of outputFileName.
+
+   // a) One seed and one set of sampling tables for all configurations;
+   // b) Cut every configuration into chunks, job after job: the threads work through one or two jobs at a time,
+   //    and a job is finished and written while the others still run;
+   // c) Run the threads;
+   // d) Close the output.
+
+   this->Clear();
+   ROOT::EnableThreadSafety();
+   if(fBase.GetTelemetryFile()[0] != 0){AliFlowOnTheFlyTelemetry::Reset(fBase.GetTelemetryFile());} // counters of this run only
+
+   // a) One seed and one set of sampling tables:
+   fSeed = 44;
+   if(!fBase.GetSameSeed())
+   {
+      AliFlowPhiloxRandom seedFromTUUID(0); // the seed is determined uniquely in space and time via TUUID
+      fSeed = seedFromTUUID.GetSeed();
+   }
+   if(!this->PrepareTables(outputFileName))
+   {
+      cout<<"WARNING: no sampling tables, nothing done."<<endl;
+      return kFALSE;
+   }
+
+   // b) Cut every configuration into chunks:
+   fNThreads = fBase.GetNThreads();
+   if(fNThreads <= 0){fNThreads = (Int_t)std::thread::hardware_concurrency();}
+   if(fNThreads <= 0){fNThreads = 1;}
+   for(Int_t j=0;j<this->GetNConfigs();j++)
+   {
+      Job *pJob = new Job(this->GetConfig(j),fNThreads);
+      pJob->fConfig.Print();
+      if(pJob->fConfig.GetUseTF1Sampling() && fNThreads > 1)
+      {
+         // TF1::GetRandom() draws from the global gRandom, which threads cannot share:
+         cout<<"WARNING: TF1 sampling is not thread safe, running on 1 thread."<<endl;
+         fNThreads = 1;
+      }
+      Long64_t nEvents = pJob->fConfig.GetNEvents();
+      Long64_t nPerChunk = TMath::Max(pJob->fConfig.GetEventsPerChunk(),1);
+      if(pJob->fConfig.GetEventsPerBlock() > 0)
+      {
+         nPerChunk = pJob->fConfig.GetEventsPerBlock();
+         Long64_t nBlocks = TMath::Max(AliFlowBlockMerger::GetNumberOfBlocks(nEvents,(Int_t)nPerChunk),(Long64_t)1);
+         const AliFlowOnTheFlyConfig *pConfig = &pJob->fConfig;
+         pJob->fMerger = new AliFlowBlockMerger(nBlocks,[pConfig](){return pConfig->CreateAnalysis();});
+      }
+      for(Long64_t first=0;first<nEvents;first+=nPerChunk)
+      {
+         Chunk chunk = {j,first,TMath::Min(first+nPerChunk,nEvents)};
+         fChunks.push_back(chunk);
+         pJob->fNChunks++;
+      }
+      fJobs.push_back(pJob);
+   }
+   for(Int_t t=0;t<fNThreads;t++){fBatches.push_back(new AliFlowEventBatch());}
+   fNextChunk = 0;
+
+   // c) Run the threads:
+   fOutputFile = new TFile(outputFileName,"RECREATE");
+   if(fOutputFile->IsZombie())
+   {
+      cout<<"WARNING: cannot create "<<outputFileName<<", nothing done."<<endl;
+      delete fOutputFile;
+      fOutputFile = NULL;
+      return kFALSE;
+   }
+   gROOT->cd(); // book the histograms in memory, not in the output file
+   std::vector<std::thread> threads;
+   for(Int_t t=1;t<fNThreads;t++){threads.push_back(std::thread(&AliFlowOnTheFlyScan::Work,this,t));}
+   this->Work(0);
+   for(UInt_t t=0;t<threads.size();t++){threads[t].join();}
+   for(UInt_t j=0;j<fJobs.size();j++)
+   {
+      if(fJobs[j]->fNChunks == 0){this->FinishJob(fJobs[j]);} // nothing to run, but still an output directory
+   }
+
+   // d) Close the output:
+   fOutputFile->Close();
+   delete fOutputFile;
+   fOutputFile = NULL;
+   this->Clear();
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyScan::Run(const char *outputFileName)
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyScan::Work(Int_t iThread)
+{
+   // Event loop of one thread: take the next chunk of any job until none is left.
+
+   AliFlowEventBatch *pBatch = fBatches[iThread];
+   AliFlowEventView view;
+   for(Long64_t c=fNextChunk++;c<(Long64_t)fChunks.size();c=fNextChunk++)
+   {
+      const Chunk &chunk = fChunks[c];
+      Job *pJob = fJobs[chunk.fJob];
+      if(!pJob->fGenerators[iThread])
+      {
+         std::lock_guard<std::mutex> lock(fRootMutex);
+         pJob->fGenerators[iThread] = pJob->fConfig.CreateGenerator(fSeed,fTables);
+         if(!pJob->fMerger){pJob->fAnalyses[iThread] = pJob->fConfig.CreateAnalysis();}
+      }
+      AliFlowEventSimpleMakerOnTheFly_mod *pGenerator = pJob->fGenerators[iThread];
+      AliFlowAnalysisWithMCEventPlane_mod *pAnalysis = pJob->fAnalyses[iThread];
+      if(pJob->fMerger)
+      {
+         std::lock_guard<std::mutex> lock(fRootMutex);
+         std::lock_guard<std::mutex> lockMerger(pJob->fMergerMutex);
+         pAnalysis = pJob->fMerger->NewBlockAnalysis(); // one per block, reused once merged away
+      }
+      Int_t nEvents = (Int_t)(chunk.fLast-chunk.fFirst);
+      pGenerator->SetEventIndex(chunk.fFirst);
+      if(pJob->fConfig.GetStreamEvents())
+      {
+         pGenerator->CreateEventsStreamed(nEvents,pJob->fCutsRP,pJob->fCutsPOI,pAnalysis->GetSink());
+      } else
+      {
+         pGenerator->CreateEventsBatch(nEvents,pJob->fCutsRP,pJob->fCutsPOI,pBatch);
+         for(Int_t e=0;e<nEvents;e++)
+         {
+            view.Set(*pBatch,e);
+            pAnalysis->Make(view);
+         }
+      }
+      if(pJob->fMerger)
+      {
+         pAnalysis->FlushAccumulators(); // the nodes are merged flushed, see AliFlowBlockMerger::MergeNodes()
+         std::lock_guard<std::mutex> lock(pJob->fMergerMutex);
+         pJob->fMerger->Add(chunk.fFirst/pJob->fConfig.GetEventsPerBlock(),0,pAnalysis);
+      }
+      if(++pJob->fNDone == pJob->fNChunks){this->FinishJob(pJob);} // the last chunk of this job: nobody else uses it now
+   }
+
+} // end of void AliFlowOnTheFlyScan::Work(Int_t iThread)
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyScan::FinishJob(Job *pJob)
+{
+   // Merge the analyses of all threads of pJob (in the deterministic mode: take the root of the tree of its blocks),
+   // finish the result and write it to the directory named after its configuration; then release the job's generators
+   // and analyses.
+
+   std::lock_guard<std::mutex> lock(fRootMutex);
+   std::vector<AliFlowAnalysisWithMCEventPlane_mod*> analyses;
+   AliFlowAnalysisWithMCEventPlane_mod *pTarget = NULL;
+   if(pJob->fMerger)
+   {
+      if(pJob->fNChunks == 0){pJob->fMerger->Add(0,0,pJob->fConfig.CreateAnalysis());} // no events: write the empty histograms
+      pTarget = pJob->fMerger->GetRoot();
+   } else
+   {
+      for(Int_t t=0;t<fNThreads;t++)
+      {
+         if(pJob->fAnalyses[t]){analyses.push_back(pJob->fAnalyses[t]);}
+      }
+      if(analyses.empty()){analyses.push_back(pJob->fAnalyses[0] = pJob->fConfig.CreateAnalysis());} // no events: write the empty histograms
+      // Serially: the other jobs keep the remaining threads busy.
+      pTarget = AliFlowOnTheFlyRunner::MergeTree(analyses,kFALSE);
+   }
+
+   fOutputFile->cd();
+   TDirectoryFile *dirFileFinal = new TDirectoryFile(pJob->fConfig.GetLabel(),pJob->fConfig.GetLabel());
+   pTarget->Finish();
+   if(pJob->fMerger)
+   {
+      // The root stays with the merger, the directory gets a copy:
+      TList *finalHistList = static_cast<TList*>(pTarget->GetHistList()->Clone("cobjMCEP"));
+      finalHistList->SetOwner(kTRUE);
+      dirFileFinal->Add(finalHistList);
+      dirFileFinal->Write(dirFileFinal->GetName(),TObject::kSingleKey);
+   } else
+   {
+      pTarget->WriteHistograms(dirFileFinal); // dirFileFinal owns the histograms of pTarget from now on
+   }
+   gROOT->cd();
+   cout<<" "<<pJob->fConfig.GetLabel()<<" done."<<endl;
+
+   for(UInt_t a=1;a<analyses.size();a++)
+   {
+      TList *pSource = analyses[a]->GetHistList();
+      pSource->SetOwner(kTRUE);
+      delete pSource;
+   }
+   pJob->Release();
+
+} // end of void AliFlowOnTheFlyScan::FinishJob(Job *pJob)
@@ -0,0 +1,73 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Scan over a grid of run          *
+ * parameters: all configurations   *
+ * run as jobs on one thread pool.  *
+ ************************************/
+
+#ifndef ALIFLOWONTHEFLYSCAN_H
+#define ALIFLOWONTHEFLYSCAN_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#include "Rtypes.h"
+#include "TString.h"
+#include "AliFlowOnTheFlyConfig.h"
+
+class TFile;
+
+class AliFlowOnTheFlyTables;
+class AliFlowEventBatch;
+
+// A scan file is a configuration file (see AliFlowOnTheFlyConfig) with the parameters to scan and their values:
+//    Scan.Keys: cClass dV1
+//    Scan.cClass: 0 1 2
+//    Scan.dV1: 0.0 0.02 0.05
+// which makes 3 x 3 configurations, labelled cClass_0_dV1_0.0 and so on.
+class AliFlowOnTheFlyScan{
+   public:
+      AliFlowOnTheFlyScan(); // constructor
+      virtual ~AliFlowOnTheFlyScan(); // destructor
+      Bool_t ReadFile(const char *fileName); // base configuration and grid
+      Bool_t AddAxis(const char *key, const char *values); // scan key over the blank-separated values
+      AliFlowOnTheFlyConfig& GetBaseConfig() {return this->fBase;}
+      Int_t GetNConfigs() const; // points of the grid
+      AliFlowOnTheFlyConfig GetConfig(Int_t i) const; // point i of the grid, labelled
+      // Run all configurations on the threads of the base configuration and write the results of each into its own
+      // directory of outputFileName:
+      Bool_t Run(const char *outputFileName);
+
+   private:
+      AliFlowOnTheFlyScan(const AliFlowOnTheFlyScan& aScan); // copy constructor
+      AliFlowOnTheFlyScan& operator=(const AliFlowOnTheFlyScan& aScan); // assignment operator
+      struct Job; // one configuration: its generators and analyses per thread
+      struct Chunk{Int_t fJob; Long64_t fFirst; Long64_t fLast;}; // events [fFirst,fLast) of job fJob
+      Bool_t PrepareTables(const char *outputFileName);
+      void Work(Int_t iThread);
+      void FinishJob(Job *pJob);
+      void Clear();
+      AliFlowOnTheFlyConfig fBase; // parameters shared by all configurations
+      std::vector<TString> fKeys; // scanned parameters
+      std::vector<std::vector<TString> > fValues; // their values
+      UInt_t fSeed; // one seed for all configurations
+      AliFlowOnTheFlyTables *fTables; // the sampling tables, mapped once for all generators
+      TString fOwnTablesFile; // tables written by PrepareTables(), deleted at the end
+      Int_t fNThreads; // worker threads of the current Run()
+      std::vector<AliFlowEventBatch*> fBatches; // events of the current chunk, one batch per thread
+      std::vector<Job*> fJobs; // one per configuration
+      std::vector<Chunk> fChunks; // all work, job after job
+      std::atomic<Long64_t> fNextChunk; // next chunk to take
+      std::mutex fRootMutex; // serializes everything that touches global ROOT state (booking, Finish(), writing)
+      TFile *fOutputFile; // one directory per configuration
+
+   ClassDef(AliFlowOnTheFlyScan,0) // parameter scan of the analysis 'on the fly'
+};
+
+#endif
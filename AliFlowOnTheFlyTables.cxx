@@ -0,0 +1,394 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Precomputed spectrum, efficiency *
+ * and eta tables of the flow event *
+ * maker 'on the fly', memory-      *
+ * mapped read-only from one file.  *
+ ************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Riostream.h"
+#include "AliFlowOnTheFlySamplers.h"
+#include "AliFlowOnTheFlyTables.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowOnTheFlyTables)
+
+//====================================================================================================================
+
+// File layout (native byte order, every array aligned to 64 bytes):
+//    FileHeader
+//    ClassEntry[fNClasses]
+//    arrays, addressed by byte offsets from the start of the file
+static const char gkTablesMagic[8] = {'A','O','T','F','T','A','B','1'};
+static const UInt_t gkTablesVersion = 1;
+static const UInt_t gkTablesByteOrder = 0x01020304;
+static const Long64_t gkTablesAlignment = 64;
+
+struct AliFlowOnTheFlyTables::FileHeader{
+   char fMagic[8]; // "AOTFTAB1"
+   UInt_t fVersion; // gkTablesVersion
+   UInt_t fByteOrder; // gkTablesByteOrder as written, to reject files from machines with another byte order
+   UInt_t fNClasses; // number of centrality classes
+   UInt_t fReserved; // 0
+   Long64_t fSize; // size of the whole file in bytes
+};
+
+struct AliFlowOnTheFlyTables::ClassEntry{
+   Double_t fPtMin; // lower edge of the pt grid
+   Double_t fPtMax; // upper edge of the pt grid
+   Double_t fIntegral; // integral of the spectrum
+   Double_t fIntegralFolded; // integral of spectrum x efficiency (0: not stored)
+   Double_t fEtaCoefficient; // a in 1+a*eta^2
+   Int_t fNPoints; // number of grid intervals of both pt tables
+   Int_t fNEfficiencyBins; // number of efficiency bins
+   Long64_t fCDF; // offset of Double_t[fNPoints+1]
+   Long64_t fGuide; // offset of Int_t[fNPoints+1]
+   Long64_t fCDFFolded; // offset of Double_t[fNPoints+1] (0: not stored)
+   Long64_t fGuideFolded; // offset of Int_t[fNPoints+1] (0: not stored)
+   Long64_t fEfficiencyBins; // offset of Double_t[2*fNEfficiencyBins]
+};
+
+//====================================================================================================================
+
+AliFlowOnTheFlyTables::AliFlowOnTheFlyTables():
+   fData(NULL),
+   fSize(0)
+{
+   // Constructor.
+
+} // end of AliFlowOnTheFlyTables::AliFlowOnTheFlyTables()
+
+//====================================================================================================================
+
+AliFlowOnTheFlyTables::~AliFlowOnTheFlyTables()
+{
+   // Destructor.
+
+   this->Close();
+
+} // end of AliFlowOnTheFlyTables::~AliFlowOnTheFlyTables()
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTables::Open(const char *fileName)
+{
+   // Map fileName read-only and check that it is complete. The mapping is shared: all generators on a node
+   // that open the same file read the same physical pages from the page cache.
+
+   // a) Map the file;
+   // b) Check the header;
+   // c) Check that all arrays are aligned and lie inside the file, and that the pt tables keep the samplers in bounds.
+
+   this->Close();
+
+   // a) Map the file:
+   Int_t fd = open(fileName,O_RDONLY);
+   if(fd < 0)
+   {
+      cout<<"WARNING: cannot open the tables file "<<fileName<<"."<<endl;
+      return kFALSE;
+   }
+   struct stat fileStat;
+   if(fstat(fd,&fileStat) != 0 || fileStat.st_size < (Long64_t)sizeof(FileHeader))
+   {
+      cout<<"WARNING: "<<fileName<<" is not a tables file."<<endl;
+      close(fd);
+      return kFALSE;
+   }
+   void *pMap = mmap(NULL,fileStat.st_size,PROT_READ,MAP_SHARED,fd,0);
+   close(fd); // the mapping keeps the file alive
+   if(pMap == MAP_FAILED)
+   {
+      cout<<"WARNING: cannot map the tables file "<<fileName<<"."<<endl;
+      return kFALSE;
+   }
+   fData = (const char*)pMap;
+   fSize = fileStat.st_size;
+
+   // b) Check the header:
+   const FileHeader *pHeader = (const FileHeader*)fData;
+   if(memcmp(pHeader->fMagic,gkTablesMagic,sizeof(gkTablesMagic)) != 0 || pHeader->fVersion != gkTablesVersion
+      || pHeader->fByteOrder != gkTablesByteOrder || pHeader->fSize != fSize
+      || (Long64_t)(sizeof(FileHeader)+pHeader->fNClasses*sizeof(ClassEntry)) > fSize)
+   {
+      cout<<"WARNING: "<<fileName<<" is not a complete tables file of version "<<gkTablesVersion<<" for this machine."<<endl;
+      this->Close();
+      return kFALSE;
+   }
+
+   // c) Check the arrays:
+   for(Int_t c=0;c<this->GetNClasses();c++)
+   {
+      const ClassEntry *pEntry = this->Entry(c);
+      Bool_t bValid = (pEntry->fNPoints > 0 && pEntry->fNEfficiencyBins >= 0 && pEntry->fPtMax > pEntry->fPtMin);
+      bValid = bValid && this->IsPtTable(pEntry->fCDF,pEntry->fGuide,pEntry->fNPoints);
+      bValid = bValid && this->IsArray(pEntry->fEfficiencyBins,2*pEntry->fNEfficiencyBins*(Long64_t)sizeof(Double_t));
+      if(pEntry->fCDFFolded > 0)
+      {
+         bValid = bValid && this->IsPtTable(pEntry->fCDFFolded,pEntry->fGuideFolded,pEntry->fNPoints);
+      }
+      if(!bValid)
+      {
+         cout<<"WARNING: the tables of class "<<c<<" in "<<fileName<<" are corrupt."<<endl;
+         this->Close();
+         return kFALSE;
+      }
+   }
+
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyTables::Open(const char *fileName)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTables::IsArray(Long64_t offset, Long64_t nBytes) const
+{
+   // Does an array of nBytes at offset lie inside the mapping, aligned as Write() aligns every array?
+
+   return (offset > 0 && offset%gkTablesAlignment == 0 && nBytes >= 0 && offset <= fSize && nBytes <= fSize-offset);
+
+} // end of Bool_t AliFlowOnTheFlyTables::IsArray(Long64_t offset, Long64_t nBytes) const
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTables::IsPtTable(Long64_t lCDF, Long64_t lGuide, Int_t nPoints) const
+{
+   // Can AliFlowPtSampler draw from the CDF at lCDF and the guide table at lGuide without leaving them? The CDF must
+   // rise from 0 to 1 without decreasing, every guide entry must index an interval (0 to nPoints-1) and the guide
+   // must not decrease either, as Build() makes them.
+
+   if(!this->IsArray(lCDF,(nPoints+1)*(Long64_t)sizeof(Double_t)) || !this->IsArray(lGuide,(nPoints+1)*(Long64_t)sizeof(Int_t)))
+   {
+      return kFALSE;
+   }
+   const Double_t *cdf = (const Double_t*)(fData+lCDF);
+   const Int_t *guide = (const Int_t*)(fData+lGuide);
+   if(!(cdf[0] >= 0.) || cdf[nPoints] != 1.){return kFALSE;}
+   for(Int_t k=0;k<nPoints;k++)
+   {
+      if(!(cdf[k+1] >= cdf[k])){return kFALSE;} // also false for NaN
+   }
+   for(Int_t j=0;j<=nPoints;j++)
+   {
+      if(guide[j] < 0 || guide[j] >= nPoints || (j > 0 && guide[j] < guide[j-1])){return kFALSE;}
+   }
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyTables::IsPtTable(Long64_t lCDF, Long64_t lGuide, Int_t nPoints) const
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyTables::Close()
+{
+   // Unmap the file. Samplers attached to it must not be used afterwards.
+
+   if(fData){munmap((void*)fData,fSize);}
+   fData = NULL;
+   fSize = 0;
+
+} // end of void AliFlowOnTheFlyTables::Close()
+
+//====================================================================================================================
+
+Int_t AliFlowOnTheFlyTables::GetNClasses() const
+{
+   // Number of centrality classes in the file.
+
+   return (fData ? (Int_t)((const FileHeader*)fData)->fNClasses : 0);
+
+} // end of Int_t AliFlowOnTheFlyTables::GetNClasses() const
+
+//====================================================================================================================
+
+const AliFlowOnTheFlyTables::ClassEntry* AliFlowOnTheFlyTables::Entry(Int_t iClass) const
+{
+   // Directory entry of class iClass, or NULL if there is none.
+
+   if(iClass < 0 || iClass >= this->GetNClasses()){return NULL;}
+   return (const ClassEntry*)(fData+sizeof(FileHeader))+iClass;
+
+} // end of const AliFlowOnTheFlyTables::ClassEntry* AliFlowOnTheFlyTables::Entry(Int_t iClass) const
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTables::AttachPtSampler(Int_t iClass, Bool_t bFolded, AliFlowPtSampler *sampler) const
+{
+   // Let sampler draw from the (folded) pt table of class iClass in place.
+
+   const ClassEntry *pEntry = this->Entry(iClass);
+   if(!pEntry || (bFolded && pEntry->fCDFFolded <= 0)){return kFALSE;}
+
+   Long64_t lCDF = (bFolded ? pEntry->fCDFFolded : pEntry->fCDF);
+   Long64_t lGuide = (bFolded ? pEntry->fGuideFolded : pEntry->fGuide);
+   sampler->Attach(pEntry->fPtMin,pEntry->fPtMax,pEntry->fNPoints,(bFolded ? pEntry->fIntegralFolded : pEntry->fIntegral),
+                   (const Double_t*)(fData+lCDF),(const Int_t*)(fData+lGuide));
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyTables::AttachPtSampler(Int_t iClass, Bool_t bFolded, AliFlowPtSampler *sampler) const
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTables::HasFolded(Int_t iClass) const
+{
+   // Is the table of spectrum x efficiency stored for class iClass?
+
+   const ClassEntry *pEntry = this->Entry(iClass);
+   return (pEntry && pEntry->fCDFFolded > 0);
+
+} // end of Bool_t AliFlowOnTheFlyTables::HasFolded(Int_t iClass) const
+
+//====================================================================================================================
+
+Int_t AliFlowOnTheFlyTables::GetNEfficiencyBins(Int_t iClass) const
+{
+   // Number of efficiency bins of class iClass.
+
+   const ClassEntry *pEntry = this->Entry(iClass);
+   return (pEntry ? pEntry->fNEfficiencyBins : 0);
+
+} // end of Int_t AliFlowOnTheFlyTables::GetNEfficiencyBins(Int_t iClass) const
+
+//====================================================================================================================
+
+const Double_t* AliFlowOnTheFlyTables::GetEfficiencyBins(Int_t iClass) const
+{
+   // {upper pT edge, efficiency} pairs of class iClass, in place.
+
+   const ClassEntry *pEntry = this->Entry(iClass);
+   return (pEntry ? (const Double_t*)(fData+pEntry->fEfficiencyBins) : NULL);
+
+} // end of const Double_t* AliFlowOnTheFlyTables::GetEfficiencyBins(Int_t iClass) const
+
+//====================================================================================================================
+
+Double_t AliFlowOnTheFlyTables::GetEtaCoefficient(Int_t iClass) const
+{
+   // Coefficient a of the 1+a*eta^2 shape of class iClass.
+
+   const ClassEntry *pEntry = this->Entry(iClass);
+   return (pEntry ? pEntry->fEtaCoefficient : 0.);
+
+} // end of Double_t AliFlowOnTheFlyTables::GetEtaCoefficient(Int_t iClass) const
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTables::Write(const char *fileName, Int_t nClasses, const ClassTables *classes)
+{
+   // Lay out the tables of all classes in memory and write them in one go. The file is written under a temporary
+   // name and renamed at the end, so that workers never map a half-written file.
+
+   // a) Place the header, the directory and the arrays;
+   // b) Copy the arrays;
+   // c) Write and rename.
+
+   // a) Place the header, the directory and the arrays:
+   std::vector<ClassEntry> entries(nClasses);
+   Long64_t lSize = sizeof(FileHeader)+nClasses*sizeof(ClassEntry);
+   for(Int_t c=0;c<nClasses;c++)
+   {
+      const ClassTables &tables = classes[c];
+      if(!tables.fPtSampler || !tables.fPtSampler->IsBuilt() || (tables.fNEfficiencyBins > 0 && !tables.fEfficiencyBins)
+         || (tables.fPtSamplerFolded && tables.fPtSamplerFolded->GetNPoints() != tables.fPtSampler->GetNPoints()))
+      {
+         cout<<"WARNING: incomplete tables for class "<<c<<", "<<fileName<<" not written."<<endl;
+         return kFALSE;
+      }
+      ClassEntry &entry = entries[c];
+      memset(&entry,0,sizeof(ClassEntry));
+      Long64_t nPoints = tables.fPtSampler->GetNPoints();
+      entry.fPtMin = tables.fPtSampler->GetPtMin();
+      entry.fPtMax = tables.fPtSampler->GetPtMax();
+      entry.fIntegral = tables.fPtSampler->GetIntegral();
+      entry.fEtaCoefficient = tables.fEtaCoefficient;
+      entry.fNPoints = (Int_t)nPoints;
+      entry.fNEfficiencyBins = tables.fNEfficiencyBins;
+      Long64_t lAligned = gkTablesAlignment-1;
+      entry.fCDF = (lSize+lAligned) & ~lAligned;
+      entry.fGuide = (entry.fCDF+(nPoints+1)*sizeof(Double_t)+lAligned) & ~lAligned;
+      lSize = entry.fGuide+(nPoints+1)*sizeof(Int_t);
+      if(tables.fPtSamplerFolded)
+      {
+         entry.fIntegralFolded = tables.fPtSamplerFolded->GetIntegral();
+         entry.fCDFFolded = (lSize+lAligned) & ~lAligned;
+         entry.fGuideFolded = (entry.fCDFFolded+(nPoints+1)*sizeof(Double_t)+lAligned) & ~lAligned;
+         lSize = entry.fGuideFolded+(nPoints+1)*sizeof(Int_t);
+      }
+      entry.fEfficiencyBins = (lSize+lAligned) & ~lAligned;
+      lSize = entry.fEfficiencyBins+2*tables.fNEfficiencyBins*sizeof(Double_t);
+   }
+
+   // b) Copy the arrays:
+   std::vector<char> buffer(lSize,0);
+   FileHeader header;
+   memset(&header,0,sizeof(FileHeader));
+   memcpy(header.fMagic,gkTablesMagic,sizeof(gkTablesMagic));
+   header.fVersion = gkTablesVersion;
+   header.fByteOrder = gkTablesByteOrder;
+   header.fNClasses = nClasses;
+   header.fSize = lSize;
+   memcpy(&buffer[0],&header,sizeof(FileHeader));
+   if(nClasses > 0){memcpy(&buffer[sizeof(FileHeader)],&entries[0],nClasses*sizeof(ClassEntry));}
+   for(Int_t c=0;c<nClasses;c++)
+   {
+      const ClassTables &tables = classes[c];
+      const ClassEntry &entry = entries[c];
+      Long64_t nPoints = entry.fNPoints;
+      memcpy(&buffer[entry.fCDF],tables.fPtSampler->GetCDF(),(nPoints+1)*sizeof(Double_t));
+      memcpy(&buffer[entry.fGuide],tables.fPtSampler->GetGuide(),(nPoints+1)*sizeof(Int_t));
+      if(tables.fPtSamplerFolded)
+      {
+         memcpy(&buffer[entry.fCDFFolded],tables.fPtSamplerFolded->GetCDF(),(nPoints+1)*sizeof(Double_t));
+         memcpy(&buffer[entry.fGuideFolded],tables.fPtSamplerFolded->GetGuide(),(nPoints+1)*sizeof(Int_t));
+      }
+      if(tables.fNEfficiencyBins > 0)
+      {
+         memcpy(&buffer[entry.fEfficiencyBins],tables.fEfficiencyBins,2*tables.fNEfficiencyBins*sizeof(Double_t));
+      }
+   }
+
+   // c) Write and rename:
+   std::string sTemporary = std::string(fileName)+".tmp";
+   FILE *pFile = fopen(sTemporary.c_str(),"wb");
+   if(!pFile)
+   {
+      cout<<"WARNING: cannot create "<<sTemporary<<"."<<endl;
+      return kFALSE;
+   }
+   Bool_t bWritten = (fwrite(&buffer[0],1,lSize,pFile) == (size_t)lSize);
+   bWritten = (fclose(pFile) == 0) && bWritten;
+   if(!bWritten || rename(sTemporary.c_str(),fileName) != 0)
+   {
+      cout<<"WARNING: cannot write "<<fileName<<"."<<endl;
+      remove(sTemporary.c_str());
+      return kFALSE;
+   }
+
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyTables::Write(const char *fileName, Int_t nClasses, const ClassTables *classes)
+
+//====================================================================================================================
@@ -0,0 +1,62 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Precomputed spectrum, efficiency *
+ * and eta tables of the flow event *
+ * maker 'on the fly', memory-      *
+ * mapped read-only from one file.  *
+ ************************************/
+
+#ifndef ALIFLOWONTHEFLYTABLES_H
+#define ALIFLOWONTHEFLYTABLES_H
+
+#include "Rtypes.h"
+
+class AliFlowPtSampler;
+
+class AliFlowOnTheFlyTables{
+   public:
+      // Everything stored for one centrality class, as handed to Write():
+      struct ClassTables{
+         ClassTables(): fPtSampler(NULL), fPtSamplerFolded(NULL), fNEfficiencyBins(0), fEfficiencyBins(NULL), fEtaCoefficient(0.) {}
+         const AliFlowPtSampler *fPtSampler; // inverse-CDF table of the pt spectrum
+         const AliFlowPtSampler *fPtSamplerFolded; // inverse-CDF table of spectrum x efficiency (NULL: not stored)
+         Int_t fNEfficiencyBins; // number of efficiency bins
+         const Double_t *fEfficiencyBins; // [2*fNEfficiencyBins] {upper pT edge, efficiency} pairs
+         Double_t fEtaCoefficient; // a in 1+a*eta^2
+      };
+
+      AliFlowOnTheFlyTables(); // constructor
+      virtual ~AliFlowOnTheFlyTables(); // destructor
+      Bool_t Open(const char *fileName); // map fileName read-only; all pointers handed out stay valid until Close()
+      void Close();
+      Bool_t IsOpen() const {return this->fData != NULL;}
+      Int_t GetNClasses() const;
+      // Point sampler at the (folded) pt table of class iClass, without copying it:
+      Bool_t AttachPtSampler(Int_t iClass, Bool_t bFolded, AliFlowPtSampler *sampler) const;
+      Bool_t HasFolded(Int_t iClass) const;
+      Int_t GetNEfficiencyBins(Int_t iClass) const;
+      const Double_t* GetEfficiencyBins(Int_t iClass) const; // [2*GetNEfficiencyBins()] {upper pT edge, efficiency} pairs
+      Double_t GetEtaCoefficient(Int_t iClass) const;
+      // Store the tables of nClasses centrality classes (class c in classes[c]) in fileName:
+      static Bool_t Write(const char *fileName, Int_t nClasses, const ClassTables *classes);
+
+   private:
+      AliFlowOnTheFlyTables(const AliFlowOnTheFlyTables& aTables); // copy constructor
+      AliFlowOnTheFlyTables& operator=(const AliFlowOnTheFlyTables& aTables); // assignment operator
+      struct FileHeader; // layout of the file, see the .cxx
+      struct ClassEntry;
+      const ClassEntry* Entry(Int_t iClass) const;
+      Bool_t IsArray(Long64_t offset, Long64_t nBytes) const; // aligned and inside the file?
+      Bool_t IsPtTable(Long64_t lCDF, Long64_t lGuide, Int_t nPoints) const; // a table AliFlowPtSampler can sample from safely?
+      const char *fData; // start of the mapping (NULL: nothing open)
+      Long64_t fSize; // size of the mapping in bytes
+
+   ClassDef(AliFlowOnTheFlyTables,0) // memory-mapped tables of the flow event maker 'on the fly'
+};
+
+#endif
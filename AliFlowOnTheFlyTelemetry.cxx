@@ -0,0 +1,216 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Live counters of the flow event  *
+ * makers 'on the fly', shared with *
+ * a monitor through a mapped file. *
+ ************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Riostream.h"
+#include "AliFlowOnTheFlyTelemetry.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowOnTheFlyTelemetry)
+
+//====================================================================================================================
+
+// File layout: Header, then Slot[fgNSlots]. The counters are lock-free 64-bit atomics, which work across processes
+// sharing the mapping. A generator that detaches keeps its slot, marked finished, so that a monitor still sees its
+// counts. Only when no slot is free does a new generator take over a finished one, adding its counts to the header.
+static const Long64_t gkTelemetryMagic = 0x334d4c5446544f41LL; // "AOTFTLM3"
+
+struct alignas(64) AliFlowOnTheFlyTelemetry::Header{
+   std::atomic<Long64_t> fMagic; // gkTelemetryMagic, set by whoever creates the file
+   Long64_t fNSlots; // fgNSlots
+   std::atomic<Long64_t> fNFinished; // finished generators whose slots were taken over
+   std::atomic<Long64_t> fFinished[kNCounters]; // their counts, ECounter
+};
+
+static const Long64_t gkTelemetrySize = 64+AliFlowOnTheFlyTelemetry::fgNSlots*64;
+
+//====================================================================================================================
+
+AliFlowOnTheFlyTelemetry::AliFlowOnTheFlyTelemetry():
+   fData(NULL),
+   fSlot(NULL)
+{
+   // Constructor.
+
+   static_assert(sizeof(Header) == 64 && sizeof(Slot) == 64,"stats file layout");
+   fPrivate.fState = kRunning;
+   fPrivate.fPid = (Long64_t)getpid();
+   for(Int_t c=0;c<kNCounters;c++){fPrivate.fCounters[c] = 0;}
+   fSlot = &fPrivate;
+
+} // end of AliFlowOnTheFlyTelemetry::AliFlowOnTheFlyTelemetry()
+
+//====================================================================================================================
+
+AliFlowOnTheFlyTelemetry::~AliFlowOnTheFlyTelemetry()
+{
+   // Destructor: the slot is marked finished, its counts stay in the file.
+
+   this->Detach();
+
+} // end of AliFlowOnTheFlyTelemetry::~AliFlowOnTheFlyTelemetry()
+
+//====================================================================================================================
+
+void* AliFlowOnTheFlyTelemetry::Map(const char *fileName, Bool_t bWritable)
+{
+   // Map the stats file fileName; a writer creates it (zero-filled) if it is missing.
+
+   Int_t fd = (bWritable ? open(fileName,O_RDWR|O_CREAT,0644) : open(fileName,O_RDONLY));
+   if(fd < 0){return NULL;}
+   struct stat fileStat;
+   Bool_t bSized = (fstat(fd,&fileStat) == 0 && fileStat.st_size >= gkTelemetrySize);
+   if(!bSized && bWritable){bSized = (ftruncate(fd,gkTelemetrySize) == 0);} // concurrent writers all extend to the same size
+   void *pMap = (bSized ? mmap(NULL,gkTelemetrySize,(bWritable ? PROT_READ|PROT_WRITE : PROT_READ),MAP_SHARED,fd,0) : MAP_FAILED);
+   close(fd); // the mapping keeps the file alive
+   if(pMap == MAP_FAILED){return NULL;}
+
+   Header *pHeader = (Header*)pMap;
+   Long64_t lMagic = 0;
+   if(bWritable && pHeader->fMagic.compare_exchange_strong(lMagic,gkTelemetryMagic)){pHeader->fNSlots = fgNSlots;}
+   if(pHeader->fMagic.load() != gkTelemetryMagic)
+   {
+      munmap(pMap,gkTelemetrySize);
+      return NULL;
+   }
+   return pMap;
+
+} // end of void* AliFlowOnTheFlyTelemetry::Map(const char *fileName, Bool_t bWritable)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTelemetry::Attach(const char *fileName)
+{
+   // Claim a free slot of fileName, else the slot of a finished generator, and count there from now on; the counts so
+   // far are carried over.
+
+   this->Detach();
+   void *pMap = Map(fileName,kTRUE);
+   if(!pMap)
+   {
+      cout<<"WARNING: cannot use "<<fileName<<" as stats file, counting privately."<<endl;
+      return kFALSE;
+   }
+
+   Header *pHeader = (Header*)pMap;
+   Slot *pSlots = (Slot*)((char*)pMap+sizeof(Header));
+   for(Int_t iPass=0;iPass<2;iPass++) // free slots first, finished ones only if none is free
+   {
+      for(Int_t s=0;s<fgNSlots;s++)
+      {
+         Long64_t lState = (iPass == 0 ? kFree : kFinished);
+         if(!pSlots[s].fState.compare_exchange_strong(lState,(Long64_t)kRunning)){continue;}
+         if(iPass == 1)
+         {
+            // Keep the counts of the finished generator in the totals (a monitor may see them twice for a moment):
+            for(Int_t c=0;c<kNCounters;c++){pHeader->fFinished[c].fetch_add(pSlots[s].fCounters[c].load());}
+            pHeader->fNFinished.fetch_add(1);
+         }
+         pSlots[s].fPid = (Long64_t)getpid();
+         for(Int_t c=0;c<kNCounters;c++){pSlots[s].fCounters[c] = fSlot->fCounters[c].load();}
+         fData = pMap;
+         fSlot = &pSlots[s];
+         return kTRUE;
+      }
+   }
+
+   cout<<"WARNING: all "<<fgNSlots<<" slots of "<<fileName<<" are taken, counting privately."<<endl;
+   munmap(pMap,gkTelemetrySize);
+   return kFALSE;
+
+} // end of Bool_t AliFlowOnTheFlyTelemetry::Attach(const char *fileName)
+
+//====================================================================================================================
+
+void AliFlowOnTheFlyTelemetry::Detach()
+{
+   // Mark the slot of the stats file finished: its counts stay there for a monitor (until a new generator finds no free
+   // slot and takes it over) and are kept privately.
+
+   if(!fData){return;}
+   for(Int_t c=0;c<kNCounters;c++){fPrivate.fCounters[c] = fSlot->fCounters[c].load();}
+   fSlot->fState = kFinished;
+   munmap(fData,gkTelemetrySize);
+   fData = NULL;
+   fSlot = &fPrivate;
+
+} // end of void AliFlowOnTheFlyTelemetry::Detach()
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTelemetry::Sum(const char *fileName, Long64_t totals[kNCounters], Int_t &nRunning, Int_t &nFinished)
+{
+   // Add up the counters of all slots of fileName, running or finished, and of the finished generators whose slots were
+   // taken over, read-only. Each counter is read atomically, but not all of them at the same instant, so ratios can be
+   // off by the events of one sweep.
+
+   for(Int_t c=0;c<kNCounters;c++){totals[c] = 0;}
+   nRunning = 0;
+   nFinished = 0;
+   void *pMap = Map(fileName,kFALSE);
+   if(!pMap){return kFALSE;}
+
+   const Header *pHeader = (const Header*)pMap;
+   nFinished = (Int_t)pHeader->fNFinished.load();
+   for(Int_t c=0;c<kNCounters;c++){totals[c] = pHeader->fFinished[c].load(std::memory_order_relaxed);}
+   const Slot *pSlots = (const Slot*)((const char*)pMap+sizeof(Header));
+   for(Int_t s=0;s<fgNSlots;s++)
+   {
+      Long64_t lState = pSlots[s].fState.load();
+      if(lState == kFree){continue;}
+      if(lState == kRunning){nRunning++;} else {nFinished++;}
+      for(Int_t c=0;c<kNCounters;c++){totals[c] += pSlots[s].fCounters[c].load(std::memory_order_relaxed);}
+   }
+   munmap(pMap,gkTelemetrySize);
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyTelemetry::Sum(const char *fileName, Long64_t totals[kNCounters], Int_t &nRunning, Int_t &nFinished)
+
+//====================================================================================================================
+
+Bool_t AliFlowOnTheFlyTelemetry::Reset(const char *fileName)
+{
+   // Free all slots of fileName and zero its totals (creating it if needed). Zeroed in place rather than truncated, so
+   // that a generator still mapping it cannot fault; its counts, however, are lost, so only reset between runs.
+
+   void *pMap = Map(fileName,kTRUE);
+   if(!pMap){return kFALSE;}
+   Header *pHeader = (Header*)pMap;
+   pHeader->fNFinished = 0;
+   for(Int_t c=0;c<kNCounters;c++){pHeader->fFinished[c] = 0;}
+   Slot *pSlots = (Slot*)((char*)pMap+sizeof(Header));
+   for(Int_t s=0;s<fgNSlots;s++)
+   {
+      for(Int_t c=0;c<kNCounters;c++){pSlots[s].fCounters[c] = 0;}
+      pSlots[s].fPid = 0;
+      pSlots[s].fState = kFree;
+   }
+   munmap(pMap,gkTelemetrySize);
+   return kTRUE;
+
+} // end of Bool_t AliFlowOnTheFlyTelemetry::Reset(const char *fileName)
+
+//====================================================================================================================
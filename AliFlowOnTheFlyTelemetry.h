@@ -0,0 +1,71 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Live counters of the flow event  *
+ * makers 'on the fly', shared with *
+ * a monitor through a mapped file. *
+ ************************************/
+
+#ifndef ALIFLOWONTHEFLYTELEMETRY_H
+#define ALIFLOWONTHEFLYTELEMETRY_H
+
+#include <atomic>
+
+#include "Rtypes.h"
+
+class AliFlowOnTheFlyTelemetry{
+   public:
+      enum ECounter {kEvents, kTracksGenerated, kTracksRejected, kRPs, kPOIs, kNCounters};
+      enum EState {kFree = 0, kRunning = 1, kFinished = 2}; // of a slot
+      static const Int_t fgNSlots = 1024; // generators that can publish to one file
+
+      AliFlowOnTheFlyTelemetry(); // constructor
+      virtual ~AliFlowOnTheFlyTelemetry(); // destructor
+      // Publish the counters in a slot of the stats file fileName (created if needed; e.g. in /dev/shm to stay in
+      // memory). Without it, or if it fails, the counters are kept privately:
+      Bool_t Attach(const char *fileName);
+      Bool_t IsShared() const {return this->fData != NULL;}
+      // Add one event. Each slot has a single writer, so a relaxed load and store suffices: no locked instruction,
+      // no fence, and the slot's cache line is never shared with another writer.
+      void CountEvent(Long64_t nGenerated, Long64_t nRejected, Long64_t nRPs, Long64_t nPOIs)
+      {
+         Add(kEvents,1);
+         Add(kTracksGenerated,nGenerated);
+         Add(kTracksRejected,nRejected);
+         Add(kRPs,nRPs);
+         Add(kPOIs,nPOIs);
+      }
+      Long64_t Get(ECounter counter) const {return this->fSlot->fCounters[counter].load(std::memory_order_relaxed);}
+      // For a monitor: sum the counters of all slots in fileName and of the generators whose slots were taken over;
+      // nRunning counts the generators still attached, nFinished those that detached.
+      static Bool_t Sum(const char *fileName, Long64_t totals[kNCounters], Int_t &nRunning, Int_t &nFinished);
+      static Bool_t Reset(const char *fileName); // forget all slots, e.g. before a new run
+
+   private:
+      AliFlowOnTheFlyTelemetry(const AliFlowOnTheFlyTelemetry& aTelemetry); // copy constructor
+      AliFlowOnTheFlyTelemetry& operator=(const AliFlowOnTheFlyTelemetry& aTelemetry); // assignment operator
+      struct alignas(64) Slot{ // one cache line per generator
+         std::atomic<Long64_t> fState; // EState
+         std::atomic<Long64_t> fPid; // process of the generator
+         std::atomic<Long64_t> fCounters[kNCounters]; // ECounter
+      };
+      struct Header;
+      static void* Map(const char *fileName, Bool_t bWritable);
+      void Add(ECounter counter, Long64_t n)
+      {
+         std::atomic<Long64_t> &c = fSlot->fCounters[counter];
+         c.store(c.load(std::memory_order_relaxed)+n,std::memory_order_relaxed);
+      }
+      void Detach();
+      void *fData; // mapping of the stats file (NULL: private counters)
+      Slot *fSlot; // where this generator counts: a slot of the file or fPrivate
+      Slot fPrivate; // counters when not shared
+
+   ClassDef(AliFlowOnTheFlyTelemetry,0) // live counters of the flow event maker 'on the fly'
+};
+
+#endif
@@ -0,0 +1,196 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Counter-based random number      *
+ * generator (Philox4x32-10) keyed  *
+ * by (seed, stream, event index).  *
+ *                                  *
+ * Salmon et al., "Parallel random  *
+ * numbers: as easy as 1, 2, 3",    *
+ * SC11.                            *
+ ************************************/
+
+#include "TUUID.h"
+#include "AliFlowSIMD.h"
+#include "AliFlowPhiloxRandom.h"
+
+ClassImp(AliFlowPhiloxRandom)
+
+//====================================================================================================================
+
+AliFlowPhiloxRandom::AliFlowPhiloxRandom(UInt_t uiSeed, UInt_t uiStream):
+   TRandom(),
+   fIndex(4)
+{
+   // Constructor.
+
+   fKey[0] = 0;
+   fKey[1] = uiStream;
+   for(Int_t i=0;i<4;i++){fCounter[i] = 0; fBuffer[i] = 0;}
+   this->SetSeed(uiSeed);
+
+} // end of AliFlowPhiloxRandom::AliFlowPhiloxRandom(UInt_t uiSeed, UInt_t uiStream)
+
+//====================================================================================================================
+
+void AliFlowPhiloxRandom::SetSeed(ULong_t seed)
+{
+   // Set the seed (first key word) and rewind to the start of the current event.
+
+   if(seed == 0)
+   {
+      TUUID uid;
+      UChar_t uuid[16];
+      uid.GetUUID(uuid);
+      UInt_t uiSeed = 0;
+      for(Int_t i=0;i<16;i++){uiSeed ^= ((UInt_t)uuid[i]) << (8*(i%4));}
+      seed = (uiSeed != 0 ? uiSeed : 4357);
+   }
+   fKey[0] = (UInt_t)seed;
+   this->SetEvent(this->GetEvent());
+
+} // end of void AliFlowPhiloxRandom::SetSeed(ULong_t seed)
+
+//====================================================================================================================
+
+void AliFlowPhiloxRandom::Philox(const UInt_t counter[4], const UInt_t key[2], UInt_t result[4])
+{
+   // Philox4x32 with 10 rounds.
+
+   const ULong64_t kM0 = 0xD2511F53ULL;
+   const ULong64_t kM1 = 0xCD9E8D57ULL;
+   const UInt_t kW0 = 0x9E3779B9U;
+   const UInt_t kW1 = 0xBB67AE85U;
+
+   UInt_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+   UInt_t k0 = key[0], k1 = key[1];
+   for(Int_t r=0;r<10;r++)
+   {
+      ULong64_t p0 = kM0*c0;
+      ULong64_t p1 = kM1*c2;
+      UInt_t n0 = (UInt_t)(p1 >> 32) ^ c1 ^ k0;
+      UInt_t n1 = (UInt_t)p1;
+      UInt_t n2 = (UInt_t)(p0 >> 32) ^ c3 ^ k1;
+      UInt_t n3 = (UInt_t)p0;
+      c0 = n0; c1 = n1; c2 = n2; c3 = n3;
+      k0 += kW0;
+      k1 += kW1;
+   }
+   result[0] = c0; result[1] = c1; result[2] = c2; result[3] = c3;
+
+} // end of void AliFlowPhiloxRandom::Philox(const UInt_t counter[4], const UInt_t key[2], UInt_t result[4])
+
+//====================================================================================================================
+
+Double_t AliFlowPhiloxRandom::Rndm()
+{
+   // Uniform number in the open interval (0,1) with 32 bits of resolution (as TRandom3).
+
+   return (NextUInt()+0.5)*2.3283064365386963e-10;
+
+} // end of Double_t AliFlowPhiloxRandom::Rndm()
+
+//====================================================================================================================
+
+ALIFLOW_SIMD_CLONES
+void AliFlowPhiloxRandom::PhiloxArray(ULong64_t block, UInt_t e0, UInt_t e1, const UInt_t key[2], Int_t nBlocks, Double_t *array)
+{
+   // Same rounds as Philox(), but over 16 independent counters at a time so that the loops vectorize.
+
+   const ULong64_t kM0 = 0xD2511F53ULL;
+   const ULong64_t kM1 = 0xCD9E8D57ULL;
+   const UInt_t kW0 = 0x9E3779B9U;
+   const UInt_t kW1 = 0xBB67AE85U;
+   const Int_t kChunk = 16;
+
+   UInt_t c0[kChunk], c1[kChunk], c2[kChunk], c3[kChunk];
+   for(Int_t b0=0;b0<nBlocks;b0+=kChunk)
+   {
+      for(Int_t b=0;b<kChunk;b++)
+      {
+         ULong64_t lCounter = block+b0+b;
+         c0[b] = (UInt_t)lCounter;
+         c1[b] = (UInt_t)(lCounter >> 32);
+         c2[b] = e0;
+         c3[b] = e1;
+      }
+      UInt_t k0 = key[0], k1 = key[1];
+      for(Int_t r=0;r<10;r++)
+      {
+         for(Int_t b=0;b<kChunk;b++)
+         {
+            ULong64_t p0 = kM0*c0[b];
+            ULong64_t p1 = kM1*c2[b];
+            UInt_t n0 = (UInt_t)(p1 >> 32) ^ c1[b] ^ k0;
+            UInt_t n1 = (UInt_t)p1;
+            UInt_t n2 = (UInt_t)(p0 >> 32) ^ c3[b] ^ k1;
+            UInt_t n3 = (UInt_t)p0;
+            c0[b] = n0; c1[b] = n1; c2[b] = n2; c3[b] = n3;
+         }
+         k0 += kW0;
+         k1 += kW1;
+      }
+      Int_t m = (nBlocks-b0 < kChunk ? nBlocks-b0 : kChunk);
+      Double_t *out = array+4*b0;
+      for(Int_t b=0;b<m;b++)
+      {
+         out[4*b] = (c0[b]+0.5)*2.3283064365386963e-10;
+         out[4*b+1] = (c1[b]+0.5)*2.3283064365386963e-10;
+         out[4*b+2] = (c2[b]+0.5)*2.3283064365386963e-10;
+         out[4*b+3] = (c3[b]+0.5)*2.3283064365386963e-10;
+      }
+   }
+
+} // end of void AliFlowPhiloxRandom::PhiloxArray(ULong64_t block, UInt_t e0, UInt_t e1, const UInt_t key[2], Int_t nBlocks, Double_t *array)
+
+//====================================================================================================================
+
+void AliFlowPhiloxRandom::RndmArray(Int_t n, Double_t *array)
+{
+   // Fill array with n uniform numbers in (0,1); the same numbers as n calls of Rndm().
+
+   // a) Use up the current block:
+   Int_t i = 0;
+   while(i < n && fIndex < 4){array[i++] = (fBuffer[fIndex++]+0.5)*2.3283064365386963e-10;}
+
+   // b) Whole blocks at once:
+   Int_t nBlocks = (n-i)/4;
+   if(nBlocks > 0)
+   {
+      ULong64_t lBlock = ((ULong64_t)fCounter[1] << 32) | fCounter[0];
+      PhiloxArray(lBlock,fCounter[2],fCounter[3],fKey,nBlocks,array+i);
+      lBlock += nBlocks;
+      fCounter[0] = (UInt_t)lBlock;
+      fCounter[1] = (UInt_t)(lBlock >> 32);
+      i += 4*nBlocks;
+   }
+
+   // c) The rest from a fresh block:
+   for(;i<n;i++){array[i] = (NextUInt()+0.5)*2.3283064365386963e-10;}
+
+} // end of void AliFlowPhiloxRandom::RndmArray(Int_t n, Double_t *array)
+
+//====================================================================================================================
+
+void AliFlowPhiloxRandom::RndmArray(Int_t n, Float_t *array)
+{
+   // Fill array with n uniform numbers in (0,1); 24 bits are kept so that the result never rounds to 1.
+
+   for(Int_t i=0;i<n;i++){array[i] = (Float_t)(((NextUInt() >> 8)+0.5)*5.9604644775390625e-08);}
+
+} // end of void AliFlowPhiloxRandom::RndmArray(Int_t n, Float_t *array)
+
+//====================================================================================================================
@@ -0,0 +1,65 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Counter-based random number      *
+ * generator (Philox4x32-10) keyed  *
+ * by (seed, stream, event index).  *
+ ************************************/
+
+#ifndef ALIFLOWPHILOXRANDOM_H
+#define ALIFLOWPHILOXRANDOM_H
+
+#include "TRandom.h"
+
+class AliFlowPhiloxRandom : public TRandom {
+   public:
+      AliFlowPhiloxRandom(UInt_t uiSeed = 0, UInt_t uiStream = 0); // constructor
+      virtual ~AliFlowPhiloxRandom() {} // destructor
+      virtual Double_t Rndm();
+      virtual void RndmArray(Int_t n, Double_t *array);
+      virtual void RndmArray(Int_t n, Float_t *array);
+      virtual void SetSeed(ULong_t seed = 0); // if seed is 0, the seed is determined uniquely in space and time via TUUID
+      virtual UInt_t GetSeed() const {return this->fKey[0];}
+      void SetStream(UInt_t uiStream) {this->fKey[1] = uiStream; this->SetEvent(this->GetEvent());}
+      UInt_t GetStream() const {return this->fKey[1];}
+      // Position the generator at the first number of event iEvent; events can be visited in any order.
+      void SetEvent(ULong64_t iEvent)
+      {
+         fCounter[0] = 0;
+         fCounter[1] = 0;
+         fCounter[2] = (UInt_t)(iEvent & 0xFFFFFFFFULL);
+         fCounter[3] = (UInt_t)(iEvent >> 32);
+         fIndex = 4;
+      }
+      ULong64_t GetEvent() const {return ((ULong64_t)fCounter[3] << 32) | fCounter[2];}
+      static void Philox(const UInt_t counter[4], const UInt_t key[2], UInt_t result[4]);
+      // Blocks block, block+1, ... of event (e0,e1) as 4*nBlocks uniform numbers, many blocks per SIMD register:
+      static void PhiloxArray(ULong64_t block, UInt_t e0, UInt_t e1, const UInt_t key[2], Int_t nBlocks, Double_t *array);
+
+   private:
+      AliFlowPhiloxRandom(const AliFlowPhiloxRandom& aRandom); // copy constructor
+      AliFlowPhiloxRandom& operator=(const AliFlowPhiloxRandom& aRandom); // assignment operator
+      // Next 32 random bits of the current event:
+      UInt_t NextUInt()
+      {
+         if(fIndex == 4)
+         {
+            Philox(fCounter,fKey,fBuffer);
+            if(++fCounter[0] == 0){++fCounter[1];}
+            fIndex = 0;
+         }
+         return fBuffer[fIndex++];
+      }
+      UInt_t fKey[2]; // (seed, stream)
+      UInt_t fCounter[4]; // (block low, block high, event low, event high)
+      UInt_t fBuffer[4]; // output of the last Philox block
+      Int_t fIndex; // next unused word in fBuffer
+
+   ClassDef(AliFlowPhiloxRandom,0) // counter-based random number generator
+};
+
+#endif
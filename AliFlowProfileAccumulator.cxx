@@ -0,0 +1,604 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Flat arrays that take the fills  *
+ * of a group of profiles on one    *
+ * axis, fixed or growing with the  *
+ * fills, added to ROOT profiles    *
+ * only on Flush(), and the binning *
+ * of their axes.                   *
+ ************************************/
+
+#include <algorithm>
+
+#include "Riostream.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TAxis.h"
+#include "AliFlowProfileAccumulator.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowAxisBinner)
+ClassImp(AliFlowProfileAccumulator)
+ClassImp(AliFlowAutoRangeProfileAccumulator)
+
+//====================================================================================================================
+
+AliFlowAxisBinner::AliFlowAxisBinner():
+   fNBins(0),
+   fMin(0.),
+   fMax(0.),
+   fScale(0.)
+{
+   // Constructor.
+
+} // end of AliFlowAxisBinner::AliFlowAxisBinner()
+
+//====================================================================================================================
+
+void AliFlowAxisBinner::Set(Int_t nBins, Double_t min, Double_t max)
+{
+   // Uniform bins: bin = 1 + (Int_t)(nBins*(x-min)/(max-min)), with the very operations of TAxis::FindBin(), so that
+   // no x rounds into another bin than it would in the profiles.
+
+   fNBins = nBins;
+   fMin = min;
+   fMax = max;
+   fScale = 0.;
+   fEdges.clear();
+   fLookup.clear();
+
+} // end of void AliFlowAxisBinner::Set(Int_t nBins, Double_t min, Double_t max)
+
+//====================================================================================================================
+
+void AliFlowAxisBinner::Set(Int_t nBins, const Double_t *edges)
+{
+   // Variable bins: fgCellsPerBin uniform cells per bin on average, each pointing to the lowest bin it overlaps.
+
+   if(nBins < 1)
+   {
+      // A single edge (or none): only under- and overflow.
+      this->Set(0,(nBins == 0 ? edges[0] : 0.),(nBins == 0 ? edges[0] : 0.));
+      return;
+   }
+   fNBins = nBins;
+   fMin = edges[0];
+   fMax = edges[nBins];
+   fEdges.assign(edges,edges+nBins+1);
+   Int_t nCells = fgCellsPerBin*nBins;
+   fScale = nCells/(fMax-fMin);
+   fLookup.resize(nCells);
+   Int_t iBin = 1;
+   for(Int_t c=0;c<nCells;c++)
+   {
+      Double_t dCellLow = fMin+c/fScale;
+      while(iBin < nBins && !(dCellLow < fEdges[iBin])){iBin++;}
+      fLookup[c] = iBin;
+   }
+
+} // end of void AliFlowAxisBinner::Set(Int_t nBins, const Double_t *edges)
+
+//====================================================================================================================
+
+void AliFlowAxisBinner::Set(const TAxis *axis)
+{
+   // The bins of axis.
+
+   if(axis->IsVariableBinSize())
+   {
+      this->Set(axis->GetNbins(),axis->GetXbins()->GetArray());
+   } else
+   {
+      this->Set(axis->GetNbins(),axis->GetXmin(),axis->GetXmax());
+   }
+
+} // end of void AliFlowAxisBinner::Set(const TAxis *axis)
+
+//====================================================================================================================
+
+AliFlowProfileAccumulator::AliFlowProfileAccumulator():
+   fNProfiles(0),
+   fNBinsX(0),
+   fNBinsY(0),
+   fNCells(0)
+{
+   // Constructor.
+
+} // end of AliFlowProfileAccumulator::AliFlowProfileAccumulator()
+
+//====================================================================================================================
+
+void AliFlowProfileAccumulator::Book(Int_t nProfiles, Int_t nBinsX, Double_t xMin, Double_t xMax, Int_t nBinsY, Double_t yMin, Double_t yMax)
+{
+   // Allocate the sums of nProfiles profiles; the axes have to be those of the profiles given to SetProfile().
+
+   fAxisX.Set(nBinsX,xMin,xMax);
+   fAxisY.Set(nBinsY,yMin,yMax);
+   this->Allocate(nProfiles);
+
+} // end of void AliFlowProfileAccumulator::Book(...)
+
+//====================================================================================================================
+
+void AliFlowProfileAccumulator::Book(Int_t nProfiles, const TAxis *xAxis, const TAxis *yAxis)
+{
+   // Allocate the sums of nProfiles profiles with the bins of xAxis (and yAxis).
+
+   fAxisX.Set(xAxis);
+   if(yAxis)
+   {
+      fAxisY.Set(yAxis);
+   } else
+   {
+      fAxisY.Set(0,0.,0.);
+   }
+   this->Allocate(nProfiles);
+
+} // end of void AliFlowProfileAccumulator::Book(Int_t nProfiles, const TAxis *xAxis, const TAxis *yAxis)
+
+//====================================================================================================================
+
+void AliFlowProfileAccumulator::Allocate(Int_t nProfiles)
+{
+   // The sums of nProfiles profiles on fAxisX (and fAxisY), all zero.
+
+   fNProfiles = nProfiles;
+   fNBinsX = fAxisX.GetNBins();
+   fNBinsY = fAxisY.GetNBins();
+   fNCells = (fNBinsX+2)*(fNBinsY > 0 ? fNBinsY+2 : 1);
+   fSums.assign(2*(size_t)fNCells*fNProfiles*fgNSums,0.);
+   fStats.assign(2*(size_t)fNProfiles*fgNStats,0.);
+   fEntries.assign(fNProfiles,0);
+   fProfiles.assign(fNProfiles,(TH1*)NULL);
+
+} // end of void AliFlowProfileAccumulator::Allocate(Int_t nProfiles)
+
+//====================================================================================================================
+
+void AliFlowProfileAccumulator::SetProfile(Int_t p, TProfile *profile)
+{
+   // Profile p goes to profile on Flush().
+
+   if(p < 0 || p >= fNProfiles || fNBinsY > 0)
+   {
+      cout<<"WARNING: AliFlowProfileAccumulator::SetProfile(): no profile in one dimension "<<p<<" booked."<<endl;
+      return;
+   }
+   fProfiles[p] = profile;
+
+} // end of void AliFlowProfileAccumulator::SetProfile(Int_t p, TProfile *profile)
+
+//====================================================================================================================
+
+void AliFlowProfileAccumulator::SetProfile(Int_t p, TProfile2D *profile)
+{
+   // Profile p goes to profile on Flush().
+
+   if(p < 0 || p >= fNProfiles || fNBinsY == 0)
+   {
+      cout<<"WARNING: AliFlowProfileAccumulator::SetProfile(): no profile in two dimensions "<<p<<" booked."<<endl;
+      return;
+   }
+   fProfiles[p] = profile;
+
+} // end of void AliFlowProfileAccumulator::SetProfile(Int_t p, TProfile2D *profile)
+
+//====================================================================================================================
+
+void AliFlowProfileAccumulator::Flush()
+{
+   // Add the sums of every profile that was filled since the last Flush() to its ROOT profile.
+
+   for(Int_t p=0;p<fNProfiles;p++)
+   {
+      if(fEntries[p] == 0 || !fProfiles[p]){continue;}
+      if(fNBinsY > 0)
+      {
+         this->AddToProfile(static_cast<TProfile2D*>(fProfiles[p]),p);
+      } else
+      {
+         this->AddToProfile(static_cast<TProfile*>(fProfiles[p]),p);
+      }
+   }
+   this->Reset();
+
+} // end of void AliFlowProfileAccumulator::Flush()
+
+//====================================================================================================================
+
+Bool_t AliFlowProfileAccumulator::Merge(const AliFlowProfileAccumulator &other)
+{
+   // Add the sums of other, booked with the same profiles and bins, to these, bin by bin; other is left as it is.
+
+   if(other.fNProfiles != fNProfiles || other.fNBinsX != fNBinsX || other.fNBinsY != fNBinsY || other.fNCells != fNCells)
+   {
+      cout<<"WARNING: AliFlowProfileAccumulator::Merge(): other is booked differently, not merged."<<endl;
+      return kFALSE;
+   }
+   // Both halves of a compensated sum of other, the sum and minus its compensation:
+   for(size_t k=0;k<fSums.size();k+=2)
+   {
+      AddCompensated(fSums[k],fSums[k+1],other.fSums[k]);
+      AddCompensated(fSums[k],fSums[k+1],-other.fSums[k+1]);
+   }
+   for(size_t k=0;k<fStats.size();k+=2)
+   {
+      AddCompensated(fStats[k],fStats[k+1],other.fStats[k]);
+      AddCompensated(fStats[k],fStats[k+1],-other.fStats[k+1]);
+   }
+   for(Int_t p=0;p<fNProfiles;p++){fEntries[p] += other.fEntries[p];}
+   return kTRUE;
+
+} // end of Bool_t AliFlowProfileAccumulator::Merge(const AliFlowProfileAccumulator &other)
+
+//====================================================================================================================
+
+void AliFlowProfileAccumulator::Reset()
+{
+   // Zero all sums.
+
+   fSums.assign(fSums.size(),0.);
+   fStats.assign(fStats.size(),0.);
+   fEntries.assign(fEntries.size(),0);
+
+} // end of void AliFlowProfileAccumulator::Reset()
+
+//====================================================================================================================
+
+template<class TProfileType>
+static Double_t* BinSumw2Array(TProfileType *profile, Bool_t bWeighted)
+{
+   // fBinSumw2 of profile, or NULL if it has none. As TProfile::Fill() and TProfile2D::Fill() do at the first fill
+   // with a weight other than 1, it is created first (from the bin entries, i.e. sum w^2 of the unit weights so far)
+   // if bWeighted, unless the profile is flagged TH1::kIsNotW.
+
+   TArrayD *binSumw2 = profile->GetBinSumw2();
+   if((!binSumw2 || binSumw2->GetSize() == 0) && bWeighted && !profile->TestBit(TH1::kIsNotW))
+   {
+      profile->Sumw2();
+      binSumw2 = profile->GetBinSumw2();
+   }
+   return (binSumw2 && binSumw2->GetSize() > 0 ? binSumw2->GetArray() : NULL);
+
+} // end of static Double_t* BinSumw2Array(TProfileType *profile, Bool_t bWeighted)
+
+//====================================================================================================================
+
+template<class TProfileType>
+void AliFlowProfileAccumulator::AddToProfile(TProfileType *profile, Int_t p) const
+{
+   // The updates of TProfile::Fill() and TProfile2D::Fill(), summed: the bin content takes sum wy, fSumw2 sum wy^2,
+   // the bin entries sum w and fBinSumw2 sum w^2. A profile without fBinSumw2 gets it if any bin was filled with
+   // weights other than 1, seen as sum w^2 != sum w.
+
+   if(profile->GetNcells() != fNCells)
+   {
+      cout<<"WARNING: AliFlowProfileAccumulator: "<<profile->GetName()<<" has other bins than booked, not filled."<<endl;
+      return;
+   }
+
+   // The statistics first, as GetStats() of a profile without any recomputes them from its bins:
+   Double_t stats[fgNStats] = {0.};
+   profile->GetStats(stats);
+   for(Int_t s=0;s<fgNStats;s++){stats[s] += fStats[2*(p*fgNStats+s)]-fStats[2*(p*fgNStats+s)+1];}
+
+   Bool_t bWeighted = kFALSE;
+   for(Int_t bin=0;bin<fNCells && !bWeighted;bin++)
+   {
+      const Double_t *sums = &fSums[2*((size_t)bin*fNProfiles+p)*fgNSums];
+      bWeighted = (sums[6]-sums[7] != sums[0]-sums[1]);
+   }
+   Double_t *binSumw2Array = BinSumw2Array(profile,bWeighted);
+   Double_t *content = profile->GetArray();
+   Double_t *sumw2 = profile->GetSumw2()->GetArray();
+   for(Int_t bin=0;bin<fNCells;bin++)
+   {
+      const Double_t *sums = &fSums[2*((size_t)bin*fNProfiles+p)*fgNSums];
+      if(sums[6] == 0.){continue;} // not filled (or only with zero weights)
+      content[bin] += sums[2]-sums[3];
+      sumw2[bin] += sums[4]-sums[5];
+      profile->SetBinEntries(bin,profile->GetBinEntries(bin)+(sums[0]-sums[1]));
+      if(binSumw2Array){binSumw2Array[bin] += sums[6]-sums[7];}
+   }
+
+   profile->PutStats(stats);
+   profile->SetEntries(profile->GetEntries()+fEntries[p]);
+
+} // end of void AliFlowProfileAccumulator::AddToProfile(TProfileType *profile, Int_t p) const
+
+//====================================================================================================================
+
+AliFlowAutoRangeProfileAccumulator::AliFlowAutoRangeProfileAccumulator():
+   fNProfiles(0),
+   fWidth(1.),
+   fOrigin(0.),
+   fLowBin(0),
+   fNBins(0)
+{
+   // Constructor.
+
+} // end of AliFlowAutoRangeProfileAccumulator::AliFlowAutoRangeProfileAccumulator()
+
+//====================================================================================================================
+
+void AliFlowAutoRangeProfileAccumulator::Book(Int_t nProfiles, Double_t binWidth, Double_t origin)
+{
+   // nProfiles profiles without any bins yet, on the grid of bins of width binWidth with an edge at origin.
+
+   if(!(binWidth > 0.))
+   {
+      cout<<"WARNING: AliFlowAutoRangeProfileAccumulator::Book(): bin width "<<binWidth<<" is not positive, 1 taken."<<endl;
+      binWidth = 1.;
+   }
+   fNProfiles = nProfiles;
+   fWidth = binWidth;
+   fOrigin = origin;
+   fLowBin = 0;
+   fNBins = 0;
+   fSums.clear();
+   fStats.assign(2*(size_t)fNProfiles*fgNStats,0.);
+   fEntries.assign(fNProfiles,0);
+   fProfiles.assign(fNProfiles,(TProfile*)NULL);
+
+} // end of void AliFlowAutoRangeProfileAccumulator::Book(Int_t nProfiles, Double_t binWidth, Double_t origin)
+
+//====================================================================================================================
+
+void AliFlowAutoRangeProfileAccumulator::SetProfile(Int_t p, TProfile *profile)
+{
+   // Profile p goes to profile on Flush(); its bins have to lie on the grid.
+
+   if(p < 0 || p >= fNProfiles)
+   {
+      cout<<"WARNING: AliFlowAutoRangeProfileAccumulator::SetProfile(): no profile "<<p<<" booked."<<endl;
+      return;
+   }
+   fProfiles[p] = profile;
+
+} // end of void AliFlowAutoRangeProfileAccumulator::SetProfile(Int_t p, TProfile *profile)
+
+//====================================================================================================================
+
+void AliFlowAutoRangeProfileAccumulator::Grow(Int_t bin)
+{
+   // Widen the window of bins to bin, moving the sums along when it grows downwards.
+
+   Int_t iNewLowBin = (fNBins > 0 ? TMath::Min(fLowBin,bin) : bin);
+   Int_t iNewHighBin = (fNBins > 0 ? TMath::Max(fLowBin+fNBins-1,bin) : bin);
+   Int_t nNewBins = iNewHighBin-iNewLowBin+1;
+   std::vector<Double_t> sums(2*(size_t)nNewBins*fNProfiles*fgNSums,0.);
+   if(fNBins > 0)
+   {
+      std::copy(fSums.begin(),fSums.end(),sums.begin()+2*(size_t)(fLowBin-iNewLowBin)*fNProfiles*fgNSums);
+   }
+   fSums.swap(sums);
+   fLowBin = iNewLowBin;
+   fNBins = nNewBins;
+
+} // end of void AliFlowAutoRangeProfileAccumulator::Grow(Int_t bin)
+
+//====================================================================================================================
+
+void AliFlowAutoRangeProfileAccumulator::Flush()
+{
+   // Add the sums of every profile that was filled since the last Flush() to its ROOT profile, extended first to
+   // cover the window.
+
+   for(Int_t p=0;p<fNProfiles;p++)
+   {
+      if(fEntries[p] == 0 || !fProfiles[p]){continue;}
+      TProfile *profile = fProfiles[p];
+      Int_t iLowBin = 0;
+      if(!this->Extend(profile,iLowBin)){continue;}
+
+      // The statistics first, as GetStats() of a profile without any recomputes them from its bins:
+      Double_t stats[fgNStats] = {0.};
+      profile->GetStats(stats);
+      for(Int_t s=0;s<fgNStats;s++){stats[s] += fStats[2*(p*fgNStats+s)]-fStats[2*(p*fgNStats+s)+1];}
+
+      // fBinSumw2 created as in AddToProfile() of AliFlowProfileAccumulator:
+      Bool_t bWeighted = kFALSE;
+      for(Int_t b=0;b<fNBins && !bWeighted;b++)
+      {
+         const Double_t *sums = &fSums[2*((size_t)b*fNProfiles+p)*fgNSums];
+         bWeighted = (sums[6]-sums[7] != sums[0]-sums[1]);
+      }
+      Double_t *binSumw2Array = BinSumw2Array(profile,bWeighted);
+      Double_t *content = profile->GetArray();
+      Double_t *sumw2 = profile->GetSumw2()->GetArray();
+      for(Int_t b=0;b<fNBins;b++)
+      {
+         const Double_t *sums = &fSums[2*((size_t)b*fNProfiles+p)*fgNSums];
+         if(sums[6] == 0.){continue;} // not filled (or only with zero weights)
+         Int_t bin = fLowBin+b-iLowBin+1;
+         content[bin] += sums[2]-sums[3];
+         sumw2[bin] += sums[4]-sums[5];
+         profile->SetBinEntries(bin,profile->GetBinEntries(bin)+(sums[0]-sums[1]));
+         if(binSumw2Array){binSumw2Array[bin] += sums[6]-sums[7];}
+      }
+
+      profile->PutStats(stats);
+      profile->SetEntries(profile->GetEntries()+fEntries[p]);
+   }
+   this->Reset();
+
+} // end of void AliFlowAutoRangeProfileAccumulator::Flush()
+
+//====================================================================================================================
+
+void AliFlowAutoRangeProfileAccumulator::Reset()
+{
+   // Zero all sums; the window stays, as the same bins are likely to be filled again.
+
+   fSums.assign(fSums.size(),0.);
+   fStats.assign(fStats.size(),0.);
+   fEntries.assign(fEntries.size(),0);
+
+} // end of void AliFlowAutoRangeProfileAccumulator::Reset()
+
+//====================================================================================================================
+
+Bool_t AliFlowAutoRangeProfileAccumulator::Extend(TProfile *profile, Int_t &lowBin) const
+{
+   // Widen the range of profile to cover the window, on the grid, with all it holds in the same bins; an empty
+   // profile takes exactly the window. lowBin is the grid bin of the first bin of profile afterwards.
+
+   // a) Where the profile lies on the grid;
+   // b) Keep its bins, under- and overflow included, its statistics and entries;
+   // c) Rebin it and put them back, shifted.
+
+   // a) Where the profile lies on the grid:
+   if(!this->FindLowBin(profile,lowBin)){return kFALSE;}
+   Int_t nBins = profile->GetNbinsX();
+   Bool_t bEmpty = (profile->GetEntries() == 0.);
+   Int_t iNewLowBin = (bEmpty ? fLowBin : TMath::Min(lowBin,fLowBin));
+   Int_t iNewHighBin = (bEmpty ? fLowBin+fNBins-1 : TMath::Max(lowBin+nBins-1,fLowBin+fNBins-1));
+   if(iNewLowBin == lowBin && iNewHighBin == lowBin+nBins-1){return kTRUE;}
+
+   // b) Keep its bins, under- and overflow included, its statistics and entries:
+   Double_t stats[fgNStats] = {0.};
+   profile->GetStats(stats);
+   Double_t dEntries = profile->GetEntries();
+   std::vector<Double_t> oldBins((size_t)(nBins+2)*fgNSums,0.);
+   TArrayD *binSumw2 = profile->GetBinSumw2();
+   Bool_t bBinSumw2 = (binSumw2 && binSumw2->GetSize() > 0);
+   for(Int_t bin=0;bin<nBins+2 && !bEmpty;bin++)
+   {
+      oldBins[bin*fgNSums] = profile->GetBinEntries(bin);
+      oldBins[bin*fgNSums+1] = profile->GetArray()[bin];
+      oldBins[bin*fgNSums+2] = profile->GetSumw2()->GetArray()[bin];
+      oldBins[bin*fgNSums+3] = (bBinSumw2 ? binSumw2->GetArray()[bin] : 0.);
+   }
+
+   // c) Rebin it and put them back, shifted:
+   Int_t nNewBins = iNewHighBin-iNewLowBin+1;
+   profile->SetBins(nNewBins,fOrigin+iNewLowBin*fWidth,fOrigin+(iNewHighBin+1)*fWidth);
+   profile->Reset();
+   if(!bEmpty)
+   {
+      binSumw2 = profile->GetBinSumw2();
+      for(Int_t bin=0;bin<nBins+2;bin++)
+      {
+         Int_t newBin = (bin == 0 ? 0 : (bin == nBins+1 ? nNewBins+1 : bin+lowBin-iNewLowBin));
+         profile->SetBinEntries(newBin,oldBins[bin*fgNSums]);
+         profile->GetArray()[newBin] = oldBins[bin*fgNSums+1];
+         profile->GetSumw2()->GetArray()[newBin] = oldBins[bin*fgNSums+2];
+         if(bBinSumw2){binSumw2->GetArray()[newBin] = oldBins[bin*fgNSums+3];}
+      }
+      profile->PutStats(stats);
+      profile->SetEntries(dEntries);
+   }
+   lowBin = iNewLowBin;
+   return kTRUE;
+
+} // end of Bool_t AliFlowAutoRangeProfileAccumulator::Extend(TProfile *profile, Int_t &lowBin) const
+
+//====================================================================================================================
+
+Bool_t AliFlowAutoRangeProfileAccumulator::FindLowBin(const TProfile *profile, Int_t &lowBin) const
+{
+   // The grid bin of the first bin of profile, if profile has bins of the grid.
+
+   const TAxis *axis = profile->GetXaxis();
+   if(axis->IsVariableBinSize() || TMath::Abs(axis->GetBinWidth(1)-fWidth) > 1.e-9*fWidth)
+   {
+      cout<<"WARNING: AliFlowAutoRangeProfileAccumulator: "<<profile->GetName()<<" has other bins than booked, not filled."<<endl;
+      return kFALSE;
+   }
+   Double_t dLowBin = (axis->GetXmin()-fOrigin)/fWidth;
+   lowBin = TMath::Nint(dLowBin);
+   if(TMath::Abs(dLowBin-lowBin) > 1.e-6)
+   {
+      cout<<"WARNING: AliFlowAutoRangeProfileAccumulator: "<<profile->GetName()<<" is not on the grid, not filled."<<endl;
+      return kFALSE;
+   }
+   return kTRUE;
+
+} // end of Bool_t AliFlowAutoRangeProfileAccumulator::FindLowBin(const TProfile *profile, Int_t &lowBin) const
+
+//====================================================================================================================
+
+Bool_t AliFlowAutoRangeProfileAccumulator::Merge(const AliFlowAutoRangeProfileAccumulator &other)
+{
+   // Add the sums of other, with the same profiles on the same grid, to these, bin by bin; other is left as it is.
+
+   if(other.fNProfiles != fNProfiles || TMath::Abs(other.fWidth-fWidth) > 1.e-9*fWidth
+      || TMath::Abs(other.fOrigin-fOrigin) > 1.e-9*fWidth)
+   {
+      cout<<"WARNING: AliFlowAutoRangeProfileAccumulator::Merge(): other is booked differently, not merged."<<endl;
+      return kFALSE;
+   }
+   if(other.fNBins > 0)
+   {
+      this->Grow(other.fLowBin);
+      this->Grow(other.fLowBin+other.fNBins-1);
+      size_t offset = 2*(size_t)(other.fLowBin-fLowBin)*fNProfiles*fgNSums;
+      for(size_t k=0;k<other.fSums.size();k+=2)
+      {
+         AliFlowProfileAccumulator::AddCompensated(fSums[offset+k],fSums[offset+k+1],other.fSums[k]);
+         AliFlowProfileAccumulator::AddCompensated(fSums[offset+k],fSums[offset+k+1],-other.fSums[k+1]);
+      }
+   }
+   for(size_t k=0;k<fStats.size();k+=2)
+   {
+      AliFlowProfileAccumulator::AddCompensated(fStats[k],fStats[k+1],other.fStats[k]);
+      AliFlowProfileAccumulator::AddCompensated(fStats[k],fStats[k+1],-other.fStats[k+1]);
+   }
+   for(Int_t p=0;p<fNProfiles;p++){fEntries[p] += other.fEntries[p];}
+   return kTRUE;
+
+} // end of Bool_t AliFlowAutoRangeProfileAccumulator::Merge(const AliFlowAutoRangeProfileAccumulator &other)
+
+//====================================================================================================================
+
+Bool_t AliFlowAutoRangeProfileAccumulator::Absorb(Int_t p, const TProfile *profile)
+{
+   // Add the bins, statistics and entries of profile (on the grid, e.g. a profile of another analysis that is
+   // flushed already) to the sums of profile p, so the next Flush() puts them into the profile of p, whatever range
+   // either has. Under- and overflow of profile are left out: the profiles of this class have none.
+
+   if(p < 0 || p >= fNProfiles)
+   {
+      cout<<"WARNING: AliFlowAutoRangeProfileAccumulator::Absorb(): no profile "<<p<<" booked."<<endl;
+      return kFALSE;
+   }
+   Int_t iLowBin = 0;
+   if(!profile || profile->GetEntries() == 0. || !this->FindLowBin(profile,iLowBin)){return kFALSE;}
+
+   const TArrayD *binSumw2 = profile->GetBinSumw2();
+   Bool_t bBinSumw2 = (binSumw2 && binSumw2->GetSize() > 0);
+   for(Int_t bin=1;bin<=profile->GetNbinsX();bin++)
+   {
+      Double_t dBinEntries = profile->GetBinEntries(bin);
+      if(dBinEntries == 0.){continue;}
+      Int_t iGridBin = iLowBin+bin-1;
+      if(iGridBin < fLowBin || iGridBin >= fLowBin+fNBins){this->Grow(iGridBin);}
+      Double_t *sums = &fSums[2*((size_t)(iGridBin-fLowBin)*fNProfiles+p)*fgNSums];
+      AliFlowProfileAccumulator::AddCompensated(sums[0],sums[1],dBinEntries);
+      AliFlowProfileAccumulator::AddCompensated(sums[2],sums[3],profile->GetArray()[bin]);
+      AliFlowProfileAccumulator::AddCompensated(sums[4],sums[5],profile->GetSumw2()->GetArray()[bin]);
+      // without fBinSumw2 the weights were all 1:
+      AliFlowProfileAccumulator::AddCompensated(sums[6],sums[7],(bBinSumw2 ? binSumw2->GetArray()[bin] : dBinEntries));
+   }
+   Double_t stats[fgNStats] = {0.};
+   profile->GetStats(stats);
+   for(Int_t s=0;s<fgNStats;s++){AliFlowProfileAccumulator::AddCompensated(fStats[2*(p*fgNStats+s)],fStats[2*(p*fgNStats+s)+1],stats[s]);}
+   fEntries[p] += (Long64_t)profile->GetEntries();
+   return kTRUE;
+
+} // end of Bool_t AliFlowAutoRangeProfileAccumulator::Absorb(Int_t p, const TProfile *profile)
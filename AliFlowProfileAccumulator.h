@@ -0,0 +1,220 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Flat arrays that take the fills  *
+ * of a group of profiles on one    *
+ * axis, fixed or growing with the  *
+ * fills, added to ROOT profiles    *
+ * only on Flush(), and the binning *
+ * of their axes.                   *
+ ************************************/
+
+#ifndef ALIFLOWPROFILEACCUMULATOR_H
+#define ALIFLOWPROFILEACCUMULATOR_H
+
+#include <vector>
+
+#include "Rtypes.h"
+#include "TMath.h"
+
+class TH1;
+class TAxis;
+class TProfile;
+class TProfile2D;
+
+// Bin numbers of TAxis::FindFixBin(), 0 for underflow and nBins+1 for overflow, without the TAxis: on uniform bins
+// one multiply and truncate, on variable bins a lookup table over uniform cells (a few per bin) gives the first
+// candidate and at most a step or two along the edges finds the bin.
+class AliFlowAxisBinner{
+   public:
+      static const Int_t fgCellsPerBin = 4; // lookup cells per variable bin
+
+      AliFlowAxisBinner(); // constructor, an axis without bins
+      virtual ~AliFlowAxisBinner() {} // destructor
+      void Set(Int_t nBins, Double_t min, Double_t max); // uniform bins
+      void Set(Int_t nBins, const Double_t *edges); // variable bins, nBins+1 increasing edges
+      void Set(const TAxis *axis); // the bins of axis
+      Int_t GetNBins() const {return this->fNBins;}
+      Int_t FindBin(Double_t x) const
+      {
+         if(x < fMin){return 0;}
+         if(!(x < fMax)){return fNBins+1;}
+         if(fLookup.empty()){return 1+(Int_t)(fNBins*(x-fMin)/(fMax-fMin));} // as TAxis::FindBin(), rounding included
+         Int_t iCell = (Int_t)((x-fMin)*fScale);
+         if(iCell >= (Int_t)fLookup.size()){iCell = (Int_t)fLookup.size()-1;}
+         Int_t iBin = fLookup[iCell];
+         while(iBin < fNBins && !(x < fEdges[iBin])){iBin++;} // fEdges[iBin] is the upper edge of bin iBin
+         while(iBin > 1 && x < fEdges[iBin-1]){iBin--;} // x rounded into the next cell
+         return iBin;
+      }
+
+   private:
+      Int_t fNBins; // number of bins
+      Double_t fMin; // lower edge of the first bin
+      Double_t fMax; // upper edge of the last bin
+      Double_t fScale; // variable bins: lookup cells per unit
+      std::vector<Double_t> fEdges; //! variable bins: the nBins+1 edges
+      std::vector<Int_t> fLookup; //! variable bins: the lowest bin that overlaps each cell
+
+   ClassDef(AliFlowAxisBinner,0) // bin numbers of an axis
+};
+
+//====================================================================================================================
+
+
+// The profiles of a group share one axis (or one pair of axes), so a track looks up its bin once for all of them.
+// The sums of one bin lie next to each other for all profiles of the group, {sum w, sum wy, sum wy^2, sum w^2}
+// per profile, i.e. the bin entries, content, fSumw2 and fBinSumw2 that TProfile::Fill() would update; the bins
+// are numbered like the global bins of ROOT, under- and overflow included. Flush() adds the sums, the statistics
+// and the number of entries to the profiles, so they end up as if every fill had gone to them directly.
+// Every sum is compensated (Kahan): next to it lies what the rounding of its additions lost, so means over 10^9
+// fills keep the precision of a few. Accumulators booked alike Merge() bin by bin, the compensations included, so
+// threads can reduce theirs pairwise in a tree.
+class AliFlowProfileAccumulator{
+   public:
+      static const Int_t fgNSums = 4; // sums per profile and bin
+      static const Int_t fgNStats = 9; // sums per profile for TH1::PutStats(), as for a TProfile2D
+
+      // sum += x, with compensation the part of the sum lost to rounding so far (the sum is sum-compensation):
+      static void AddCompensated(Double_t &sum, Double_t &compensation, Double_t x)
+      {
+         Double_t y = x-compensation;
+         Double_t t = sum+y;
+         compensation = (t-sum)-y;
+         sum = t;
+      }
+
+      AliFlowProfileAccumulator(); // constructor
+      virtual ~AliFlowProfileAccumulator() {} // destructor
+      // nProfiles profiles on nBinsX fixed bins in [xMin,xMax), and for profiles in two dimensions nBinsY in [yMin,yMax):
+      void Book(Int_t nProfiles, Int_t nBinsX, Double_t xMin, Double_t xMax, Int_t nBinsY = 0, Double_t yMin = 0., Double_t yMax = 0.);
+      // the same on the bins of xAxis (and yAxis), fixed or variable:
+      void Book(Int_t nProfiles, const TAxis *xAxis, const TAxis *yAxis = NULL);
+      void SetProfile(Int_t p, TProfile *profile); // where profile p goes on Flush()
+      void SetProfile(Int_t p, TProfile2D *profile);
+      void Flush(); // add all sums to the profiles and start from zero
+      void Reset(); // start from zero, without touching the profiles
+      Bool_t Merge(const AliFlowProfileAccumulator &other); // add the sums of other, booked alike
+      Int_t GetNProfiles() const {return this->fNProfiles;}
+
+      // Bin of x (and y) on each axis; whoever shares an axis can take the bin from either:
+      const AliFlowAxisBinner& GetAxisX() const {return this->fAxisX;}
+      const AliFlowAxisBinner& GetAxisY() const {return this->fAxisY;}
+      Int_t FindBinX(Double_t x) const {return fAxisX.FindBin(x);}
+      Int_t FindBinY(Double_t y) const {return fAxisY.FindBin(y);}
+      // Fill profile p with value v at x, in bin binX:
+      void Fill(Int_t binX, Int_t p, Double_t x, Double_t v, Double_t w = 1.)
+      {
+         this->AddToBin(binX,p,v,w);
+         if(binX < 1 || binX > fNBinsX){return;} // the statistics take only the fills inside the axis range, as in ROOT
+         Double_t *stats = &fStats[2*p*fgNStats];
+         AddCompensated(stats[0],stats[1],w); AddCompensated(stats[2],stats[3],w*w); AddCompensated(stats[4],stats[5],w*x);
+         AddCompensated(stats[6],stats[7],w*x*x); AddCompensated(stats[8],stats[9],w*v); AddCompensated(stats[10],stats[11],w*v*v);
+      }
+      // and in two dimensions at (x,y), in bins binX and binY:
+      void Fill(Int_t binX, Int_t binY, Int_t p, Double_t x, Double_t y, Double_t v, Double_t w = 1.)
+      {
+         this->AddToBin(binX+(fNBinsX+2)*binY,p,v,w);
+         if(binX < 1 || binX > fNBinsX || binY < 1 || binY > fNBinsY){return;}
+         Double_t *stats = &fStats[2*p*fgNStats];
+         AddCompensated(stats[0],stats[1],w); AddCompensated(stats[2],stats[3],w*w); AddCompensated(stats[4],stats[5],w*x);
+         AddCompensated(stats[6],stats[7],w*x*x); AddCompensated(stats[8],stats[9],w*y); AddCompensated(stats[10],stats[11],w*y*y);
+         AddCompensated(stats[12],stats[13],w*x*y); AddCompensated(stats[14],stats[15],w*v); AddCompensated(stats[16],stats[17],w*v*v);
+      }
+
+   private:
+      AliFlowProfileAccumulator(const AliFlowProfileAccumulator& anAccumulator); // copy constructor
+      AliFlowProfileAccumulator& operator=(const AliFlowProfileAccumulator& anAccumulator); // assignment operator
+      void Allocate(Int_t nProfiles); // the sums, once the axes are set
+      template<class TProfileType> void AddToProfile(TProfileType *profile, Int_t p) const; // Flush() of profile p
+      void AddToBin(Int_t bin, Int_t p, Double_t v, Double_t w)
+      {
+         Double_t *sums = &fSums[2*((size_t)bin*fNProfiles+p)*fgNSums];
+         AddCompensated(sums[0],sums[1],w); AddCompensated(sums[2],sums[3],w*v);
+         AddCompensated(sums[4],sums[5],w*v*v); AddCompensated(sums[6],sums[7],w*w);
+         fEntries[p]++;
+      }
+      Int_t fNProfiles; // profiles in the group
+      Int_t fNBinsX; // bins of the x axis
+      Int_t fNBinsY; // bins of the y axis, 0 for profiles in one dimension
+      AliFlowAxisBinner fAxisX; // x axis
+      AliFlowAxisBinner fAxisY; // y axis
+      Int_t fNCells; // global bins, under- and overflow included
+      std::vector<Double_t> fSums; //! [bin][profile][fgNSums][sum, compensation]
+      std::vector<Double_t> fStats; //! [profile][fgNStats][sum, compensation]
+      std::vector<Long64_t> fEntries; //! fills per profile since the last Flush()
+      std::vector<TH1*> fProfiles; //! TProfile or TProfile2D per profile, not owned
+
+   ClassDef(AliFlowProfileAccumulator,0) // flat accumulator of a group of profiles
+};
+
+//====================================================================================================================
+
+
+// The same for profiles in one dimension whose range is not known in advance, such as versus multiplicity: the
+// bins lie on a fixed grid (width and one edge), but only the window of bins between the lowest and the highest
+// one filled is kept, and it grows with the fills. Flush() extends the range of each profile to cover the window
+// (on the same grid, keeping what the profile holds), so the profiles stay compact and still merge with TH1::Merge().
+// The sums are compensated and Merge() as in AliFlowProfileAccumulator; Absorb() takes a profile that is already
+// flushed back as pending fills, so profiles of different ranges add up bin by bin as well.
+class AliFlowAutoRangeProfileAccumulator{
+   public:
+      static const Int_t fgNSums = 4; // sums per profile and bin, as in AliFlowProfileAccumulator
+      static const Int_t fgNStats = 6; // sums per profile for TH1::PutStats(), as for a TProfile
+
+      AliFlowAutoRangeProfileAccumulator(); // constructor
+      virtual ~AliFlowAutoRangeProfileAccumulator() {} // destructor
+      // nProfiles profiles on bins of width binWidth, one of them starting at origin:
+      void Book(Int_t nProfiles, Double_t binWidth, Double_t origin = 0.);
+      void SetProfile(Int_t p, TProfile *profile); // where profile p goes on Flush()
+      void Flush(); // extend the profiles as needed, add all sums to them and start from zero
+      void Reset(); // start from zero, without touching the profiles
+      Bool_t Merge(const AliFlowAutoRangeProfileAccumulator &other); // add the sums of other, on the same grid
+      Bool_t Absorb(Int_t p, const TProfile *profile); // add the bins, statistics and entries of profile to profile p
+      Int_t GetNProfiles() const {return this->fNProfiles;}
+      Int_t GetNBins() const {return this->fNBins;} // bins in the current window
+      // Grid bin of x, counted from the one that starts at the origin:
+      Int_t FindBin(Double_t x) const {return (Int_t)TMath::Floor((x-fOrigin)/fWidth);}
+      // Fill profile p with value v at x, in grid bin bin:
+      void Fill(Int_t bin, Int_t p, Double_t x, Double_t v, Double_t w = 1.)
+      {
+         if(bin < fLowBin || bin >= fLowBin+fNBins){this->Grow(bin);}
+         Double_t *sums = &fSums[2*((size_t)(bin-fLowBin)*fNProfiles+p)*fgNSums];
+         AliFlowProfileAccumulator::AddCompensated(sums[0],sums[1],w);
+         AliFlowProfileAccumulator::AddCompensated(sums[2],sums[3],w*v);
+         AliFlowProfileAccumulator::AddCompensated(sums[4],sums[5],w*v*v);
+         AliFlowProfileAccumulator::AddCompensated(sums[6],sums[7],w*w);
+         fEntries[p]++;
+         Double_t *stats = &fStats[2*p*fgNStats]; // every fill is inside the range the profile will have
+         AliFlowProfileAccumulator::AddCompensated(stats[0],stats[1],w);
+         AliFlowProfileAccumulator::AddCompensated(stats[2],stats[3],w*w);
+         AliFlowProfileAccumulator::AddCompensated(stats[4],stats[5],w*x);
+         AliFlowProfileAccumulator::AddCompensated(stats[6],stats[7],w*x*x);
+         AliFlowProfileAccumulator::AddCompensated(stats[8],stats[9],w*v);
+         AliFlowProfileAccumulator::AddCompensated(stats[10],stats[11],w*v*v);
+      }
+
+   private:
+      AliFlowAutoRangeProfileAccumulator(const AliFlowAutoRangeProfileAccumulator& anAccumulator); // copy constructor
+      AliFlowAutoRangeProfileAccumulator& operator=(const AliFlowAutoRangeProfileAccumulator& anAccumulator); // assignment operator
+      void Grow(Int_t bin); // widen the window to bin
+      Bool_t Extend(TProfile *profile, Int_t &lowBin) const; // widen profile to the window, lowBin is its first grid bin
+      Bool_t FindLowBin(const TProfile *profile, Int_t &lowBin) const; // grid bin of the first bin of profile, if it is on the grid
+      Int_t fNProfiles; // profiles in the group
+      Double_t fWidth; // bin width
+      Double_t fOrigin; // an edge of the grid
+      Int_t fLowBin; // grid bin of the first bin of the window
+      Int_t fNBins; // bins in the window, 0 before the first fill
+      std::vector<Double_t> fSums; //! [bin - fLowBin][profile][fgNSums][sum, compensation]
+      std::vector<Double_t> fStats; //! [profile][fgNStats][sum, compensation]
+      std::vector<Long64_t> fEntries; //! fills per profile since the last Flush()
+      std::vector<TProfile*> fProfiles; //! profile per profile, not owned
+
+   ClassDef(AliFlowAutoRangeProfileAccumulator,0) // accumulator of a group of profiles with a growing range
+};
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Runtime CPU dispatch for the     *
+ * array kernels of the flow event  *
+ * maker 'on the fly'.              *
+ ************************************/
+
+#ifndef ALIFLOWSIMD_H
+#define ALIFLOWSIMD_H
+
+// ALIFLOW_SIMD_CLONES in front of a function definition compiles it once per instruction set; the loader picks
+// the best clone for the CPU it runs on, with the plain (scalar) build as fallback. The kernels are written as
+// simple loops over arrays, without libm calls, so that the compiler can vectorize them. Only GCC on x86-64 ELF
+// supports this reliably, elsewhere the macro is empty and the portable build is used.
+// The dispatch applies to compiled builds only: a driver run by cling (.x runFlowAnalysisOnTheFly.C) interprets
+// the sources it #includes, without clones and without vectorization. Run the drivers compiled with ACLiC
+// (.x runFlowAnalysisOnTheFly.C+) or link the sources into a library.
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__CLING__) && defined(__x86_64__) && defined(__ELF__)
+#define ALIFLOW_SIMD_CLONES __attribute__((target_clones("avx512f","avx2","default")))
+#else
+#define ALIFLOW_SIMD_CLONES
+#endif
+
+#endif
@@ -0,0 +1,177 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+/************************************
+ * Simple track cuts compiled into  *
+ * plain ranges, evaluated for many *
+ * cut sets over whole columns of   *
+ * tracks at once.                  *
+ ************************************/
+
+#include "Riostream.h"
+#include "AliFlowTrackSimple.h"
+#include "AliFlowTrackSimpleCuts.h"
+#include "AliFlowSIMD.h"
+#include "AliFlowTrackCutSets.h"
+
+using std::endl;
+using std::cout;
+ClassImp(AliFlowTrackCutSets)
+
+//====================================================================================================================
+
+AliFlowTrackCutSets::AliFlowTrackCutSets(Int_t nCutSets):
+   fNCutSets(0),
+   fTrack(NULL)
+{
+   // Constructor.
+
+   for(Int_t k=0;k<fgMaxCutSets;k++)
+   {
+      // Empty ranges: nothing passes a cut set that was never set.
+      for(Int_t r=0;r<6;r++){fRanges[k][r] = 0.;}
+      fCutCharge[k] = kFALSE;
+      fCharge[k] = 0;
+      fWarned[k] = kFALSE;
+      fCuts[k] = NULL;
+      fCompiled[k] = kTRUE;
+   }
+   fNCutSets = (nCutSets < fgMaxCutSets ? nCutSets : fgMaxCutSets);
+
+} // end of AliFlowTrackCutSets::AliFlowTrackCutSets(Int_t nCutSets)
+
+//====================================================================================================================
+
+AliFlowTrackCutSets::~AliFlowTrackCutSets()
+{
+   // Destructor.
+
+   if(fTrack){delete fTrack;}
+
+} // end of AliFlowTrackCutSets::~AliFlowTrackCutSets()
+
+//====================================================================================================================
+
+Int_t AliFlowTrackCutSets::Add(AliFlowTrackSimpleCuts const *cuts)
+{
+   // Compile cuts into the next free cut set.
+
+   if(fNCutSets >= fgMaxCutSets)
+   {
+      cout<<"WARNING: AliFlowTrackCutSets holds at most "<<fgMaxCutSets<<" cut sets, cuts not added."<<endl;
+      return -1;
+   }
+   this->Set(fNCutSets++,cuts);
+   return fNCutSets-1;
+
+} // end of Int_t AliFlowTrackCutSets::Add(AliFlowTrackSimpleCuts const *cuts)
+
+//====================================================================================================================
+
+void AliFlowTrackCutSets::Set(Int_t k, AliFlowTrackSimpleCuts const *cuts)
+{
+   // Compile cuts into cut set k. AliFlowTrackSimpleCuts::PassesCuts() rejects a track if x < min or x >= max,
+   // and the ranges of the cuts that were never set are wide open, so the ranges can be taken as they are. The charge
+   // is only cut on once it was set, then also if it is 0, as in PassesCuts(). The other cuts (e.g. on the mass) see
+   // the same defaults in every track created 'on the fly', so one track inside the ranges decides them for all: if
+   // PassesCuts() rejects it, the cut set passes nothing. Cuts of a derived class are left to their PassesCuts().
+
+   if(k < 0 || k >= fNCutSets){return;}
+   fCuts[k] = cuts;
+   if(!fTrack){fTrack = new AliFlowTrackSimple();}
+   fCompiled[k] = (cuts->IsA() == AliFlowTrackSimpleCuts::Class());
+   if(!fCompiled[k]){return;}
+   fRanges[k][0] = cuts->GetPtMin();
+   fRanges[k][1] = cuts->GetPtMax();
+   fRanges[k][2] = cuts->GetEtaMin();
+   fRanges[k][3] = cuts->GetEtaMax();
+   fRanges[k][4] = cuts->GetPhiMin();
+   fRanges[k][5] = cuts->GetPhiMax();
+   fCutCharge[k] = cuts->GetCutCharge();
+   fCharge[k] = cuts->GetCharge();
+
+   if(fRanges[k][0] >= fRanges[k][1] || fRanges[k][2] >= fRanges[k][3] || fRanges[k][4] >= fRanges[k][5]){return;} // passes nothing anyway
+   fTrack->SetPt(fRanges[k][0]);
+   fTrack->SetEta(fRanges[k][2]);
+   fTrack->SetPhi(fRanges[k][4]);
+   fTrack->SetCharge(fCutCharge[k] ? fCharge[k] : 1);
+   if(cuts->PassesCuts(fTrack)){return;}
+   if(!fWarned[k])
+   {
+      cout<<"WARNING: cut set "<<k<<" cuts on more than pt, eta, phi and charge, and these cuts reject all tracks created 'on the fly': it passes nothing."<<endl;
+      fWarned[k] = kTRUE;
+   }
+   for(Int_t r=0;r<6;r++){fRanges[k][r] = 0.;}
+
+} // end of void AliFlowTrackCutSets::Set(Int_t k, AliFlowTrackSimpleCuts const *cuts)
+
+//====================================================================================================================
+
+void AliFlowTrackCutSets::Evaluate(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge, UInt_t *selection, Int_t *nPass) const
+{
+   // One pass over the tracks per cut set, each a run of branch-free compares (or of PassesCuts() calls for the cuts
+   // of a derived class).
+
+   for(Int_t i=0;i<n;i++){selection[i] = 0;}
+   for(Int_t k=0;k<fNCutSets;k++)
+   {
+      if(fCompiled[k])
+      {
+         PassesRanges(n,pt,eta,phi,charge,fRanges[k],fCutCharge[k],fCharge[k],1u<<k,selection);
+         continue;
+      }
+      for(Int_t i=0;i<n;i++)
+      {
+         fTrack->SetPt(pt[i]);
+         fTrack->SetEta(eta[i]);
+         fTrack->SetPhi(phi[i]);
+         fTrack->SetCharge(charge[i]);
+         if(fCuts[k]->PassesCuts(fTrack)){selection[i] |= 1u<<k;}
+      }
+   }
+   if(!nPass){return;}
+   for(Int_t k=0;k<fNCutSets;k++)
+   {
+      Int_t nPassing = 0;
+      for(Int_t i=0;i<n;i++){nPassing += (selection[i]>>k) & 1u;}
+      nPass[k] = nPassing;
+   }
+
+} // end of void AliFlowTrackCutSets::Evaluate(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge, UInt_t *selection, Int_t *nPass) const
+
+//====================================================================================================================
+
+ALIFLOW_SIMD_CLONES
+void AliFlowTrackCutSets::PassesRanges(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge,
+                                       const Double_t *ranges, Bool_t bCutCharge, Int_t iCharge, UInt_t uiBit, UInt_t *selection)
+{
+   // Set uiBit for the tracks inside all ranges and, if bCutCharge, of charge iCharge.
+
+   const Double_t dPtMin = ranges[0];
+   const Double_t dPtMax = ranges[1];
+   const Double_t dEtaMin = ranges[2];
+   const Double_t dEtaMax = ranges[3];
+   const Double_t dPhiMin = ranges[4];
+   const Double_t dPhiMax = ranges[5];
+   for(Int_t i=0;i<n;i++)
+   {
+      UInt_t uiPass = (UInt_t)(pt[i] >= dPtMin) & (UInt_t)(pt[i] < dPtMax)
+                    & (UInt_t)(eta[i] >= dEtaMin) & (UInt_t)(eta[i] < dEtaMax)
+                    & (UInt_t)(phi[i] >= dPhiMin) & (UInt_t)(phi[i] < dPhiMax)
+                    & ((UInt_t)(!bCutCharge) | (UInt_t)(charge[i] == iCharge));
+      selection[i] |= (0u-uiPass) & uiBit;
+   }
+
+} // end of void AliFlowTrackCutSets::PassesRanges(...)
@@ -0,0 +1,59 @@
+/*
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved.
+ * See cxx source for full Copyright notice
+ * $Id$
+ */
+
+/************************************
+ * Simple track cuts compiled into  *
+ * plain ranges, evaluated for many *
+ * cut sets over whole columns of   *
+ * tracks at once.                  *
+ ************************************/
+
+#ifndef ALIFLOWTRACKCUTSETS_H
+#define ALIFLOWTRACKCUTSETS_H
+
+#include "Rtypes.h"
+
+class AliFlowTrackSimple;
+class AliFlowTrackSimpleCuts;
+
+// Cut set k sets bit k of the selection word of every track that passes it; with the RP cuts as set 0 and the POI
+// cuts as set 1 this is the kRP | kPOI word of AliFlowEventBatch. The pt, eta, phi and charge cuts of an
+// AliFlowTrackSimpleCuts are compiled into ranges. Its other cuts only see the defaults of tracks created 'on the
+// fly', so they pass all of them or none; a cut set whose other cuts pass none passes nothing, with a warning. Cuts of
+// any class derived from AliFlowTrackSimpleCuts may cut on anything, so they are not compiled: their PassesCuts() is
+// called for every track.
+class AliFlowTrackCutSets{
+   public:
+      static const Int_t fgMaxCutSets = 32; // one bit of the selection word each
+
+      AliFlowTrackCutSets(Int_t nCutSets = 0); // constructor, with nCutSets sets that pass nothing until Set()
+      virtual ~AliFlowTrackCutSets(); // destructor
+      Int_t Add(AliFlowTrackSimpleCuts const *cuts); // compile one more cut set; returns its bit, or -1 if all are used
+      void Set(Int_t k, AliFlowTrackSimpleCuts const *cuts); // (re)compile cut set k
+      // Compile cut set k only if it was set from other cuts (those changed in place need Set() again):
+      void Update(Int_t k, AliFlowTrackSimpleCuts const *cuts) {if(k < 0 || k >= fNCutSets || cuts != fCuts[k]){this->Set(k,cuts);}}
+      Int_t GetNCutSets() const {return this->fNCutSets;}
+      // The selection word of n tracks, and with nPass (if not NULL) the number of tracks passing each cut set:
+      void Evaluate(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge, UInt_t *selection, Int_t *nPass = NULL) const;
+
+   private:
+      AliFlowTrackCutSets(const AliFlowTrackCutSets& aCutSets); // copy constructor
+      AliFlowTrackCutSets& operator=(const AliFlowTrackCutSets& aCutSets); // assignment operator
+      static void PassesRanges(Int_t n, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Int_t *charge,
+                               const Double_t *ranges, Bool_t bCutCharge, Int_t iCharge, UInt_t uiBit, UInt_t *selection);
+      Int_t fNCutSets; // number of compiled cut sets
+      Double_t fRanges[fgMaxCutSets][6]; // {ptMin, ptMax, etaMin, etaMax, phiMin, phiMax} per cut set, each [min,max)
+      Bool_t fCutCharge[fgMaxCutSets]; // cut on the charge per cut set
+      Int_t fCharge[fgMaxCutSets]; // required charge per cut set, if fCutCharge
+      Bool_t fWarned[fgMaxCutSets]; // warned that the cuts of the set reject all tracks created 'on the fly'
+      AliFlowTrackSimpleCuts const *fCuts[fgMaxCutSets]; // cuts the set was compiled from (not owned)
+      Bool_t fCompiled[fgMaxCutSets]; // the set is its ranges, else the PassesCuts() of fCuts
+      AliFlowTrackSimple *fTrack; // track handed to PassesCuts()
+
+   ClassDef(AliFlowTrackCutSets,0) // many track cut sets evaluated in one pass
+};
+
+#endif
@@ -4,15 +4,19 @@
 
 class TSelector;
 class AliFlowEventSimpleMakerOnTheFly_mod;
+class AliFlowEventBatch;
 class AliFlowAnalysisWithMCEventPlane_mod;
 class AliFlowTrackSimpleCuts;
+class AliFlowBlockMerger;
 class ProofAOTF : public TSelector {
 public :
    
    AliFlowEventSimpleMakerOnTheFly_mod *eventMakerOnTheFly;
+   AliFlowEventBatch *batch;
    AliFlowAnalysisWithMCEventPlane_mod *mcep;
    AliFlowTrackSimpleCuts *cutsRP;
    AliFlowTrackSimpleCuts *cutsPOI;
+   AliFlowBlockMerger *blockMerger; // deterministic mode: the blocks of this worker, merged as far as they go
 
    ProofAOTF();
    virtual ~ProofAOTF();
@@ -26,6 +30,7 @@ public :
    virtual TList  *GetOutputList() const { return fOutput; }
    virtual void    SlaveTerminate();
    virtual void    Terminate();
+   AliFlowAnalysisWithMCEventPlane_mod *CreateAnalysis() const; // configured and initialized as in config.h
 
    ClassDef(ProofAOTF,2);
 };
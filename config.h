@@ -5,9 +5,21 @@
 // 2  60-80%
 Int_t cClass = 2;
 
-// Number of events, only for non-PROOF
+// Number of events, for non-PROOF and for the deterministic mode on PROOF
 Int_t iNevts = 1000;
 
+// Threads, only for runFlowAnalysisOnTheFlyThreaded.C
+Int_t iNThreads = 0; // 0: one thread per core
+Int_t iEventsPerChunk = 64; // events per unit of work; smaller chunks balance better, larger ones lock less
+
+// Deterministic mode, for runFlowAnalysisOnTheFlyThreaded.C, runFlowAnalysisOnTheFlyScan.C and PROOF: the iNevts events are analysed in blocks of iEventsPerBlock
+// (the last one partial if need be), each into its own analysis, merged in a tree fixed by the blocks alone, so the output is
+// bit-identical on any number of threads or workers, and the same on both. Every block costs a merge and a reset of its analysis,
+// i.e. two passes over all bins (the analyses merged away take later blocks, so only those in flight or waiting for their siblings
+// are booked), where the other mode merges once per thread; so take blocks of many events. On PROOF, every entry is a block (process (iNevts+iEventsPerBlock-1)/iEventsPerBlock
+// entries); each worker merges its blocks as far as they are consecutive and sends the nodes of the tree it got to. 0: off
+Int_t iEventsPerBlock = 0;
+
 
 
 // Determine multiplicites of events:
@@ -38,6 +50,28 @@ Int_t etaBins = 60;  //bins for result histograms
 // Configure detector's efficiency:
 Bool_t uniformEfficiency = kFALSE; // if kTRUE: detectors has uniform pT efficiency
                                   // if kFALSE: simulate detector with non-uniform pT efficiency & acceptance. 
+Bool_t bFoldEfficiency = kFALSE; // only for non-uniform efficiency with table sampling:
+                                 // if kTRUE: sample pT from spectrum x efficiency, accepted multiplicity drawn binomially
+                                 // (same distributions, but other events than the default; the tracks in a table interval
+                                 // that holds an efficiency step move by less than one interval, 5 MeV on the default grid)
+                                 // if kFALSE: generate every track and reject it in AcceptPt(), as the original generator
+
+// Configure sampling of the generator:
+Bool_t bUseTF1Sampling = kFALSE; // if kTRUE: sample directly from the TF1 distributions (exact, slow)
+                                 // if kFALSE: sample from tables precomputed in Init() (fast)
+TString sTablesFile = ""; // if set: map the pT, efficiency and eta tables from this file (see makeOnTheFlyTables.C)
+                          // instead of computing them in Init(); on PROOF, the path must be readable on every worker
+Bool_t bStreamEvents = kTRUE; // if kTRUE: stream the tracks from the generator straight into the analysis
+                              // if kFALSE: store the events in a batch first and analyse them from there
+
+// Event store, to re-analyse the same events under other cuts without generating them again:
+TString sWriteEventsFile = ""; // if set: also store all generated events in this file (runFlowAnalysisOnTheFly.C only)
+TString sReplayEventsFile = ""; // if set: analyse the events stored in this file instead of generating new ones (not with PROOF)
+
+// Live counters of the generators, read with monitorOnTheFly.C:
+TString sTelemetryFile = ""; // node-local stats file, e.g. "/dev/shm/flowAnalysisOnTheFly.stats" (empty: no live counters,
+                             // every generator prints a line of progress every 10000 events instead)
+                             // each run resets it at the start, so give concurrent runs on one node their own files
 
 
 // Define simple cuts for Reference Particle (RP) selection:
@@ -61,6 +95,22 @@ Bool_t bUseChargePOI = kTRUE; // if kFALSE, POIs with both sign of charges are t
 Int_t chargePOI = -1; // +1 or -1
 
 
-// Configure Pt cuts for extra pt-region v1 hists (not yet in macro)
+// Configure Pt cuts for extra pt-region v1 hists: one v1(eta) profile per slice between the increasing cut-offs,
+// i.e. pt < 3, 3 <= pt < 5 and pt >= 5 GeV below; add cut-offs for more slices (at most 31)
 Bool_t ptSubHists = kTRUE;
-Double_t ptCutOffs[2] = {3,5};
+Double_t ptCutOffs[] = {3,5};
+Int_t nPtCutOffs = sizeof(ptCutOffs)/sizeof(ptCutOffs[0]);
+
+// Harmonics v1, ..., vN measured in the same pass against the MC reaction plane (besides v1 above), each with its
+// own results in the list "Harmonics" of the output; 0 for none, at most 8
+Int_t nHarmonics = 0;
+
+// Errors of v1 from the spread of nSubsamples subsamples of the events (each event in one of them), or of as many
+// bootstrap replicas (each event in every one, with a Poisson weight); 0 for the statistical errors of the profiles,
+// else 2 to 64. Cost: the subsamples add 3 accumulator fills per RP (integrated, pt, eta) and 2 per POI to the 5 and 3
+// of the flow profiles; the bootstrap sums each event per bin first and fills every replica the event has a weight in
+// (about 0.63*nSubsamples of them) once per bin the event filled, plus nSubsamples/4 Philox draws per event. Timed on
+// the fill loops alone (not the generator) at 64 replicas: about 8 times the fills without errors at 81 tracks per event,
+// about 3 times at 1000 (one fill per track and replica: about 25 times at both)
+Int_t nSubsamples = 0;
+Bool_t bBootstrap = kFALSE;